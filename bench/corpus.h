@@ -0,0 +1,209 @@
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+// 可复现的 LittleC 语料生成器：相同的参数与种子总是生成逐字节相同的程序。
+// 生成结果按块交给调用方，内存占用与目标大小无关，可以直接流式写出数 GB 的文件。
+#include <charconv>
+#include <cstdint>
+#include <string>
+
+struct CorpusOptions {
+    uint64_t bytes = 16 << 20;  // 目标大小，生成结果会在最后一个顶层项处略微超出
+    unsigned depth = 4;         // 复合语句（if / while / 块）的最大嵌套层数
+    size_t functions = 16;      // 函数定义个数，均匀穿插在全局语句之间
+    size_t identifiers = 64;    // int 变量个数；bool 变量为其四分之一，至少 1 个
+    bool singleLine = false;    // 每个顶层项（函数、声明、全局语句）只占一行，项内以空格代替换行与缩进
+    uint64_t seed = 1;
+};
+
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(const CorpusOptions &options) : opt(options), state(options.seed) {
+        boolCount = opt.identifiers / 4 ? opt.identifiers / 4 : 1;
+        if (!opt.identifiers)
+            opt.identifiers = 1;
+    }
+
+    // 生成整个程序，每凑满约 1MB 调用一次 sink(const char *data, size_t size)，返回总字节数
+    template <typename Sink>
+    uint64_t generate(Sink &&sink) {
+        flushed = 0;
+        buf.clear();
+        auto flushIfFull = [&] {
+            if (buf.size() >= CHUNK) {
+                sink(buf.data(), buf.size());
+                flushed += buf.size();
+                buf.clear();
+            }
+        };
+        declare("int", "v", opt.identifiers);
+        declare("bool", "b", boolCount);
+        // 第 i 段的前 3/4 是函数 f<i>，其余是全局语句；没有函数时整个程序都是全局语句
+        size_t segments = opt.functions ? opt.functions : 1;
+        for (size_t i = 0; i < segments; i++) {
+            uint64_t start = written();
+            uint64_t end = opt.bytes / segments * (i + 1);
+            if (opt.functions) {
+                uint64_t bodyEnd = start + (end > start ? (end - start) * 3 / 4 : 0);
+                buf += "int f";
+                number(i);
+                buf += "(int a; bool b = 1)";
+                lineBreak();
+                buf += '{';
+                lineBreak();
+                do {
+                    stmt(opt.depth, 1);
+                    flushIfFull();
+                } while (written() < bodyEnd);
+                buf += "}\n";
+            }
+            while (written() < end) {
+                stmt(opt.depth, 0);
+                flushIfFull();
+            }
+        }
+        if (!buf.empty())
+            sink(buf.data(), buf.size());
+        return written();
+    }
+
+private:
+    static constexpr size_t CHUNK = 1 << 20;
+
+    CorpusOptions opt;
+    size_t boolCount;
+    uint64_t state;
+    uint64_t flushed = 0;
+    std::string buf;
+
+    uint64_t written() const { return flushed + buf.size(); }
+
+    // splitmix64：比 mt19937 快得多，生成速度不会成为数 GB 语料的瓶颈
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    size_t pick(size_t n) { return next() % n; }
+
+    void number(uint64_t value) {
+        char digits[24];
+        buf.append(digits, std::to_chars(digits, digits + sizeof digits, value).ptr);
+    }
+    void indent(unsigned level) {
+        if (!opt.singleLine)
+            buf.append(level * 4, ' ');
+    }
+    // 顶层项内部的换行
+    void lineBreak() { buf += opt.singleLine ? ' ' : '\n'; }
+    // level 层的语句结束；只有顶层语句的结束总是换行
+    void endStmt(unsigned level) { buf += opt.singleLine && level ? ' ' : '\n'; }
+    void intVar() { buf += 'v'; number(pick(opt.identifiers)); }
+    void boolVar() { buf += 'b'; number(pick(boolCount)); }
+
+    // 每行 16 个名字的声明
+    void declare(const char *type, const char *prefix, size_t count) {
+        for (size_t i = 0; i < count; i += 16) {
+            buf += type;
+            for (size_t k = i; k < count && k < i + 16; k++) {
+                buf += k == i ? " " : ", ";
+                buf += prefix;
+                number(k);
+            }
+            buf += ";\n";
+        }
+    }
+
+    void operand() {
+        switch (pick(8)) {
+        case 0: number(pick(1000)); break;
+        case 1: buf += '-'; intVar(); break;
+        case 2: buf += '('; intVar(); buf += " + "; number(pick(100)); buf += ')'; break;
+        default: intVar(); break;
+        }
+    }
+    void arith(size_t terms) {
+        static const char *const OPS[] = {" + ", " - ", " * ", " / "};
+        operand();
+        for (size_t i = 1; i < terms; i++) {
+            buf += OPS[pick(4)];
+            operand();
+        }
+    }
+    // 1~3 个子句以 && / || 相连，子句为 bool 变量、关系式或取反的关系式
+    void condition() {
+        static const char *const REL[] = {" < ", " <= ", " > ", " >= ", " == ", " != "};
+        size_t clauses = 1 + pick(3);
+        for (size_t i = 0; i < clauses; i++) {
+            if (i)
+                buf += pick(2) ? " && " : " || ";
+            switch (pick(4)) {
+            case 0: boolVar(); break;
+            case 1:
+                buf += "!(";
+                arith(1 + pick(2));
+                buf += REL[pick(6)];
+                arith(1 + pick(2));
+                buf += ')';
+                break;
+            default:
+                arith(1 + pick(2));
+                buf += REL[pick(6)];
+                arith(1 + pick(2));
+                break;
+            }
+        }
+    }
+
+    // 一条语句；depth 为还允许的复合语句嵌套层数
+    void stmt(unsigned depth, unsigned level) {
+        indent(level);
+        size_t kind = pick(depth ? 16 : 10);
+        switch (kind) {
+        case 0: buf += "read "; intVar(); buf += ';'; endStmt(level); return;
+        case 1: buf += "write "; intVar(); buf += ';'; endStmt(level); return;
+        case 2: case 3: boolVar(); buf += " := "; condition(); buf += ';'; endStmt(level); return;
+        case 10: case 11:
+            buf += "if ";
+            condition();
+            buf += " then";
+            lineBreak();
+            stmt(depth - 1, level + 1);
+            if (kind == 11) {
+                indent(level);
+                buf += "else";
+                lineBreak();
+                stmt(depth - 1, level + 1);
+            }
+            endNested(level);
+            return;
+        case 12: case 13:
+            buf += "while ";
+            condition();
+            buf += " do";
+            lineBreak();
+            stmt(depth - 1, level + 1);
+            endNested(level);
+            return;
+        case 14: case 15: {
+            buf += '{';
+            lineBreak();
+            for (size_t n = 2 + pick(3); n; n--)
+                stmt(depth - 1, level + 1);
+            indent(level);
+            buf += '}';
+            endStmt(level);
+            return;
+        }
+        default: intVar(); buf += " = "; arith(1 + pick(6)); buf += ';'; endStmt(level); return;
+        }
+    }
+    // if / while 以内层语句结束：singleLine 的顶层语句把内层结束处的空格换成换行
+    void endNested(unsigned level) {
+        if (opt.singleLine && !level)
+            buf.back() = '\n';
+    }
+};
+
+#endif // BENCH_CORPUS_H
@@ -0,0 +1,97 @@
+// 深度嵌套输入的解析与输出：括号、括号内加法、一元负号、块、if 与 while 各嵌套 N 层，
+// 解析器、AST 输出、binary 读回与 FlatAST 转换都不递归，嵌套深度只影响堆上的显式栈。
+// binary 读回后再写出、FlatAST 还原成树后再写出，都须与原树的 binary 编码逐字节相同。
+// 用法: build/bench/deep_nesting_bench [嵌套层数，默认 100000]
+#include "ast_writer.h"
+#include "flat_ast.h"
+#include "parser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+void writeBinary(const ProgramNode &program, OutputBuffer &out, string &payload) {
+    payload.clear();
+    out.openString(payload);
+    ASTWriter(out).write(program, OutputFormat::Binary);
+    out.close();
+}
+
+string repeat(const char *s, size_t n) {
+    string out;
+    for (size_t i = 0; i < n; i++)
+        out += s;
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t depth = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    struct Case {
+        const char *name;
+        string source;
+    } cases[] = {
+        {"parens", "a = " + repeat("(", depth) + "1" + repeat(")", depth) + ";"},
+        {"sums", "a = " + repeat("(", depth) + "1" + repeat(" + 1)", depth) + ";"},
+        {"unary", "a = " + repeat("- ", depth) + "1;"},
+        {"blocks", repeat("{", depth) + "a = 1;" + repeat("}", depth)},
+        {"if", repeat("if a then ", depth) + "a = 1;"},
+        {"while", repeat("while a do { ", depth) + "a = 1;" + repeat("}", depth)},
+    };
+
+    Arena arena, scratch;
+    Lexer lexer;
+    Parser parser(lexer);
+    FlatAST flat;
+    OutputBuffer out;
+    string payload, copy, error;
+    int status = 0;
+    for (Case &c : cases) {
+        auto start = chrono::steady_clock::now();
+        arena.reset();
+        lexer.setSource(string_view(c.source));
+        ProgramNode *program = parser.parseProgram(arena);
+        double parseTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        // text 格式的缩进随深度平方增长，这里用 binary 验证整棵树都能写出
+        start = chrono::steady_clock::now();
+        writeBinary(*program, out, payload);
+        double writeTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (parser.hasErrors())
+            status = 1;
+
+        // binary 读回
+        start = chrono::steady_clock::now();
+        scratch.reset();
+        ProgramNode *read = readBinaryAST(payload, scratch, error);
+        double readTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!read) {
+            fprintf(stderr, "%s: readBinaryAST failed: %s\n", c.name, error.c_str());
+            return 1;
+        }
+        writeBinary(*read, out, copy);
+        if (copy != payload) {
+            fprintf(stderr, "%s: binary round-trip mismatch\n", c.name);
+            status = 1;
+        }
+
+        // 扁平解析再还原成树
+        start = chrono::steady_clock::now();
+        lexer.setSource(string_view(c.source));
+        parser.parseProgram(flat);
+        scratch.reset();
+        ProgramNode *rebuilt = flat.toTree(scratch);
+        double flatTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        writeBinary(*rebuilt, out, copy);
+        if (copy != payload) {
+            fprintf(stderr, "%s: FlatAST round-trip mismatch\n", c.name);
+            status = 1;
+        }
+
+        printf("%-7s depth %zu: parse %8.3f ms, write %8.3f ms, read %8.3f ms, flat %8.3f ms, %zu bytes, %zu errors\n",
+               c.name, depth, parseTime * 1e3, writeTime * 1e3, readTime * 1e3, flatTime * 1e3, payload.size(),
+               parser.diagnostics().size());
+    }
+    return status;
+}
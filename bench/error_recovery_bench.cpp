@@ -0,0 +1,71 @@
+// 错误密集输入上的解析吞吐：对合法程序随机破坏若干处，对比解析原程序与破坏后程序的速度，
+// 并统计一遍解析收集到的诊断数。
+// 用法: build/bench/error_recovery_bench [语料 MB，默认 8] [每千字节破坏处数，默认 20]
+#include "corpus.h"
+#include "parser.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+// 在源码中随机选择约 perKB * size / 1024 处做破坏：删掉 ';'、把 '=' 换成 '+'、
+// 删掉 ')'，或在空格处插入一个多余的 ')' 或 'then'，模拟模糊测试产生的畸形输入
+string corrupt(const string &source, double perKB, unsigned seed) {
+    mt19937 rng(seed);
+    uniform_real_distribution<double> roll(0, 1);
+    double rate = perKB / 1024;
+    string out;
+    out.reserve(source.size() + source.size() / 16);
+    for (char c : source) {
+        if (roll(rng) >= rate) {
+            out += c;
+            continue;
+        }
+        switch (c) {
+        case ';': case ')': break;
+        case '=': out += '+'; break;
+        case ' ': out += rng() % 2 ? " ) " : " then "; break;
+        default: out += c; break;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    CorpusOptions options;
+    options.bytes = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 8) << 20;
+    options.seed = 5;
+    double perKB = argc > 2 ? strtod(argv[2], nullptr) : 20;
+    string clean;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { clean.append(data, n); });
+    string broken = corrupt(clean, perKB, 7);
+
+    Arena arena;
+    Lexer lexer;
+    Parser parser(lexer);
+    size_t cleanErrors = 0, brokenErrors = 0, brokenItems = 0;
+    double cleanTime = bestOf(3, [&] {
+        arena.reset();
+        lexer.setSource(string_view(clean));
+        parser.parseProgram(arena);
+        cleanErrors = parser.diagnostics().size();
+    });
+    double brokenTime = bestOf(3, [&] {
+        arena.reset();
+        lexer.setSource(string_view(broken));
+        ProgramNode *program = parser.parseProgram(arena);
+        brokenErrors = parser.diagnostics().size();
+        brokenItems = program->functions.size() + program->decls.size() + program->stmts.size();
+    });
+
+    printf("语料：原程序 %zu 字节，破坏后 %zu 字节（每千字节 %.0f 处）\n", clean.size(), broken.size(), perKB);
+    printf("原程序  %8.3f ms  %8.1f MB/s  错误 %zu 处\n", cleanTime * 1e3, clean.size() / cleanTime / 1e6,
+           cleanErrors);
+    printf("破坏后  %8.3f ms  %8.1f MB/s  错误 %zu 处（每毫秒 %.0f 处），保留顶层项 %zu 个\n", brokenTime * 1e3,
+           broken.size() / brokenTime / 1e6, brokenErrors, brokenErrors / (brokenTime * 1e3), brokenItems);
+    return cleanErrors == 0 && brokenErrors > 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// 表达式共享与常量折叠：
+//   - 在合成语料上分别以 tree、shared、folded 方式解析，比较解析耗时、表达式节点数与 Arena 用量；
+//     shared 的 text 与 binary 输出必须与 tree 逐字节相同，folded 的树语义检查后应没有错误；
+//   - 折叠不改变程序的行为：一段覆盖回绕、INT32_MIN / -1、除数为 0 等情况的手写程序，
+//     以及一批随机小程序（随机输入、带循环上限），tree 与 folded 编译执行的输出与停止原因应相同。
+// 任一检查不通过时以非零状态退出。
+// 用法: build/bench/expr_dag_bench [语料 MB，默认 16] [随机程序数，默认 500]
+#include "ast_writer.h"
+#include "bytecode.h"
+#include "corpus.h"
+#include "parser.h"
+#include "semantic.h"
+#include "timing.h"
+#include "vm.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const char *const CONSTANTS = R"({ int a, b, c;
+a = 2147483647 + 1; write a;
+b = -2147483647 - 1; write b;
+c = (0 - 2147483647 - 1) / -1; write c;
+a = 99999999999 * 3; write a;
+a = 3 * (4 + 5) - -7 / 2; write a;
+a = -(-(6 * 7)); write a;
+a = 1 - 5; write a;
+b = c + 2 * 3 - (2 * 3); write b;
+read c;
+if c * (10 / 5) > 2 + 2 && !(c == 0 - 3) then write c;
+a = 7 / (3 - 3); write a;
+}
+)";
+
+struct Parsed {
+    Arena arena;
+    ProgramNode *program = nullptr;
+    ExprStats stats;
+    double seconds = 0;
+};
+
+void parse(string_view source, ExprMode mode, Parsed &out) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    parser.setExprMode(mode);
+    out.arena.reset();
+    out.seconds = seconds([&] { out.program = parser.parseProgram(out.arena); });
+    out.stats = parser.exprStats();
+    if (parser.hasErrors()) {
+        fprintf(stderr, "语法错误:\n%s\n", formatDiagnostics(source, parser.diagnostics()).c_str());
+        exit(EXIT_FAILURE);
+    }
+}
+
+// 编译执行 program，返回输出与停止原因；编译失败时返回编译器的错误信息
+string execute(const ProgramNode &program, string_view input, uint64_t loopLimit) {
+    BytecodeCompiler compiler;
+    BytecodeModule module;
+    if (!compiler.compile(program, module))
+        return "编译失败: " + compiler.error();
+    VM vm(module);
+    vm.setLoopLimit(loopLimit);
+    VMInput in(input);
+    string text;
+    OutputBuffer out;
+    out.openString(text);
+    VMStatus status = vm.run(in, out);
+    out.close();
+    return text + vmStatusMessage(status);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    CorpusOptions options;
+    options.bytes = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 16) << 20;
+    size_t programs = argc > 2 ? strtoul(argv[2], nullptr, 10) : 500;
+    bool ok = true;
+
+    string source;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+    static const char *const NAMES[] = {"tree", "shared", "folded"};
+    Parsed parsed[3];
+    for (int i = 0; i < 3; i++)
+        parse(source, static_cast<ExprMode>(i), parsed[i]);
+    const ExprStats &base = parsed[1].stats;
+    printf("语料 %zu 字节，表达式节点 %llu 个（%llu 字节）\n", source.size(),
+           static_cast<unsigned long long>(base.treeNodes), static_cast<unsigned long long>(base.treeBytes));
+    printf("方式       解析(ms)   表达式节点      Arena(MB)   节省字节\n");
+    for (int i = 0; i < 3; i++) {
+        const ExprStats &stats = parsed[i].stats;
+        uint64_t nodes = i ? stats.nodes : base.treeNodes;
+        uint64_t saved = i ? stats.savedBytes() : 0;
+        printf("%-8s %10.1f %12llu %14.1f %10llu\n", NAMES[i], parsed[i].seconds * 1e3,
+               static_cast<unsigned long long>(nodes), parsed[i].arena.bytesUsed() / 1e6,
+               static_cast<unsigned long long>(saved));
+    }
+    printf("  shared 复用 %llu 次；folded 折叠 %llu 处\n", static_cast<unsigned long long>(base.reused),
+           static_cast<unsigned long long>(parsed[2].stats.folded));
+
+    bool sameText = render(*parsed[0].program, OutputFormat::Text) == render(*parsed[1].program, OutputFormat::Text);
+    bool sameBinary =
+        render(*parsed[0].program, OutputFormat::Binary) == render(*parsed[1].program, OutputFormat::Binary);
+    SemanticAnalyzer analyzer;
+    bool foldedChecks = analyzer.analyze(*parsed[2].program);
+    printf("  shared 输出：text %s，binary %s；folded 语义检查%s\n", sameText ? "相同" : "不同",
+           sameBinary ? "相同" : "不同", foldedChecks ? "通过" : "出错");
+    ok &= sameText && sameBinary && foldedChecks && parsed[1].arena.bytesUsed() < parsed[0].arena.bytesUsed() &&
+          parsed[2].stats.folded > 0;
+
+    Parsed tree, folded;
+    parse(CONSTANTS, ExprMode::Tree, tree);
+    parse(CONSTANTS, ExprMode::Folded, folded);
+    string expected = execute(*tree.program, "-3", 0);
+    bool constantsSame = expected == execute(*folded.program, "-3", 0);
+    printf("  常量程序：折叠 %llu 处，执行结果%s\n", static_cast<unsigned long long>(folded.stats.folded),
+           constantsSame ? "一致" : "不一致");
+    if (!constantsSame)
+        fprintf(stderr, "tree:\n%s\nfolded:\n%s\n", expected.c_str(), execute(*folded.program, "-3", 0).c_str());
+    ok &= constantsSame && folded.stats.folded > 0;
+
+    // 随机小程序：没有函数，全局语句直接执行；声明之后给 int 变量赋非零初值，
+    // 否则大多数程序在第一次除法时就停止
+    size_t mismatches = 0;
+    uint64_t foldedTotal = 0;
+    string program, input;
+    for (size_t i = 0; i < programs; i++) {
+        CorpusOptions small;
+        small.bytes = 2048;
+        small.functions = 0;
+        small.identifiers = 8;
+        small.seed = i + 1;
+        program.clear();
+        CorpusGenerator(small).generate([&](const char *data, size_t n) { program.append(data, n); });
+        string init;
+        for (size_t k = 0; k < small.identifiers; k++)
+            init += "v" + to_string(k) + " = " + to_string((i + k * 13) % 40 + 1) + ";\n";
+        size_t declEnd = 0;
+        while (program.compare(declEnd, 4, "int ") == 0 || program.compare(declEnd, 5, "bool ") == 0)
+            declEnd = program.find('\n', declEnd) + 1;
+        program.insert(declEnd, init);
+        input.clear();
+        for (size_t k = 0; k < 64; k++)
+            input += to_string(static_cast<int>((i * 7919 + k * 104729) % 200) - 100) + " ";
+        parse(program, ExprMode::Tree, tree);
+        parse(program, ExprMode::Folded, folded);
+        foldedTotal += folded.stats.folded;
+        mismatches += execute(*tree.program, input, 10000) != execute(*folded.program, input, 10000);
+    }
+    printf("  随机程序 %zu 个：折叠 %llu 处，执行结果不一致 %zu\n", programs,
+           static_cast<unsigned long long>(foldedTotal), mismatches);
+    ok &= mismatches == 0;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,168 @@
+// 长而平的表达式上的解析吞吐：对比 Parser 的表驱动运算符优先分析与
+// 每个优先级一个函数的递归下降（BOOL → JOIN → NOT → REL → EXPR → TERM → NEGA → FACTOR），
+// 两者生成的 AST 应逐字节相同。
+// 用法: build/bench/expression_bench [语句数，默认 20000] [每个表达式的操作数，默认 64]
+#include "ast_writer.h"
+#include "parser.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+// 每行一条赋值语句：'=' 右侧为算术表达式，':=' 右侧为带关系与逻辑运算的布尔表达式
+string generateProgram(size_t stmtCount, size_t terms, unsigned seed) {
+    mt19937 rng(seed);
+    static const char *const ARITH[] = {" + ", " - ", " * ", " / "};
+    static const char *const REL[] = {" < ", " <= ", " > ", " >= ", " == ", " != "};
+    auto operand = [&] { return rng() % 2 ? "v" + to_string(rng() % 64) : to_string(rng() % 1000); };
+    auto arith = [&](size_t n) {
+        string e = rng() % 8 ? operand() : "-" + operand();
+        for (size_t i = 1; i < n; i++)
+            e += ARITH[rng() % 4] + operand();
+        return e;
+    };
+    string out;
+    for (size_t s = 0; s < stmtCount; s++) {
+        if (s % 2 == 0) {
+            out += "v" + to_string(rng() % 64) + " = " + arith(terms) + ";\n";
+            continue;
+        }
+        // 每个关系式两侧各 2 个操作数
+        out += "v" + to_string(rng() % 64) + " := ";
+        for (size_t i = 0; i < terms; i += 4) {
+            if (i)
+                out += rng() % 2 ? " && " : " || ";
+            if (rng() % 4 == 0)
+                out += "!";
+            out += arith(2) + REL[rng() % 6] + arith(2);
+        }
+        out += ";\n";
+    }
+    return out;
+}
+
+// 参照实现：每个优先级一个递归函数，只处理赋值语句
+class RecursiveParser {
+public:
+    RecursiveParser(Lexer &lexer, Arena &arena) : lexer(lexer), arena(arena) { interner.reset(arena); }
+
+    ProgramNode *parseProgram() {
+        vector<ASTNode *> stmts;
+        while (lexer.peek().type != TokenType::END) {
+            auto *target = arena.make<IdentifierExprNode>(interner.intern(lexer.next().lexeme));
+            bool isBool = lexer.next().lexeme == ":=";
+            ExprNode *value = isBool ? parseBool() : parseExpr();
+            lexer.next();   // ';'
+            BinaryOp op = isBool ? BinaryOp::BoolAssign : BinaryOp::Assign;
+            stmts.push_back(arena.make<ExprStmtNode>(arena.make<BinaryExprNode>(op, target, value)));
+        }
+        auto *program = arena.make<ProgramNode>();
+        program->stmts = arena.copyList(stmts.data(), stmts.size());
+        return program;
+    }
+
+private:
+    Lexer &lexer;
+    Arena &arena;
+    Interner interner;
+
+    bool at(string_view lexeme) { return lexer.peek().type == TokenType::OPERATOR && lexer.peek().lexeme == lexeme; }
+
+    ExprNode *binary(BinaryOp op, ExprNode *left, ExprNode *right) {
+        return arena.make<BinaryExprNode>(op, left, right);
+    }
+
+    ExprNode *parseBool() {
+        ExprNode *left = parseJoin();
+        while (at("||")) {
+            lexer.next();
+            left = binary(BinaryOp::Or, left, parseJoin());
+        }
+        return left;
+    }
+    ExprNode *parseJoin() {
+        ExprNode *left = parseNot();
+        while (at("&&")) {
+            lexer.next();
+            left = binary(BinaryOp::And, left, parseNot());
+        }
+        return left;
+    }
+    ExprNode *parseNot() {
+        if (!at("!"))
+            return parseRel();
+        lexer.next();
+        return binary(BinaryOp::Not, nullptr, parseRel());
+    }
+    ExprNode *parseRel() {
+        ExprNode *left = parseExpr();
+        BinaryOp op;
+        if (lexer.peek().type == TokenType::OPERATOR && binaryOpFromName(lexer.peek().lexeme, op) &&
+            op >= BinaryOp::Eq && op <= BinaryOp::Ge) {
+            lexer.next();
+            left = binary(op, left, parseExpr());
+        }
+        return left;
+    }
+    ExprNode *parseExpr() {
+        ExprNode *left = parseTerm();
+        while (at("+") || at("-")) {
+            BinaryOp op = lexer.next().lexeme == "+" ? BinaryOp::Add : BinaryOp::Sub;
+            left = binary(op, left, parseTerm());
+        }
+        return left;
+    }
+    ExprNode *parseTerm() {
+        ExprNode *left = parseNega();
+        while (at("*") || at("/")) {
+            BinaryOp op = lexer.next().lexeme == "*" ? BinaryOp::Mul : BinaryOp::Div;
+            left = binary(op, left, parseNega());
+        }
+        return left;
+    }
+    ExprNode *parseNega() {
+        if (!at("-"))
+            return parseFactor();
+        lexer.next();
+        ExprNode *factor = parseNega();
+        return binary(BinaryOp::Sub, arena.make<LiteralExprNode>(interner.intern("0")), factor);
+    }
+    ExprNode *parseFactor() {
+        Token token = lexer.next();
+        if (token.type == TokenType::IDENTIFIER)
+            return arena.make<IdentifierExprNode>(interner.intern(token.lexeme));
+        return arena.make<LiteralExprNode>(interner.intern(token.lexeme));
+    }
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t stmtCount = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+    size_t terms = argc > 2 ? strtoul(argv[2], nullptr, 10) : 64;
+    string source = generateProgram(stmtCount, terms, 11);
+
+    Arena tableArena, recursiveArena;
+    Lexer lexer;
+    Parser parser(lexer);
+    ProgramNode *table = nullptr, *recursive = nullptr;
+    double tableTime = bestOf(5, [&] {
+        tableArena.reset();
+        lexer.setSource(string_view(source));
+        table = parser.parseProgram(tableArena);
+    });
+    double recursiveTime = bestOf(5, [&] {
+        recursiveArena.reset();
+        lexer.setSource(string_view(source));
+        recursive = RecursiveParser(lexer, recursiveArena).parseProgram();
+    });
+
+    bool same = !parser.hasErrors() && render(*table) == render(*recursive);
+    printf("source: %zu bytes, %zu statements, %zu operands per expression\n", source.size(), stmtCount, terms);
+    printf("parse  table %8.3f ms (%6.1f MB/s)   recursive %8.3f ms (%6.1f MB/s)   (%.2fx)%s\n",
+           tableTime * 1e3, source.size() / tableTime / 1e6, recursiveTime * 1e3,
+           source.size() / recursiveTime / 1e6, recursiveTime / tableTime, same ? "" : "  MISMATCH");
+    return same ? 0 : 1;
+}
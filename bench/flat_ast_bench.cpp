@@ -0,0 +1,107 @@
+// 对比指针树与扁平 AST 的遍历、打印耗时。
+// 语料为不含函数的全局语句（指针树一侧只遍历 program->stmts）。
+// 用法: build/bench/flat_ast_bench [语料 MB，默认 8]
+#include "corpus.h"
+#include "flat_ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+// 指针树遍历：统计标识符出现次数与字面量字符数
+void walkExpr(const ExprNode *expr, size_t &ids, size_t &chars) {
+    switch (expr->kind) {
+    case NodeKind::Identifier: ids++; break;
+    case NodeKind::Literal: chars += static_cast<const LiteralExprNode *>(expr)->value.str().size(); break;
+    case NodeKind::BinaryExpr:
+        if (static_cast<const BinaryExprNode *>(expr)->left)
+            walkExpr(static_cast<const BinaryExprNode *>(expr)->left, ids, chars);
+        walkExpr(static_cast<const BinaryExprNode *>(expr)->right, ids, chars);
+        break;
+    default: break;
+    }
+}
+
+void walkStmt(const StmtNode *stmt, size_t &ids, size_t &chars) {
+    switch (stmt->kind) {
+    case NodeKind::ExprStmt: walkExpr(static_cast<const ExprStmtNode *>(stmt)->expr, ids, chars); break;
+    case NodeKind::IfStmt: {
+        const auto *node = static_cast<const IfStmtNode *>(stmt);
+        walkExpr(node->condition, ids, chars);
+        walkStmt(node->thenStmt, ids, chars);
+        if (node->elseStmt)
+            walkStmt(node->elseStmt, ids, chars);
+        break;
+    }
+    case NodeKind::WhileStmt: {
+        const auto *node = static_cast<const WhileStmtNode *>(stmt);
+        walkExpr(node->condition, ids, chars);
+        walkStmt(node->body, ids, chars);
+        break;
+    }
+    case NodeKind::BlockStmt:
+        for (const StmtNode *child : static_cast<const BlockStmtNode *>(stmt)->stmts)
+            walkStmt(child, ids, chars);
+        break;
+    default: break;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    CorpusOptions options;
+    options.bytes = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 8) << 20;
+    options.functions = 0;
+    options.seed = 42;
+    string source;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+
+    Arena arena;
+    Lexer lexer{string_view(source)};
+    Parser parser(lexer);
+    ProgramNode *program = parser.parseProgram(arena);
+    FlatAST flat = FlatAST::fromTree(*program);
+
+    size_t treeIds = 0, treeChars = 0, flatIds = 0, flatChars = 0;
+    double treeWalk = bestOf(5, [&] {
+        treeIds = treeChars = 0;
+        for (const ASTNode *stmt : program->stmts)
+            walkStmt(static_cast<const StmtNode *>(stmt), treeIds, treeChars);
+    });
+    double flatWalk = bestOf(5, [&] {
+        flatIds = flatChars = 0;
+        for (FlatAST::NodeId id = 0; id < flat.size(); id++) {
+            if (flat.kinds[id] == FlatKind::Identifier)
+                flatIds++;
+            else if (flat.kinds[id] == FlatKind::Literal)
+                flatChars += flat.str(flat.s0[id]).size();
+        }
+    });
+
+    size_t treeBytes = 0, flatBytes = 0;
+    double treePrint = bestOf(3, [&] {
+        ostringstream out;
+        program->print(out);
+        treeBytes = out.str().size();
+    });
+    double flatPrint = bestOf(3, [&] {
+        ostringstream out;
+        flat.print(out);
+        flatBytes = out.str().size();
+    });
+    double convert = bestOf(3, [&] { flat.assign(*program); });
+
+    bool sameWalk = treeIds == flatIds && treeChars == flatChars;
+    printf("语料 %zu 字节，扁平 AST 节点 %zu 个\n", source.size(), flat.size());
+    printf("遍历  指针树 %8.3f ms   扁平 %8.3f ms   (%.1fx)%s\n", treeWalk * 1e3, flatWalk * 1e3,
+           treeWalk / flatWalk, sameWalk ? "" : "  结果不一致");
+    printf("打印  指针树 %8.3f ms   扁平 %8.3f ms   (%.1fx)%s\n", treePrint * 1e3, flatPrint * 1e3,
+           treePrint / flatPrint, treeBytes == flatBytes ? "" : "  结果不一致");
+    printf("指针树转换为扁平 AST %.3f ms\n", convert * 1e3);
+    return sameWalk && treeBytes == flatBytes ? 0 : 1;
+}
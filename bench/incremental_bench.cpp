@@ -0,0 +1,135 @@
+// 在大文件上随机编辑，对比增量更新与全量解析的延迟：
+//   - 合法编辑：改写一个数字、插入或删除一行，编辑后程序保持合法；
+//   - 逐字输入：新开一行后一次一个字符地输入一条语句，中间状态都有语法错误。
+// 两类编辑分别统计延迟分位数，并抽查增量结果（AST 与诊断）与全量解析一致。
+// 语料每行一个顶层项（约每 256 字节一个小函数），行首总是顶层项的边界。
+// 用法: build/bench/incremental_bench [语料 MB，默认 4] [编辑次数，默认 20000]
+#include "corpus.h"
+#include "incremental.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+namespace {
+
+string printed(const ProgramNode &program) {
+    ostringstream out;
+    program.print(out);
+    return out.str();
+}
+
+// 增量解析的结果与对当前全文的全量解析逐字节比较（AST 文本与诊断）
+bool matchesFullParse(const IncrementalParser &incremental) {
+    Arena arena;
+    Lexer lexer{string_view(incremental.text())};
+    Parser parser(lexer);
+    ProgramNode *program = parser.parseProgram(arena);
+    return printed(*program) == printed(*incremental.program()) &&
+           formatDiagnostics(incremental.text(), parser.diagnostics()) ==
+               formatDiagnostics(incremental.text(), incremental.diagnostics());
+}
+
+void report(const char *label, vector<double> &latencies) {
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+    printf("%s %zu 次：p50 %.3f ms   p90 %.3f ms   p99 %.3f ms   最大 %.3f ms\n", label, latencies.size(),
+           percentile(0.5) * 1e3, percentile(0.9) * 1e3, percentile(0.99) * 1e3, latencies.back() * 1e3);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    CorpusOptions options;
+    options.bytes = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 4) << 20;
+    options.functions = options.bytes / 256;
+    options.depth = 2;
+    options.singleLine = true;
+    options.seed = 7;
+    size_t editCount = argc > 2 ? strtoul(argv[2], nullptr, 10) : 20000;
+    string source;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+
+    IncrementalParser incremental;
+    auto start = chrono::steady_clock::now();
+    incremental.reset(source);
+    double fullParse = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    mt19937 rng(11);
+    vector<double> latencies;
+    latencies.reserve(editCount);
+    size_t fullReparses = 0, reparsedItems = 0;
+    for (size_t e = 0; e < editCount; e++) {
+        const string &text = incremental.text();
+        size_t pos = 1 + rng() % (text.size() - 1);
+        size_t lineStart = text.rfind('\n', pos - 1) + 1;
+        size_t offset, removed;
+        string inserted;
+        switch (rng() % 3) {
+        case 0:
+            offset = text.find_first_of("0123456789", pos);
+            if (offset == string::npos)
+                continue;
+            removed = 1;
+            inserted = string(1, static_cast<char>('1' + rng() % 9));
+            break;
+        case 1:
+            offset = lineStart;
+            removed = 0;
+            inserted = "v" + to_string(rng() % 64) + " = v" + to_string(rng() % 64) + " * 3;\n";
+            break;
+        default:
+            offset = lineStart;
+            removed = text.find('\n', lineStart) + 1 - lineStart;
+            if (offset == 0 || offset + removed >= text.size())
+                continue;
+            break;
+        }
+        start = chrono::steady_clock::now();
+        incremental.applyEdit(offset, removed, inserted);
+        latencies.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        fullReparses += incremental.lastUpdate().fullReparse;
+        reparsedItems += incremental.lastUpdate().reparsedItems;
+    }
+    bool same = incremental.diagnostics().empty() && matchesFullParse(incremental);
+
+    // 逐字输入：每条语句前先插入一个空行，随后逐字符输入，直到 ';' 之前程序都有语法错误
+    vector<double> typing;
+    size_t invalidStates = 0, typingFullReparses = 0, checks = 0, mismatches = 0;
+    for (size_t session = 0; session < editCount / 20; session++) {
+        const string &text = incremental.text();
+        size_t pos = 1 + rng() % (text.size() - 1);
+        size_t lineStart = text.rfind('\n', pos - 1) + 1;
+        if (lineStart == 0)
+            continue;
+        incremental.applyEdit(lineStart, 0, "\n");
+        string statement = "v" + to_string(rng() % 64) + " = v" + to_string(rng() % 64) + " * " +
+                           to_string(rng() % 1000) + ";";
+        for (size_t c = 0; c < statement.size(); c++) {
+            start = chrono::steady_clock::now();
+            incremental.applyEdit(lineStart + c, 0, string_view(statement).substr(c, 1));
+            typing.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            invalidStates += !incremental.diagnostics().empty();
+            typingFullReparses += incremental.lastUpdate().fullReparse;
+            // 每 2000 次按键抽查一次（全量解析的耗时远大于增量更新）
+            if (typing.size() % 2000 == 1000) {
+                checks++;
+                mismatches += !matchesFullParse(incremental);
+            }
+        }
+    }
+    same &= mismatches == 0 && incremental.diagnostics().empty() && matchesFullParse(incremental);
+
+    printf("源码 %zu 行，%zu 字节，全量解析 %.3f ms\n", static_cast<size_t>(count(source.begin(), source.end(), '\n')),
+           source.size(), fullParse * 1e3);
+    printf("合法编辑平均重新解析 %.2f 项，全量解析（回收节点）%zu 次\n", double(reparsedItems) / latencies.size(),
+           fullReparses);
+    report("合法编辑", latencies);
+    printf("逐字输入 %zu 条语句，其中 %zu 次按键后有语法错误，全量解析（回收节点）%zu 次\n", editCount / 20,
+           invalidStates, typingFullReparses);
+    report("逐字输入", typing);
+    printf("与全量解析比较：抽查 %zu 次，不一致 %zu 次，最终结果%s\n", checks, mismatches, same ? "一致" : "不一致");
+    return same ? 0 : 1;
+}
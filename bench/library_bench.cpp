@@ -0,0 +1,102 @@
+// libgrammaranalyzer 的稳态开销：同一个分析器与结果对象反复解析、输出同一段程序，
+// 热身之后统计每次调用的堆分配次数（替换全局 operator new 计数）与吞吐，C++ 接口与 C 接口各测一遍。
+// 最后把 binary 输出用 readBinaryAST 读回，读回的树按 text 输出须与原树相同。
+// 稳态下出现分配或读回结果不同时以非零状态退出。
+// 用法: build/bench/library_bench [程序字节数，默认 65536] [次数，默认 2000]
+#include "alloc_count.h"
+#include "corpus.h"
+#include "grammar_analyzer.h"
+#include "grammar_analyzer_c.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+struct Result {
+    double seconds;
+    uint64_t allocations;
+};
+
+// 先调用 3 次让各缓冲区长到足够大，再对之后的 iterations 次计时并计数
+template <typename Body>
+Result steadyState(size_t iterations, Body body) {
+    vector<double> times;
+    times.reserve(iterations);
+    for (int i = 0; i < 3; i++)
+        body();
+    uint64_t before = allocations.load();
+    measure(iterations, [] {}, body, times);
+    uint64_t allocated = allocations.load() - before;
+    double total = 0;
+    for (double t : times)
+        total += t;
+    return {total, allocated};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    CorpusOptions options;
+    options.bytes = argc > 1 ? strtoull(argv[1], nullptr, 10) : 65536;
+    size_t iterations = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+    string source;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+
+    static const struct {
+        const char *name;
+        OutputFormat format;
+        int cFormat;
+    } formats[] = {
+        {"text", OutputFormat::Text, GA_FORMAT_TEXT},
+        {"json", OutputFormat::Json, GA_FORMAT_JSON},
+        {"binary", OutputFormat::Binary, GA_FORMAT_BINARY},
+    };
+
+    printf("程序 %zu 字节，%zu 次\n", source.size(), iterations);
+    GrammarAnalyzer analyzer;
+    ParseResult result;
+    string out;
+    ga_analyzer *c = ga_create();
+    bool steady = true;
+    Result parseOnly = steadyState(iterations, [&] { analyzer.parse(source, result); });
+    printf("  C++ parse         %8.1f MB/s  每次分配 %.2f\n", source.size() * iterations / parseOnly.seconds / 1e6,
+           static_cast<double>(parseOnly.allocations) / iterations);
+    steady &= parseOnly.allocations == 0;
+    for (const auto &f : formats) {
+        Result cpp = steadyState(iterations, [&] {
+            analyzer.parse(source, result);
+            analyzer.write(source, result, f.format, out);
+        });
+        Result capi = steadyState(iterations, [&] { ga_parse(c, source.data(), source.size(), f.cFormat); });
+        printf("  C++ parse+%-7s %8.1f MB/s  每次分配 %.2f    C ga_parse %8.1f MB/s  每次分配 %.2f\n", f.name,
+               source.size() * iterations / cpp.seconds / 1e6, static_cast<double>(cpp.allocations) / iterations,
+               source.size() * iterations / capi.seconds / 1e6, static_cast<double>(capi.allocations) / iterations);
+        steady &= cpp.allocations == 0 && capi.allocations == 0;
+    }
+    ga_destroy(c);
+
+    // binary 读回：读回的字符串表与节点分配在新的 arena 中，不计入稳态分配
+    string text, binary, readBack, error;
+    analyzer.parse(source, result);
+    analyzer.write(source, result, OutputFormat::Text, text);
+    analyzer.write(source, result, OutputFormat::Binary, binary);
+    ParseResult decoded;
+    Result read = steadyState(iterations, [&] {
+        decoded.arena.reset();
+        decoded.program = readBinaryAST(binary, decoded.arena, error);
+    });
+    if (decoded.program)
+        analyzer.write(source, decoded, OutputFormat::Text, readBack);
+    printf("  readBinaryAST     %8.1f MB/s  每次分配 %.2f\n", binary.size() * iterations / read.seconds / 1e6,
+           static_cast<double>(read.allocations) / iterations);
+    if (!decoded.program || readBack != text) {
+        fprintf(stderr, "binary 读回的 AST 与原树不同\n");
+        return 1;
+    }
+    if (!result.ok() || !steady) {
+        fprintf(stderr, "稳态下仍有堆分配或解析失败\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+// 词法分析、语法分析与 AST 输出各阶段的吞吐（MB/s、tokens/s、nodes/s），结果可写成 JSON 供跨提交比较。
+// 语料由 corpus.h 按种子生成，也可以先用 --emit 把数 GB 的语料流式写到文件，再用 --input 以 mmap 读入。
+// 用法: build/bench/microbench [--size=16M] [--depth=4] [--functions=16] [--identifiers=64] [--seed=1]
+//                              [--runs=3] [--input=文件] [--emit=文件] [--json=文件|-] [--label=标签]
+#include "ast_writer.h"
+#include "corpus.h"
+#include "parse_cache.h"
+#include "parser.h"
+#include "source_file.h"
+#include "timing.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Phase {
+    const char *name;
+    vector<double> seconds;     // 每轮耗时，升序
+    double best() const { return seconds.front(); }
+    double median() const { return seconds[seconds.size() / 2]; }
+};
+
+template <typename Prepare, typename Body>
+Phase timePhase(const char *name, int runs, Prepare prepare, Body body) {
+    Phase phase{name, {}};
+    measure(runs, prepare, body, phase.seconds);
+    return phase;
+}
+
+// 显式栈遍历统计节点数，与解析器一样不受嵌套深度限制
+size_t countNodes(const ProgramNode &program) {
+    size_t count = 1;
+    vector<const ASTNode *> stack;
+    for (const ASTNode *node : program.functions)
+        stack.push_back(node);
+    for (const ASTNode *node : program.decls)
+        stack.push_back(node);
+    for (const ASTNode *node : program.stmts)
+        stack.push_back(node);
+    while (!stack.empty()) {
+        const ASTNode *node = stack.back();
+        stack.pop_back();
+        if (!node)
+            continue;
+        count++;
+        switch (node->kind) {
+        case NodeKind::BinaryExpr: {
+            auto *binary = static_cast<const BinaryExprNode *>(node);
+            stack.push_back(binary->left);
+            stack.push_back(binary->right);
+            break;
+        }
+        case NodeKind::ExprStmt: stack.push_back(static_cast<const ExprStmtNode *>(node)->expr); break;
+        case NodeKind::IfStmt: {
+            auto *stmt = static_cast<const IfStmtNode *>(node);
+            stack.push_back(stmt->condition);
+            stack.push_back(stmt->thenStmt);
+            stack.push_back(stmt->elseStmt);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto *stmt = static_cast<const WhileStmtNode *>(node);
+            stack.push_back(stmt->condition);
+            stack.push_back(stmt->body);
+            break;
+        }
+        case NodeKind::BlockStmt:
+            for (const ASTNode *child : static_cast<const BlockStmtNode *>(node)->stmts)
+                stack.push_back(child);
+            break;
+        case NodeKind::FuncDef: stack.push_back(static_cast<const FuncDefNode *>(node)->body); break;
+        default: break;
+        }
+    }
+    return count;
+}
+
+// 解析 "16M"、"2G"、"512K" 这类带可选后缀（二进制单位）的大小
+uint64_t parseSize(const char *text) {
+    char *end = nullptr;
+    uint64_t value = strtoull(text, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': return value << 10;
+    case 'm': case 'M': return value << 20;
+    case 'g': case 'G': return value << 30;
+    default: return value;
+    }
+}
+
+string jsonString(const string &s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20)
+            out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    CorpusOptions options;
+    int runs = 3;
+    string input, emit, jsonPath, label;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *eq = strchr(arg, '=');
+        string key(arg, eq ? eq - arg : strlen(arg));
+        const char *value = eq ? eq + 1 : "";
+        if (key == "--size") options.bytes = parseSize(value);
+        else if (key == "--depth") options.depth = strtoul(value, nullptr, 10);
+        else if (key == "--functions") options.functions = strtoul(value, nullptr, 10);
+        else if (key == "--identifiers") options.identifiers = strtoul(value, nullptr, 10);
+        else if (key == "--seed") options.seed = strtoull(value, nullptr, 10);
+        else if (key == "--runs") runs = max(1, atoi(value));
+        else if (key == "--input") input = value;
+        else if (key == "--emit") emit = value;
+        else if (key == "--json") jsonPath = value;
+        else if (key == "--label") label = value;
+        else {
+            fprintf(stderr, "未知参数: %s\n", arg);
+            return 2;
+        }
+    }
+
+    // 只生成语料：边生成边写出，不在内存中保留整个程序
+    if (!emit.empty()) {
+        OutputBuffer out;
+        if (!out.open(emit)) {
+            fprintf(stderr, "无法写入 %s\n", emit.c_str());
+            return 1;
+        }
+        uint64_t bytes = 0;
+        bool ok = false;
+        double elapsed = seconds([&] {
+            bytes = CorpusGenerator(options).generate([&](const char *data, size_t n) { out.append(data, n); });
+            ok = out.close();
+        });
+        printf("%s: %llu bytes in %.3f s (%.1f MB/s)\n", emit.c_str(), static_cast<unsigned long long>(bytes),
+               elapsed, bytes / elapsed / 1e6);
+        return ok ? 0 : 1;
+    }
+
+    SourceFile file;
+    string generated;
+    string_view source;
+    if (!input.empty()) {
+        if (!file.load(input)) {
+            fprintf(stderr, "%s\n", file.error().c_str());
+            return 1;
+        }
+        source = file.view();
+    } else {
+        generated.reserve(options.bytes + (1 << 16));
+        CorpusGenerator(options).generate([&](const char *data, size_t n) { generated.append(data, n); });
+        source = generated;
+    }
+
+    Lexer lexer;
+    Parser parser(lexer);
+    Arena arena;
+    vector<Token> tokens;
+    ProgramNode *program = nullptr;
+    vector<Phase> phases;
+
+    phases.push_back(timePhase("tokenize", runs, [&] { vector<Token>().swap(tokens); },
+                               [&] { tokens = lexer.tokenize(source); }));
+    size_t tokenCount = tokens.size() - 1;  // 不计 END
+    vector<Token>().swap(tokens);
+
+    phases.push_back(timePhase("parse", runs, [&] { arena.reset(); }, [&] {
+        lexer.setSource(source);
+        program = parser.parseProgram(arena);
+    }));
+    if (parser.hasErrors()) {
+        fprintf(stderr, "语料存在 %zu 处语法错误:\n%s\n", parser.diagnostics().size(),
+                formatDiagnostics(source, parser.diagnostics()).c_str());
+        return 1;
+    }
+    size_t nodeCount = countNodes(*program);
+
+    // AST 输出写到 /dev/null，计入格式化与写系统调用，不受磁盘速度影响
+    static const struct {
+        const char *name;
+        OutputFormat format;
+    } WRITERS[] = {{"write_text", OutputFormat::Text}, {"write_json", OutputFormat::Json},
+                   {"write_binary", OutputFormat::Binary}};
+    for (const auto &writer : WRITERS) {
+        phases.push_back(timePhase(writer.name, runs, [] {}, [&] {
+            OutputBuffer out;
+            out.open("/dev/null");
+            ASTWriter(out).write(*program, writer.format);
+            out.close();
+        }));
+    }
+
+    printf("corpus: %zu bytes, %zu tokens, %zu nodes, arena %zu bytes (%s)\n", source.size(), tokenCount,
+           nodeCount, arena.bytesUsed(), input.empty() ? "generated" : input.c_str());
+    for (const Phase &phase : phases) {
+        printf("%-12s best %9.3f ms  median %9.3f ms  %8.1f MB/s  %7.1f Mtokens/s  %7.1f Mnodes/s\n",
+               phase.name, phase.best() * 1e3, phase.median() * 1e3, source.size() / phase.best() / 1e6,
+               tokenCount / phase.best() / 1e6, nodeCount / phase.best() / 1e6);
+    }
+
+    if (jsonPath.empty())
+        return 0;
+    FILE *json = jsonPath == "-" ? stdout : fopen(jsonPath.c_str(), "w");
+    if (!json) {
+        fprintf(stderr, "无法写入 %s\n", jsonPath.c_str());
+        return 1;
+    }
+    fprintf(json, "{\n  \"version\": \"%s\",\n  \"label\": %s,\n  \"runs\": %d,\n", ANALYZER_VERSION,
+            jsonString(label).c_str(), runs);
+    fprintf(json, "  \"corpus\": {\"input\": %s, \"bytes\": %zu, \"tokens\": %zu, \"nodes\": %zu, "
+                  "\"arena_bytes\": %zu",
+            jsonString(input).c_str(), source.size(), tokenCount, nodeCount, arena.bytesUsed());
+    if (input.empty())
+        fprintf(json, ", \"seed\": %llu, \"depth\": %u, \"functions\": %zu, \"identifiers\": %zu",
+                static_cast<unsigned long long>(options.seed), options.depth, options.functions,
+                options.identifiers);
+    fprintf(json, "},\n  \"phases\": [\n");
+    for (size_t i = 0; i < phases.size(); i++) {
+        const Phase &phase = phases[i];
+        fprintf(json, "    {\"name\": \"%s\", \"best_seconds\": %.6f, \"median_seconds\": %.6f, "
+                      "\"mb_per_s\": %.2f, \"tokens_per_s\": %.0f, \"nodes_per_s\": %.0f}%s\n",
+                phase.name, phase.best(), phase.median(), source.size() / phase.best() / 1e6,
+                tokenCount / phase.best(), nodeCount / phase.best(), i + 1 < phases.size() ? "," : "");
+    }
+    fprintf(json, "  ]\n}\n");
+    if (json != stdout)
+        fclose(json);
+    return 0;
+}
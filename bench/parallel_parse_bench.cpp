@@ -0,0 +1,45 @@
+// 对比单个大文件的顺序解析与按顶层项切分的并行解析。
+// 语料由大量函数定义组成，每个函数约 512 字节，函数之间穿插全局语句。
+// 用法: build/bench/parallel_parse_bench [函数数，默认 20000] [线程数，默认 CPU 核数]
+#include "corpus.h"
+#include "parallel_parser.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+int main(int argc, char **argv) {
+    size_t funcCount = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+    size_t threads = argc > 2 ? strtoul(argv[2], nullptr, 10) : thread::hardware_concurrency();
+    CorpusOptions options;
+    options.functions = max<size_t>(funcCount, 1);
+    options.bytes = options.functions * 512;
+    options.seed = 3;
+    string source;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+
+    Arena sequentialArena, parallelArena;
+    ProgramNode *sequential = nullptr, *parallel = nullptr;
+    double sequentialTime = bestOf(3, [&] {
+        sequentialArena.reset();
+        Lexer lexer{string_view(source)};
+        Parser parser(lexer);
+        sequential = parser.parseProgram(sequentialArena);
+    });
+
+    ThreadPool pool(max<size_t>(threads, 1));
+    ParallelParser splitter(pool);
+    double parallelTime = bestOf(3, [&] {
+        parallelArena.reset();
+        parallel = splitter.parseProgram(source, parallelArena);
+    });
+
+    ostringstream a, b;
+    sequential->print(a);
+    parallel->print(b);
+    printf("语料 %zu 字节，函数 %zu 个，线程 %zu 个，切分为 %zu 段\n", source.size(), options.functions,
+           pool.size(), splitter.lastChunkCount());
+    printf("解析  顺序 %8.3f ms   并行 %8.3f ms   (%.1fx)%s\n", sequentialTime * 1e3, parallelTime * 1e3,
+           sequentialTime / parallelTime, a.str() == b.str() ? "" : "  结果不一致");
+    return a.str() == b.str() ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+// 词法扫描各指令集级别的对拍与吞吐：先在随机缓冲区的每个起点、多个终点上比较 SSE2/AVX2 与标量版本
+// 的 skip/find 结果，再比较各级别切分语料得到的 Token 序列（种类、偏移与长度），最后报告各级别
+// 的词法分析吞吐。语料在生成的程序中混入注释、长标识符、长数字串、":=" 与单独的 ':'。
+// 任一结果与标量版本不同时以非零状态退出。CPU 不支持的级别退回可用的最高级别，只测一次。
+// 用法: build/bench/scanner_bench [语料 MB，默认 8]
+#include "corpus.h"
+#include "lexer.h"
+#include "scanner.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace {
+
+using Kernel = size_t (*)(const char *, size_t, size_t);
+
+struct NamedKernel {
+    const char *name;
+    Kernel fn;
+};
+
+const NamedKernel KERNELS[] = {
+    {"skipSpace", scanner::skipSpace},     {"skipIdent", scanner::skipIdent},
+    {"skipDigits", scanner::skipDigits},   {"findNewline", scanner::findNewline},
+    {"findBlockEnd", scanner::findBlockEnd},
+};
+
+// 字符按类别成段出现，段长跨过 16/32 字节的向量宽度
+string randomBuffer(mt19937_64 &rng, size_t bytes) {
+    static const char *const ALPHABETS[] = {" \t\r\n", "abcxyz_ABC", "0123456789", "*/*/**//", "\n;:=(){}+-"};
+    string buf;
+    while (buf.size() < bytes) {
+        const char *alphabet = ALPHABETS[rng() % size(ALPHABETS)];
+        size_t len = strlen(alphabet);
+        for (size_t run = 1 + rng() % 70; run > 0 && buf.size() < bytes; run--)
+            buf += alphabet[rng() % len];
+    }
+    return buf;
+}
+
+// 所有级别对同一缓冲区的每个起点给出的结果都须与标量版本相同
+size_t checkKernels(const vector<scanner::Level> &levels) {
+    mt19937_64 rng(1);
+    size_t mismatches = 0;
+    vector<size_t> expected;
+    for (int round = 0; round < 200; round++) {
+        string buf = randomBuffer(rng, 1 + rng() % 300);
+        size_t ends[] = {buf.size(), buf.size() - rng() % buf.size(), rng() % (buf.size() + 1)};
+        for (const NamedKernel &kernel : KERNELS) {
+            for (size_t end : ends) {
+                scanner::setLevel(scanner::Level::Scalar);
+                expected.clear();
+                for (size_t pos = 0; pos <= end; pos++)
+                    expected.push_back(kernel.fn(buf.data(), pos, end));
+                for (scanner::Level level : levels) {
+                    scanner::setLevel(level);
+                    for (size_t pos = 0; pos <= end; pos++) {
+                        size_t got = kernel.fn(buf.data(), pos, end);
+                        if (got != expected[pos] && mismatches++ < 10)
+                            fprintf(stderr, "%s %s: pos %zu end %zu 结果 %zu，标量为 %zu\n", scanner::levelName(level),
+                                    kernel.name, pos, end, got, expected[pos]);
+                    }
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+struct TokenRecord {
+    TokenKind kind;
+    size_t offset;
+    size_t size;
+    bool operator==(const TokenRecord &other) const {
+        return kind == other.kind && offset == other.offset && size == other.size;
+    }
+};
+
+void lexAll(Lexer &lexer, string_view source, vector<TokenRecord> &out) {
+    out.clear();
+    lexer.setSource(source);
+    while (true) {
+        Token token = lexer.next();
+        out.push_back({token.kind, lexer.offsetOf(token), token.lexeme.size()});
+        if (token.kind == TokenKind::End)
+            break;
+    }
+}
+
+// 在生成的程序中每隔若干行插入一段扫描内核处理的特殊写法
+string noisyCorpus(size_t bytes) {
+    static const char *const NOISE[] = {
+        "/* 块注释 ** / 跨\n多行 */", "// 行注释 := :\n", "b := a < 1;", ":", "\t\t\v\f  ",
+        "abcdefghijklmnopqrstuvwxyz_ABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789 = 1;",
+        "x = 12345678901234567890123456789012345678901234567890;", "/**/", "/* 未闭合",
+    };
+    CorpusOptions options;
+    options.bytes = bytes;
+    string source;
+    mt19937_64 rng(7);
+    CorpusGenerator(options).generate([&](const char *data, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            source += data[i];
+            if (data[i] == '\n' && rng() % 8 == 0)
+                source += NOISE[rng() % (size(NOISE) - 1)];
+        }
+    });
+    // 未闭合的块注释吞掉其后的全部内容，只放在末尾
+    source += NOISE[size(NOISE) - 1];
+    return source;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t mb = argc > 1 ? strtoul(argv[1], nullptr, 10) : 8;
+    scanner::Level initial = scanner::activeLevel();
+
+    // CPU 支持的级别，去掉退回后重复的
+    vector<scanner::Level> levels;
+    for (scanner::Level level : {scanner::Level::Scalar, scanner::Level::SSE2, scanner::Level::AVX2}) {
+        scanner::setLevel(level);
+        if (scanner::activeLevel() == level)
+            levels.push_back(level);
+    }
+
+    size_t mismatches = checkKernels(levels);
+
+    string source = noisyCorpus(mb << 20);
+    Lexer lexer;
+    vector<TokenRecord> expected, tokens;
+    scanner::setLevel(scanner::Level::Scalar);
+    lexAll(lexer, source, expected);
+    printf("语料 %.1f MB，%zu 个 Token\n", source.size() / 1048576.0, expected.size());
+    for (scanner::Level level : levels) {
+        scanner::setLevel(level);
+        lexAll(lexer, source, tokens);
+        if (tokens != expected) {
+            size_t i = 0;
+            while (i < tokens.size() && i < expected.size() && tokens[i] == expected[i])
+                i++;
+            size_t offset = i < expected.size() ? expected[i].offset : source.size();
+            fprintf(stderr, "%s: 第 %zu 个 Token（偏移 %zu）与标量版本不同\n", scanner::levelName(level), i, offset);
+            mismatches++;
+        }
+        double seconds = bestOf(3, [&] { lexAll(lexer, source, tokens); });
+        printf("  %-6s %8.1f MB/s %8.1f Mtokens/s\n", scanner::levelName(level), source.size() / seconds / 1e6,
+               tokens.size() / seconds / 1e6);
+    }
+    scanner::setLevel(initial);
+
+    if (mismatches) {
+        fprintf(stderr, "SIMD 扫描与标量版本不一致（%zu 处）\n", mismatches);
+        return 1;
+    }
+    printf("各级别（");
+    for (size_t i = 0; i < levels.size(); i++)
+        printf(i ? "、%s" : "%s", scanner::levelName(levels[i]));
+    printf("）的扫描结果与 Token 序列均与标量版本一致\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+// 语义检查的吞吐与正确性：
+//   - 在百万行级的合成语料上对比语法分析与语义检查的耗时，统计稳态下每次检查的堆分配次数
+//     （替换全局 operator new 计数），语料本身没有语义错误，检查结果应为空；
+//   - 把语料中部分变量改名制造未声明错误，顺序解析、并行解析与增量解析（编辑之后）得到的树
+//     检查出的诊断（位置与内容）应完全相同；
+//   - 一段手写的错误程序，逐条核对报告的行号与错误数。
+// 任一检查不通过时以非零状态退出。
+// 用法: build/bench/semantic_bench [语料 MB，默认 24] [检查次数，默认 5]
+#include "alloc_count.h"
+#include "corpus.h"
+#include "incremental.h"
+#include "parallel_parser.h"
+#include "semantic.h"
+#include "thread_pool.h"
+#include "timing.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+bool sameDiagnostics(const vector<Diagnostic> &a, const vector<Diagnostic> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (a[i].offset != b[i].offset || a[i].message != b[i].message)
+            return false;
+    return true;
+}
+
+// 每条错误所在的行，与 formatDiagnostics 的行号一致
+vector<size_t> linesOf(string_view source, const vector<Diagnostic> &diags) {
+    vector<size_t> lines;
+    for (const Diagnostic &d : diags)
+        lines.push_back(1 + count(source.begin(), source.begin() + d.offset, '\n'));
+    return lines;
+}
+
+const char *const BROKEN = R"({ int a, b, a; bool p;
+int f(int x; bool y = 2) { x = y + 1; z = 3; }
+int f() { write q; }
+a = 1.5 + a;
+p = a;
+a := p;
+p := a + 1;
+if a then write a;
+while !a do a = a - 1;
+b = -p;
+true := false;
+p := p && (a < 3) || a;
+b = f;
+}
+)";
+const size_t BROKEN_LINES[] = {1, 2, 2, 2, 3, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    CorpusOptions options;
+    options.bytes = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 24) << 20;
+    size_t rounds = argc > 2 ? strtoul(argv[2], nullptr, 10) : 5;
+    bool ok = true;
+
+    string source;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+    size_t lines = count(source.begin(), source.end(), '\n');
+    Arena arena;
+    Lexer lexer{string_view(source)};
+    Parser parser(lexer);
+    ProgramNode *program = nullptr;
+    double parseSeconds = seconds([&] { program = parser.parseProgram(arena); });
+    if (parser.hasErrors()) {
+        fprintf(stderr, "语料有语法错误\n");
+        return EXIT_FAILURE;
+    }
+    SemanticAnalyzer analyzer;
+    analyzer.analyze(*program);
+    double best = 1e30;
+    uint64_t before = allocations.load();
+    for (size_t i = 0; i < rounds; i++)
+        best = min(best, seconds([&] { analyzer.analyze(*program); }));
+    uint64_t allocated = allocations.load() - before;
+    printf("语料 %zu 字节，%zu 行\n", source.size(), lines);
+    printf("  语法分析  %8.1f ms  %7.1f MB/s\n", parseSeconds * 1e3, source.size() / parseSeconds / 1e6);
+    printf("  语义检查  %8.1f ms  %7.1f MB/s  （语法分析耗时的 %.0f%%），每次分配 %.2f，诊断 %zu\n", best * 1e3,
+           source.size() / best / 1e6, best / parseSeconds * 100, static_cast<double>(allocated) / rounds,
+           analyzer.diagnostics().size());
+    ok &= analyzer.diagnostics().empty() && allocated == 0;
+
+    // 语句中每隔一段把一个变量 v<n> 改名为 u<n>（未声明），其余部分不变
+    size_t body = source.find("\n", source.rfind("bool b")) + 1;
+    for (size_t pos = body, n = 0; (pos = source.find(" v", pos)) != string::npos; pos += 2)
+        if (++n % 997 == 0)
+            source[pos + 1] = 'u';
+    lexer.setSource(string_view(source));
+    arena.reset();
+    program = parser.parseProgram(arena);
+    analyzer.analyze(*program);
+    vector<Diagnostic> sequential = analyzer.diagnostics();
+
+    ThreadPool pool(4);
+    ParallelParser splitter(pool);
+    Arena parallelArena;
+    analyzer.analyze(*splitter.parseProgram(source, parallelArena));
+    bool parallelSame = splitter.lastChunkCount() > 1 && sameDiagnostics(sequential, analyzer.diagnostics());
+
+    // 增量解析：在中部插入一行，之后的顶层项原样复用、只平移位置
+    IncrementalParser incremental;
+    incremental.reset(source);
+    size_t at = source.find('\n', source.size() / 2) + 1;
+    incremental.applyEdit(at, 0, "v1 = u1 + 1;\n");
+    source.insert(at, "v1 = u1 + 1;\n");
+    lexer.setSource(string_view(source));
+    arena.reset();
+    analyzer.analyze(*parser.parseProgram(arena));
+    sequential = analyzer.diagnostics();
+    bool incrementalSame = incremental.program() && !incremental.lastUpdate().fullReparse;
+    if (incrementalSame) {
+        analyzer.analyze(*incremental.program());
+        incrementalSame = sameDiagnostics(sequential, analyzer.diagnostics());
+    }
+    printf("  注入错误后诊断 %zu 条：并行解析%s，增量解析%s\n", sequential.size(), parallelSame ? "一致" : "不一致",
+           incrementalSame ? "一致" : "不一致");
+    ok &= !sequential.empty() && parallelSame && incrementalSame;
+
+    Lexer brokenLexer{string_view(BROKEN)};
+    Parser brokenParser(brokenLexer);
+    Arena brokenArena;
+    analyzer.analyze(*brokenParser.parseProgram(brokenArena));
+    vector<size_t> found = linesOf(BROKEN, analyzer.diagnostics());
+    bool brokenOk = !brokenParser.hasErrors() &&
+                    equal(found.begin(), found.end(), begin(BROKEN_LINES), end(BROKEN_LINES));
+    printf("  错误程序：报告 %zu 处，行号%s\n", found.size(), brokenOk ? "正确" : "不符");
+    if (!brokenOk)
+        fprintf(stderr, "%s\n", formatDiagnostics(BROKEN, analyzer.diagnostics()).c_str());
+    ok &= brokenOk;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,200 @@
+// 常驻服务的请求吞吐与延迟：进程内启动 AnalyzerServer，多个客户端各开一个连接，连续发送小程序的
+// PARSE 请求。对照组在同一进程内为每个请求新建 Lexer、Parser、Arena 与输出缓冲，即去掉进程启动
+// 开销后，一次性命令行调用仍要付出的冷启动成本。之后发送字节数超限与字节数无法解析的 PARSE 请求，
+// 服务端应回复 ERR 并关闭该连接，随后仍能正常服务新的连接。最后保持比工作线程更多的空闲连接，
+// 新连接上的请求仍须及时得到回复，SHUTDOWN 后空闲连接被关闭。任一请求结果不符时以非零状态退出。
+// 用法: build/bench/server_bench [客户端数，默认 4] [每个客户端的请求数，默认 2000] [程序字节数，默认 4096]
+#include "ast_writer.h"
+#include "corpus.h"
+#include "parser.h"
+#include "server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+bool writeAll(int fd, const string &data) {
+    for (size_t done = 0; done < data.size();) {
+        ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+// 读一个响应，返回状态；内容写入 body
+string readResponse(int fd, string &body) {
+    string header;
+    char c;
+    while (::read(fd, &c, 1) == 1 && c != '\n')
+        header += c;
+    size_t space = header.find(' ');
+    if (space == string::npos)
+        return "";
+    body.resize(strtoull(header.c_str() + space + 1, nullptr, 10));
+    for (size_t done = 0; done < body.size();) {
+        ssize_t n = ::read(fd, &body[done], body.size() - done);
+        if (n <= 0)
+            return "";
+        done += n;
+    }
+    return header.substr(0, space);
+}
+
+int connectTo(const string &path) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    // 服务线程可能还没开始监听
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        if (::connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0)
+            return fd;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    ::close(fd);
+    return -1;
+}
+
+double percentile(const vector<double> &sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    return sorted[min(sorted.size(), max<size_t>(rank, 1)) - 1];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t clients = argc > 1 ? strtoul(argv[1], nullptr, 10) : 4;
+    size_t perClient = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+    CorpusOptions options;
+    options.bytes = argc > 3 ? strtoull(argv[3], nullptr, 10) : 4096;
+    options.functions = 2;
+    string source;
+    CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+    string request = "PARSE text " + to_string(source.size()) + "\n" + source;
+
+    // 对照组：每个请求都从零构造分析状态
+    size_t coldRequests = clients * perClient;
+    string sink;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < coldRequests; i++) {
+        Lexer lexer;
+        Parser parser(lexer);
+        Arena arena;
+        OutputBuffer out;
+        lexer.setSource(source);
+        ProgramNode *program = parser.parseProgram(arena);
+        sink.clear();
+        out.openString(sink);
+        ASTWriter(out).write(*program, OutputFormat::Text);
+        out.close();
+    }
+    double coldSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    string path = "/tmp/littlec-server-bench-" + to_string(getpid()) + ".sock";
+    AnalyzerServer server(clients);
+    thread listener([&] { server.listen(path); });
+
+    vector<vector<double>> latencies(clients);
+    vector<thread> threads;
+    atomic<bool> failed{false};
+    start = chrono::steady_clock::now();
+    for (size_t c = 0; c < clients; c++) {
+        threads.emplace_back([&, c] {
+            int fd = connectTo(path);
+            string body;
+            for (size_t i = 0; fd >= 0 && i < perClient; i++) {
+                auto sent = chrono::steady_clock::now();
+                if (!writeAll(fd, request) || readResponse(fd, body) != "OK") {
+                    failed = true;
+                    break;
+                }
+                latencies[c].push_back(chrono::duration<double>(chrono::steady_clock::now() - sent).count());
+            }
+            if (fd < 0)
+                failed = true;
+            else
+                ::close(fd);
+        });
+    }
+    for (thread &t : threads)
+        t.join();
+    double serveSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 异常请求：回复 ERR 后连接被关闭；之后的新连接照常处理
+    static const char *const BAD_REQUESTS[] = {"PARSE text 18446744073709551615\n", "PARSE text 12abc\n",
+                                               "PARSE text -1\n"};
+    size_t rejected = 0;
+    for (const char *bad : BAD_REQUESTS) {
+        int fd = connectTo(path);
+        string body;
+        char c;
+        if (fd >= 0 && writeAll(fd, bad) && readResponse(fd, body) == "ERR" && ::read(fd, &c, 1) == 0)
+            rejected++;
+        if (fd >= 0)
+            ::close(fd);
+    }
+    string body;
+    int again = connectTo(path);
+    bool recovered = again >= 0 && writeAll(again, request) && readResponse(again, body) == "OK";
+    if (again >= 0)
+        ::close(again);
+    if (rejected != size(BAD_REQUESTS) || !recovered)
+        failed = true;
+
+    // 空闲连接不占用工作线程：它们之外的新连接仍在 5 秒内得到回复
+    vector<int> idle;
+    for (size_t i = 0; i <= clients; i++)
+        idle.push_back(connectTo(path));
+    int probe = connectTo(path);
+    struct pollfd ready = {probe, POLLIN, 0};
+    bool responsive = probe >= 0 && writeAll(probe, request) && ::poll(&ready, 1, 5000) == 1 &&
+                      readResponse(probe, body) == "OK";
+    if (probe >= 0)
+        ::close(probe);
+    if (!responsive)
+        failed = true;
+
+    string stats;
+    int fd = connectTo(path);
+    if (fd < 0 || !writeAll(fd, "STATS\n") || readResponse(fd, stats) != "OK" || !writeAll(fd, "SHUTDOWN\n"))
+        failed = true;
+    string ignored;
+    readResponse(fd, ignored);
+    ::close(fd);
+    listener.join();
+    for (int conn : idle) {
+        char c;
+        if (conn < 0 || ::read(conn, &c, 1) != 0)
+            failed = true;
+        else
+            ::close(conn);
+    }
+    if (failed || sink.empty()) {
+        fprintf(stderr, "服务请求失败\n");
+        return 1;
+    }
+
+    vector<double> all;
+    for (const auto &list : latencies)
+        all.insert(all.end(), list.begin(), list.end());
+    sort(all.begin(), all.end());
+    printf("程序 %zu 字节，%zu 个客户端 x %zu 个请求\n", source.size(), clients, perClient);
+    printf("  每请求新建状态（进程内）: %9.0f 请求/秒\n", coldRequests / coldSeconds);
+    printf("  常驻服务（经套接字）:     %9.0f 请求/秒，客户端延迟 p50 %.1f us，p99 %.1f us\n",
+           all.size() / serveSeconds, percentile(all, 0.5) * 1e6, percentile(all, 0.99) * 1e6);
+    printf("  异常请求 %zu 个均回复 ERR 并关闭连接，之后的请求正常处理\n", rejected);
+    printf("  %zu 个空闲连接不阻塞其他连接上的请求\n", idle.size());
+    printf("  服务端 STATS: %s", stats.c_str());
+    return 0;
+}
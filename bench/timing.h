@@ -0,0 +1,50 @@
+#ifndef BENCH_TIMING_H
+#define BENCH_TIMING_H
+
+// 基准测试共用的计时与输出工具
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "ast_writer.h"
+
+// 运行一次 fn，返回耗时（秒）
+template <typename Fn>
+double seconds(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 连续运行 fn 共 runs 次，返回最快一次的耗时（秒）
+template <typename Fn>
+double bestOf(int runs, Fn fn) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++)
+        best = std::min(best, seconds(fn));
+    return best;
+}
+
+// 运行 runs 轮，每轮先执行 prepare（不计时，例如释放上一轮的结果），再对 body 计时，
+// 各轮耗时（秒）按升序写入 times。times 容量足够时不分配内存，可以放在统计堆分配的区间内
+template <typename Prepare, typename Body>
+void measure(size_t runs, Prepare prepare, Body body, std::vector<double> &times) {
+    times.clear();
+    for (size_t i = 0; i < runs; i++) {
+        prepare();
+        times.push_back(seconds(body));
+    }
+    std::sort(times.begin(), times.end());
+}
+
+// 把 program 按 format 输出到字符串，用于比较两棵树
+inline std::string render(const ProgramNode &program, OutputFormat format = OutputFormat::Text) {
+    std::string text;
+    OutputBuffer out;
+    out.openString(text);
+    ASTWriter(out).write(program, format);
+    out.close();
+    return text;
+}
+
+#endif // BENCH_TIMING_H
@@ -0,0 +1,365 @@
+// 字节码 VM 与直接遍历 AST 的解释器对比：先在几个以循环为主的小程序上比较执行时间，
+// 再用随机生成的程序（带随机输入与循环上限）逐个比较两者的输出、停止原因与迭代次数。
+// 树遍历解释器按名字在哈希表中查变量、每次求值都重新解析常量文本，即不做任何预处理的写法。
+// 任一程序结果不一致时以非零状态退出。
+// 用法: build/bench/vm_bench [随机程序数，默认 2000]
+#include "corpus.h"
+#include "parser.h"
+#include "timing.h"
+#include "vm.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace {
+
+class TreeWalker {
+public:
+    TreeWalker(const ProgramNode &program, uint64_t loopLimit) : program(program), limit(loopLimit ? loopLimit : UINT64_MAX) {}
+
+    VMStatus run(VMInput &in, OutputBuffer &out) {
+        input = &in;
+        output = &out;
+        vars.clear();
+        types.clear();
+        for (const ASTNode *node : program.decls) {
+            auto *decl = static_cast<const DeclNode *>(node);
+            for (Symbol name : decl->names) {
+                if (types.emplace(name.str(), decl->type).second)
+                    vars[name.str()] = 0;
+            }
+        }
+        ticks = 0;
+        status = VMStatus::Ok;
+        for (const ASTNode *stmt : program.stmts)
+            if (!exec(stmt))
+                break;
+        return status;
+    }
+    uint64_t iterations() const { return ticks; }
+
+private:
+    const ProgramNode &program;
+    uint64_t limit;
+    uint64_t ticks = 0;
+    VMStatus status = VMStatus::Ok;
+    VMInput *input = nullptr;
+    OutputBuffer *output = nullptr;
+    unordered_map<string_view, int32_t> vars;
+    unordered_map<string_view, ValueType> types;
+
+    bool eval(const ExprNode *node, int32_t &value) {
+        if (node->kind == NodeKind::Literal) {
+            literalValue(static_cast<const LiteralExprNode *>(node)->value.str(), value);
+            return true;
+        }
+        if (node->kind == NodeKind::Identifier) {
+            string_view name = static_cast<const IdentifierExprNode *>(node)->name.str();
+            auto found = vars.find(name);
+            if (found != vars.end())
+                value = found->second;
+            else
+                literalValue(name, value);
+            return true;
+        }
+        auto *binary = static_cast<const BinaryExprNode *>(node);
+        int32_t left, right;
+        if (binary->op == BinaryOp::Not) {
+            if (!eval(binary->right, right))
+                return false;
+            value = right == 0;
+            return true;
+        }
+        if (!eval(binary->left, left))
+            return false;
+        if (binary->op == BinaryOp::And || binary->op == BinaryOp::Or) {
+            if ((left != 0) != (binary->op == BinaryOp::And)) {
+                value = left != 0;
+                return true;
+            }
+            if (!eval(binary->right, right))
+                return false;
+            value = right != 0;
+            return true;
+        }
+        if (!eval(binary->right, right))
+            return false;
+        uint32_t l = static_cast<uint32_t>(left), r = static_cast<uint32_t>(right);
+        switch (binary->op) {
+        case BinaryOp::Add: value = static_cast<int32_t>(l + r); break;
+        case BinaryOp::Sub: value = static_cast<int32_t>(l - r); break;
+        case BinaryOp::Mul: value = static_cast<int32_t>(l * r); break;
+        case BinaryOp::Div:
+            if (right == 0) {
+                status = VMStatus::DivideByZero;
+                return false;
+            }
+            value = right == -1 ? static_cast<int32_t>(0u - l) : left / right;
+            break;
+        case BinaryOp::Eq: value = left == right; break;
+        case BinaryOp::Ne: value = left != right; break;
+        case BinaryOp::Lt: value = left < right; break;
+        case BinaryOp::Le: value = left <= right; break;
+        case BinaryOp::Gt: value = left > right; break;
+        default:           value = left >= right; break;
+        }
+        return true;
+    }
+
+    bool exec(const ASTNode *node) {
+        int32_t value;
+        switch (node->kind) {
+        case NodeKind::ExprStmt: {
+            auto *assign = static_cast<const BinaryExprNode *>(static_cast<const ExprStmtNode *>(node)->expr);
+            if (!eval(assign->right, value))
+                return false;
+            string_view name = static_cast<const IdentifierExprNode *>(assign->left)->name.str();
+            vars[name] = types[name] == ValueType::Bool ? value != 0 : value;
+            return true;
+        }
+        case NodeKind::IfStmt: {
+            auto *stmt = static_cast<const IfStmtNode *>(node);
+            if (!eval(stmt->condition, value))
+                return false;
+            if (value)
+                return exec(stmt->thenStmt);
+            return !stmt->elseStmt || exec(stmt->elseStmt);
+        }
+        case NodeKind::WhileStmt: {
+            auto *stmt = static_cast<const WhileStmtNode *>(node);
+            while (true) {
+                if (!eval(stmt->condition, value))
+                    return false;
+                if (!value)
+                    return true;
+                if (!exec(stmt->body))
+                    return false;
+                if (++ticks > limit) {
+                    ticks = limit;
+                    status = VMStatus::LoopLimit;
+                    return false;
+                }
+            }
+        }
+        case NodeKind::BlockStmt:
+            for (const StmtNode *stmt : static_cast<const BlockStmtNode *>(node)->stmts)
+                if (!exec(stmt))
+                    return false;
+            return true;
+        case NodeKind::ReadStmt: {
+            string_view name = static_cast<const ReadStmtNode *>(node)->varName.str();
+            status = input->next(value);
+            if (status != VMStatus::Ok)
+                return false;
+            vars[name] = types[name] == ValueType::Bool ? value != 0 : value;
+            return true;
+        }
+        case NodeKind::WriteStmt:
+            writeValue(*output, vars[static_cast<const WriteStmtNode *>(node)->varName.str()]);
+            return true;
+        default:
+            return true;
+        }
+    }
+};
+
+struct Kernel {
+    const char *name;
+    const char *source;
+    const char *input;
+};
+
+// 以 while 为主的小程序：试除法数素数、二重循环累加、Collatz 步数
+const Kernel KERNELS[] = {
+    {"primes", R"({ int n, i, j, count; bool prime;
+read n;
+i = 2;
+while i <= n do {
+    prime := true;
+    j = 2;
+    while j * j <= i && prime do {
+        if i / j * j == i then prime := false;
+        j = j + 1;
+    }
+    if prime then count = count + 1;
+    i = i + 1;
+}
+write count;
+})", "30000"},
+    {"nested", R"({ int n, i, j, sum;
+read n;
+i = 0;
+while i < n do {
+    j = 0;
+    while j < n do {
+        sum = sum + i * j - j / 3 + (i - j) * 7;
+        j = j + 1;
+    }
+    i = i + 1;
+}
+write sum;
+})", "700"},
+    {"collatz", R"({ int n, k, x, steps, longest;
+read n;
+k = 1;
+while k <= n do {
+    x = k;
+    steps = 0;
+    while x != 1 do {
+        if x / 2 * 2 == x then x = x / 2; else x = 3 * x + 1;
+        steps = steps + 1;
+    }
+    if steps > longest then longest = steps;
+    k = k + 1;
+}
+write longest;
+})", "20000"},
+};
+
+struct Outcome {
+    VMStatus status;
+    uint64_t iterations;
+    string output;
+
+    bool operator==(const Outcome &other) const {
+        return status == other.status && iterations == other.iterations && output == other.output;
+    }
+};
+
+Outcome runVM(const BytecodeModule &module, string_view input, uint64_t limit) {
+    Outcome result;
+    VMInput in(input);
+    OutputBuffer out(4096);
+    out.openString(result.output);
+    VM vm(module);
+    vm.setLoopLimit(limit);
+    result.status = vm.run(in, out);
+    result.iterations = vm.iterations();
+    out.close();
+    return result;
+}
+
+Outcome runWalker(const ProgramNode &program, string_view input, uint64_t limit) {
+    Outcome result;
+    VMInput in(input);
+    OutputBuffer out(4096);
+    out.openString(result.output);
+    TreeWalker walker(program, limit);
+    result.status = walker.run(in, out);
+    result.iterations = walker.iterations();
+    out.close();
+    return result;
+}
+
+// 同一串数字从文件描述符分批读入（跨越 64KB 边界）与从内存读入的结果应相同
+bool checkBatchedInput() {
+    string text;
+    for (int i = 0; i < 50000; i++)
+        text += to_string(i * 7919 - 100000) + (i % 10 ? " " : "\n");
+    FILE *file = tmpfile();
+    if (!file || fwrite(text.data(), 1, text.size(), file) != text.size() || fflush(file) != 0)
+        return false;
+    rewind(file);
+    VMInput fromFd(fileno(file)), fromMemory(text);
+    int32_t a, b;
+    VMStatus sa, sb;
+    do {
+        sa = fromFd.next(a);
+        sb = fromMemory.next(b);
+        if (sa != sb || (sa == VMStatus::Ok && a != b)) {
+            fclose(file);
+            return false;
+        }
+    } while (sa == VMStatus::Ok);
+    fclose(file);
+    return sa == VMStatus::InputExhausted;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t randomPrograms = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+    bool ok = true;
+    Arena arena;
+    BytecodeCompiler compiler;
+    BytecodeModule module;
+
+    printf("%-10s %12s %12s %8s\n", "程序", "树遍历(ms)", "VM(ms)", "加速比");
+    for (const Kernel &kernel : KERNELS) {
+        Lexer lexer(string_view(kernel.source));
+        Parser parser(lexer);
+        arena.reset();
+        ProgramNode *program = parser.parseProgram(arena);
+        if (!parser.diagnostics().empty() || !compiler.compile(*program, module)) {
+            fprintf(stderr, "%s 无法编译: %s\n", kernel.name, compiler.error().c_str());
+            return EXIT_FAILURE;
+        }
+        Outcome walked, executed;
+        double walkerSeconds = seconds([&] { walked = runWalker(*program, kernel.input, 0); });
+        double vmSeconds = 1e30;
+        for (int i = 0; i < 3; i++)
+            vmSeconds = min(vmSeconds, seconds([&] { executed = runVM(module, kernel.input, 0); }));
+        bool same = walked == executed && executed.status == VMStatus::Ok;
+        ok &= same;
+        printf("%-10s %12.2f %12.2f %7.1fx%s\n", kernel.name, walkerSeconds * 1e3, vmSeconds * 1e3,
+               walkerSeconds / vmSeconds, same ? "" : "  结果不一致");
+    }
+
+    bool batched = checkBatchedInput();
+    ok &= batched;
+    printf("分批读入输入: %s\n", batched ? "一致" : "不一致");
+
+    // 随机程序：除零、输入耗尽与循环超限都很常见，停止原因也要一致
+    size_t mismatches = 0, byStatus[5] = {};
+    double vmSeconds = 0, walkerSeconds = 0;
+    for (size_t seed = 1; seed <= randomPrograms; seed++) {
+        CorpusOptions options;
+        options.bytes = 1500;
+        options.depth = 3;
+        options.functions = 0;
+        options.identifiers = 8;
+        options.seed = seed;
+        string source;
+        CorpusGenerator(options).generate([&](const char *data, size_t n) { source.append(data, n); });
+        uint64_t state = seed * 0x9e3779b97f4a7c15ULL;
+        auto random = [&](int range) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<int>((state >> 33) % static_cast<uint64_t>(range));
+        };
+        string input, init;
+        for (int i = 0; i < 32; i++)
+            input += to_string(random(200) - 50) + " ";
+        // 在声明之后给 int 变量赋非零初值，否则大多数程序在第一次除法时就停止
+        for (size_t i = 0; i < options.identifiers; i++)
+            init += "v" + to_string(i) + " = " + to_string(random(40) + 1) + ";\n";
+        size_t declEnd = 0;
+        while (source.compare(declEnd, 4, "int ") == 0 || source.compare(declEnd, 5, "bool ") == 0)
+            declEnd = source.find('\n', declEnd) + 1;
+        source.insert(declEnd, init);
+
+        Lexer lexer(source);
+        Parser parser(lexer);
+        arena.reset();
+        ProgramNode *program = parser.parseProgram(arena);
+        if (!parser.diagnostics().empty() || !compiler.compile(*program, module)) {
+            fprintf(stderr, "种子 %zu 无法编译: %s\n", seed, compiler.error().c_str());
+            mismatches++;
+            continue;
+        }
+        Outcome walked, executed;
+        walkerSeconds += seconds([&] { walked = runWalker(*program, input, 5000); });
+        vmSeconds += seconds([&] { executed = runVM(module, input, 5000); });
+        byStatus[static_cast<size_t>(executed.status)]++;
+        if (!(walked == executed)) {
+            if (mismatches < 5)
+                fprintf(stderr, "种子 %zu 结果不一致: VM %s，树遍历 %s\n", seed, vmStatusMessage(executed.status),
+                        vmStatusMessage(walked.status));
+            mismatches++;
+        }
+    }
+    printf("随机程序 %zu 个：不一致 %zu；停止原因 完成 %zu / 输入耗尽 %zu / 除零 %zu / 循环超限 %zu\n", randomPrograms,
+           mismatches, byStatus[0], byStatus[1], byStatus[3], byStatus[4]);
+    printf("  树遍历 %.0f 程序/秒，VM %.0f 程序/秒\n", randomPrograms / walkerSeconds, randomPrograms / vmSeconds);
+    ok &= mismatches == 0;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
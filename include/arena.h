@@ -0,0 +1,100 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 连续存放在 Arena 中的定长数组视图。由 Arena::copyList 创建，不拥有内存。
+template <typename T>
+class ArenaList {
+public:
+    ArenaList() = default;
+    ArenaList(T *items, uint32_t count) : items(items), count(count) {}
+
+    T *begin() const { return items; }
+    T *end() const { return items + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T &front() const { return items[0]; }
+    T &back() const { return items[count - 1]; }
+    T &operator[](size_t i) const { return items[i]; }
+
+private:
+    T *items = nullptr;
+    uint32_t count = 0;
+};
+
+// 指针碰撞式分配器：一次解析的所有 AST 节点都从这里分配，分配只是移动指针，
+// 释放则是整体丢弃。Arena 不会调用对象的析构函数，因此放入其中的对象不能
+// 持有需要析构的资源（std::string、std::vector、unique_ptr 等）。
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(ptr) + align - 1) & ~(uintptr_t)(align - 1);
+        if (p + size > reinterpret_cast<uintptr_t>(limit))
+            return allocateSlow(size, align);
+        ptr = reinterpret_cast<char *>(p + size);
+        return reinterpret_cast<void *>(p);
+    }
+
+    template <typename T, typename... Args>
+    T *make(Args &&...args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // 把 n 个元素复制进 Arena，返回其视图
+    template <typename T>
+    ArenaList<T> copyList(const T *src, size_t n) {
+        if (n == 0)
+            return {};
+        T *dst = static_cast<T *>(allocate(sizeof(T) * n, alignof(T)));
+        for (size_t i = 0; i < n; i++)
+            new (dst + i) T(src[i]);
+        return {dst, static_cast<uint32_t>(n)};
+    }
+
+    // 把字符串复制进 Arena，使其生命周期与 AST 一致而不依赖源码缓冲区
+    std::string_view copyString(std::string_view s) {
+        if (s.empty())
+            return {};
+        char *dst = static_cast<char *>(allocate(s.size(), 1));
+        std::memcpy(dst, s.data(), s.size());
+        return {dst, s.size()};
+    }
+
+    // 丢弃所有对象但保留已申请的内存块，供下一次解析复用
+    void reset();
+    // 接管 other 中的全部对象：other 已用的块并入本 Arena（排在当前块之前，按已用满处理），
+    // 其中对象的生命周期随之与本 Arena 一致；other 只留下空闲块并复位
+    void adopt(Arena &other);
+
+    size_t bytesUsed() const;       // 已分配给对象的字节数（含对齐填充）
+    size_t bytesReserved() const;   // 向系统申请的总字节数
+
+private:
+    struct Block {
+        char *data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;     // 正在使用的块下标
+    char *ptr = nullptr;    // 当前块中下一个空闲字节
+    char *limit = nullptr;  // 当前块末尾
+    size_t blockSize;
+    size_t usedBefore = 0;  // current 之前各块已用字节数
+
+    void *allocateSlow(size_t size, size_t align);
+};
+
+#endif // ARENA_H
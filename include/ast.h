@@ -1,10 +1,14 @@
 #ifndef AST_H
 #define AST_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <iostream>
+#include "arena.h"
+#include "interner.h"
 
 using namespace std;
 
@@ -13,9 +17,73 @@ inline void printIndent(ostream &out, int indent) {
         out << "  ";
 }
 
+// 运算符。赋值与一元运算也以 BinaryExprNode 表示：
+//   一元负号 -x  表示为 0 - x（Sub，左操作数是字面量 0）
+//   逻辑非   !x  表示为 Not，左操作数为空、操作数在 right
+enum class BinaryOp : uint8_t {
+    Add, Sub, Mul, Div,
+    Assign,         // =  整型赋值
+    BoolAssign,     // := 布尔赋值
+    Eq, Ne, Lt, Le, Gt, Ge,
+    And, Or,
+    Not,            // !  逻辑非（一元）
+};
+
+inline const char *opName(BinaryOp op) {
+    static const char *const NAMES[] = {"+", "-", "*", "/", "=", ":=",
+                                        "==", "!=", "<", "<=", ">", ">=", "&&", "||", "!"};
+    return NAMES[static_cast<int>(op)];
+}
+
+// 由运算符文本得到 BinaryOp，不是运算符时返回 false
+inline bool binaryOpFromName(string_view name, BinaryOp &op) {
+    for (int i = 0; i <= static_cast<int>(BinaryOp::Not); i++) {
+        if (name == opName(static_cast<BinaryOp>(i))) {
+            op = static_cast<BinaryOp>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 声明、参数与函数返回值的类型
+enum class ValueType : uint8_t { Int, Bool };
+
+inline const char *typeName(ValueType type) {
+    return type == ValueType::Int ? "int" : "bool";
+}
+
+inline ostream &operator<<(ostream &out, BinaryOp op) { return out << opName(op); }
+inline ostream &operator<<(ostream &out, ValueType type) { return out << typeName(type); }
+
+// 节点种类，供遍历代码按种类分派而不必逐个 dynamic_cast
+enum class NodeKind : uint8_t {
+    Literal,
+    Identifier,
+    BinaryExpr,
+    ExprStmt,
+    IfStmt,
+    WhileStmt,
+    BlockStmt,
+    ReadStmt,
+    WriteStmt,
+    Decl,
+    FuncDef,
+    Program,
+};
+
 // 基类：抽象语法树节点
+// 节点都分配在 Arena 中，子节点以裸指针引用、名字与字面量以驻留后的 Symbol 保存，
+// 整棵树随 Arena 一次性释放，不逐个调用析构函数。
 class ASTNode {
 public:
+    const NodeKind kind;
+    // 节点在源码中的字节偏移（占用 kind 之后的填充，不增加节点大小）。顶层项（函数定义、
+    // 全局声明与全局语句）相对源码开头，其余节点相对所在顶层项的起点，因此平移或拼接顶层项
+    // 时不必改动子树；超过 4GB 的源码按 2^32 取模。从二进制格式读回的树没有位置，均为 0；
+    // 共享的表达式节点（见 expr_dag.h）只记录第一次出现的位置
+    uint32_t offset = 0;
+    explicit ASTNode(NodeKind kind) : kind(kind) {}
     virtual ~ASTNode() = default;
     virtual void print(ostream &out, int indent = 0) const = 0;
 };
@@ -24,13 +92,16 @@ public:
 // 表达式节点及其派生类
 //==========================
 
-class ExprNode : public ASTNode {};
+class ExprNode : public ASTNode {
+public:
+    using ASTNode::ASTNode;
+};
 
 // 字面量表达式节点（数字常量）
 class LiteralExprNode : public ExprNode {
 public:
-    string value;
-    LiteralExprNode(const string &val) : value(val) {}
+    Symbol value;
+    LiteralExprNode(Symbol val) : ExprNode(NodeKind::Literal), value(val) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "Literal: " << value << "\n";
@@ -40,22 +111,22 @@ public:
 // 标识符表达式节点（变量引用）
 class IdentifierExprNode : public ExprNode {
 public:
-    string name;
-    IdentifierExprNode(const string &n) : name(n) {}
+    Symbol name;
+    IdentifierExprNode(Symbol n) : ExprNode(NodeKind::Identifier), name(n) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "Identifier: " << name << "\n";
     }
 };
 
-// 二元表达式节点（例如加法、赋值等）
+// 二元表达式节点（例如加法、赋值等）；逻辑非的 left 为空
 class BinaryExprNode : public ExprNode {
 public:
-    string op;
-    unique_ptr<ExprNode> left;
-    unique_ptr<ExprNode> right;
-    BinaryExprNode(string op, unique_ptr<ExprNode> left, unique_ptr<ExprNode> right)
-        : op(op), left(move(left)), right(move(right)) {}
+    BinaryOp op;
+    ExprNode *left;
+    ExprNode *right;
+    BinaryExprNode(BinaryOp op, ExprNode *left, ExprNode *right)
+        : ExprNode(NodeKind::BinaryExpr), op(op), left(left), right(right) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "BinaryExpr: " << op << "\n";
@@ -68,13 +139,16 @@ public:
 // 语句节点及其派生类
 //==========================
 
-class StmtNode : public ASTNode {};
+class StmtNode : public ASTNode {
+public:
+    using ASTNode::ASTNode;
+};
 
 // 表达式语句节点
 class ExprStmtNode : public StmtNode {
 public:
-    unique_ptr<ExprNode> expr;
-    ExprStmtNode(unique_ptr<ExprNode> e) : expr(move(e)) {}
+    ExprNode *expr;
+    ExprStmtNode(ExprNode *e) : StmtNode(NodeKind::ExprStmt), expr(e) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "ExprStmt:\n";
@@ -86,9 +160,10 @@ public:
 // if 语句节点
 class IfStmtNode : public StmtNode {
 public:
-    unique_ptr<ExprNode> condition;
-    unique_ptr<StmtNode> thenStmt;
-    unique_ptr<StmtNode> elseStmt; // 可选
+    ExprNode *condition = nullptr;
+    StmtNode *thenStmt = nullptr;
+    StmtNode *elseStmt = nullptr; // 可选
+    IfStmtNode() : StmtNode(NodeKind::IfStmt) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "IfStmt:\n";
@@ -111,8 +186,9 @@ public:
 // while 语句节点
 class WhileStmtNode : public StmtNode {
 public:
-    unique_ptr<ExprNode> condition;
-    unique_ptr<StmtNode> body;
+    ExprNode *condition = nullptr;
+    StmtNode *body = nullptr;
+    WhileStmtNode() : StmtNode(NodeKind::WhileStmt) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "WhileStmt:\n";
@@ -130,7 +206,8 @@ public:
 // 复合语句（块语句）节点
 class BlockStmtNode : public StmtNode {
 public:
-    vector<unique_ptr<StmtNode>> stmts;
+    ArenaList<StmtNode *> stmts;
+    BlockStmtNode() : StmtNode(NodeKind::BlockStmt) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "BlockStmt:\n";
@@ -143,8 +220,8 @@ public:
 // read 语句节点
 class ReadStmtNode : public StmtNode {
 public:
-    string varName;
-    ReadStmtNode(const string &name) : varName(name) {}
+    Symbol varName;
+    ReadStmtNode(Symbol name) : StmtNode(NodeKind::ReadStmt), varName(name) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "ReadStmt: " << varName << "\n";
@@ -154,8 +231,8 @@ public:
 // write 语句节点
 class WriteStmtNode : public StmtNode {
 public:
-    string varName;
-    WriteStmtNode(const string &name) : varName(name) {}
+    Symbol varName;
+    WriteStmtNode(Symbol name) : StmtNode(NodeKind::WriteStmt), varName(name) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "WriteStmt: " << varName << "\n";
@@ -169,8 +246,9 @@ public:
 // 声明节点：例如 int a, b; 或 bool flag;
 class DeclNode : public ASTNode {
 public:
-    string type;              // "int" 或 "bool"
-    vector<string> names;     // 变量名列表
+    ValueType type = ValueType::Int;
+    ArenaList<Symbol> names;         // 变量名列表
+    DeclNode() : ASTNode(NodeKind::Decl) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "Decl: " << type << " ";
@@ -183,18 +261,19 @@ public:
 
 // 用于表示函数参数
 struct Parameter {
-    string type;        // 参数类型，如 "int" 或 "bool"
-    string name;        // 参数名
-    string defaultVal;  // 默认值（如果有），否则为空
+    ValueType type;     // 参数类型
+    Symbol name;        // 参数名
+    Symbol defaultVal;  // 默认值（如果有），否则为空
 };
 
 // 函数定义节点
 class FuncDefNode : public ASTNode {
 public:
-    string returnType;                // 返回类型，如 "int" 或 "bool"
-    string name;                      // 函数名
-    vector<Parameter> params;         // 参数列表
-    unique_ptr<BlockStmtNode> body;   // 函数体（块语句）
+    ValueType returnType = ValueType::Int;  // 返回类型
+    Symbol name;                      // 函数名
+    ArenaList<Parameter> params;      // 参数列表
+    BlockStmtNode *body = nullptr;    // 函数体（块语句）
+    FuncDefNode() : ASTNode(NodeKind::FuncDef) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "FuncDef: " << returnType << " " << name << "\n";
@@ -217,9 +296,14 @@ public:
 // 程序节点：包括函数定义、声明和语句
 class ProgramNode : public ASTNode {
 public:
-    vector<unique_ptr<FuncDefNode>> functions; // 函数定义
-    vector<unique_ptr<ASTNode>> decls;           // 全局声明（可选）
-    vector<unique_ptr<ASTNode>> stmts;           // 全局执行语句（可选）
+    ArenaList<FuncDefNode *> functions;  // 函数定义
+    ArenaList<ASTNode *> decls;          // 全局声明（可选）
+    ArenaList<ASTNode *> stmts;          // 全局执行语句（可选）
+    uint32_t symbolCount = 0;            // 本次解析驻留的符号数，Symbol::id() 不超过此值
+    // 通过 Parser::parseProgram() 得到的树由自身持有节点所在的 Arena；
+    // 使用调用方提供的 Arena 时为空，树的生命周期由该 Arena 决定
+    unique_ptr<Arena> ownedArena;
+    ProgramNode() : ASTNode(NodeKind::Program) {}
     void print(ostream &out, int indent = 0) const override {
         printIndent(out, indent);
         out << "Program\n";
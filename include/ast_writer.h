@@ -0,0 +1,107 @@
+#ifndef AST_WRITER_H
+#define AST_WRITER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ast.h"
+
+// 大块输出缓冲：攒满后用一次 write(2) 写到文件描述符，或追加到内存中的字符串。
+// 缓冲区在多次 open/close 之间复用，不随文件重新分配。
+class OutputBuffer {
+public:
+    explicit OutputBuffer(size_t capacity = 1 << 20);
+    ~OutputBuffer();
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    // 打开（截断）输出文件；失败返回 false
+    bool open(const std::string &path);
+    // 输出到内存字符串，内容追加在 target 末尾
+    void openString(std::string &target);
+    // 输出到已打开的文件描述符（如标准输出），close 时不关闭它
+    void attach(int fd);
+    // 写出剩余内容并关闭；任何一次写失败都会使返回值为 false
+    bool close();
+
+    void append(const char *s, size_t n) {
+        if (n > buf.size() - used) {
+            flush();
+            if (n > buf.size()) {
+                writeOut(s, n);
+                return;
+            }
+        }
+        std::memcpy(buf.data() + used, s, n);
+        used += n;
+    }
+    void append(std::string_view s) { append(s.data(), s.size()); }
+    void put(char c) {
+        if (used == buf.size())
+            flush();
+        buf[used++] = c;
+    }
+    // 输出 indent 级缩进（每级两个空格），来自预先生成的空格串
+    void indent(int level);
+
+private:
+    std::vector<char> buf;
+    size_t used = 0;
+    int fd = -1;
+    bool ownsFd = false;
+    std::string *target = nullptr;
+    bool failed = false;
+
+    void flush();
+    void writeOut(const char *s, size_t n);
+};
+
+enum class OutputFormat { Text, Json, Binary };
+
+// 解析 --format 的取值：text、json 或 binary
+bool parseOutputFormat(std::string_view name, OutputFormat &format);
+// 各格式输出文件的扩展名（text 为空，保持与输入文件同名）
+const char *outputExtension(OutputFormat format);
+
+// 以 JSON 字符串字面量输出 s（加引号，转义引号、反斜杠与控制字符）
+void writeJsonString(OutputBuffer &out, std::string_view s);
+
+// AST 序列化。text 格式与 ProgramNode::print 的输出逐字节相同；
+// json 为单行 JSON；binary 为紧凑的先序编码，可用 readBinaryAST 读回。
+// 同一个 ASTWriter 可以反复 write，遍历栈与字符串表的容量随之复用。
+class ASTWriter {
+public:
+    explicit ASTWriter(OutputBuffer &out) : out(out) {}
+
+    void write(const ProgramNode &program, OutputFormat format);
+    // 以对应格式输出语法错误（text 格式为 "语法分析错误: <message>"）
+    void writeError(std::string_view message, OutputFormat format);
+
+private:
+    OutputBuffer &out;
+    std::vector<uint32_t> stringIndex;  // binary：Symbol id -> 字符串表下标 + 1
+    uint32_t stringCount = 0;
+
+    // 遍历的显式栈：待输出的子节点，或 node 为空时在 indent 级缩进处输出的固定文本
+    struct Pending {
+        const ASTNode *node;
+        const char *text;
+        int indent;
+    };
+    std::vector<Pending> pending;
+
+    void textNode(const ASTNode *node, int indent);
+    void jsonNode(const ASTNode *node);
+    void jsonString(std::string_view s);
+    void binaryNode(const ASTNode *node);
+    void binaryString(Symbol symbol);
+    void varint(uint64_t value);
+};
+
+// 读取 binary 格式，节点分配在 arena 中。数据损坏时抛出 std::runtime_error；
+// 若数据记录的是语法错误，返回 nullptr 并把错误信息写入 error。
+ProgramNode *readBinaryAST(std::string_view data, Arena &arena, std::string &error);
+
+#endif // AST_WRITER_H
@@ -0,0 +1,133 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ast.h"
+
+// LittleC 字节码：寄存器式三地址指令，由 BytecodeCompiler 从 AST 生成，在 VM（vm.h）中执行。
+//
+// 所有值都是 32 位整数（bool 为 0/1），按寄存器编号存取。寄存器在编译时分配：
+//   [0, globalCount)                     全局变量，按声明顺序
+//   [globalCount, constantEnd)           常量，执行前装入初值，之后只读
+//   [constantEnd, registerCount)         当前代码块的参数与临时值
+// 顶层语句与每个函数体各自编译成一段以 Halt 结尾的代码，共用第三段寄存器。
+enum class Opcode : uint8_t {
+    Move,           // r[a] = r[b]
+    Add,            // r[a] = r[b] + r[c]，32 位回绕
+    Sub,
+    Mul,
+    Div,            // 除数为 0 时停止执行（VMStatus::DivideByZero）
+    Eq,             // r[a] = r[b] == r[c] ? 1 : 0
+    Ne,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    Jump,           // 跳到 b
+    JumpIfZero,     // r[a] == 0 时跳到 b
+    JumpIfNonZero,
+    JumpEq,         // r[a] == r[b] 时跳到 c（条件判断与分支合为一条指令）
+    JumpNe,
+    JumpLt,
+    JumpLe,
+    JumpGt,
+    JumpGe,
+    LoopTick,       // while 每次迭代执行一次，消耗一次迭代额度
+    ReadInt,        // 从输入读一个整数到 r[a]
+    ReadBool,       // 同上，非 0 存为 1
+    Write,          // 输出 r[a] 与换行
+    Halt,
+};
+
+constexpr size_t OPCODE_COUNT = static_cast<size_t>(Opcode::Halt) + 1;
+
+const char *opcodeName(Opcode op);
+
+// 常量文本的值：十进制整数（超出 32 位时回绕）或 true / false。其他文本返回 false
+bool literalValue(std::string_view text, int32_t &value);
+
+struct Instruction {
+    uint32_t op : 8;
+    uint32_t a : 24;
+    uint32_t b;
+    uint32_t c;
+
+    Opcode opcode() const { return static_cast<Opcode>(op); }
+};
+
+static_assert(sizeof(Instruction) == 12, "指令应为 12 字节");
+
+struct BytecodeFunction {
+    std::string name;
+    ValueType returnType = ValueType::Int;
+    uint32_t entry = 0;                 // 第一条指令
+    uint32_t paramBase = 0;             // 第一个参数的寄存器，其余参数依次排列
+    std::vector<ValueType> paramTypes;
+    std::vector<int32_t> defaults;      // 参数的默认值，没有默认值时为 0
+};
+
+struct BytecodeModule {
+    std::vector<Instruction> code;
+    std::vector<int32_t> initialRegisters;  // 全局变量（0）与常量的初值
+    uint32_t registerCount = 0;
+    uint32_t globalCount = 0;
+    std::vector<std::string> globalNames;
+    uint32_t mainEntry = 0;                 // 顶层语句
+    std::vector<BytecodeFunction> functions;
+
+    // 按名字查找，找不到时返回 -1
+    int findGlobal(std::string_view name) const;
+    int findFunction(std::string_view name) const;
+    // 每行一条指令的可读列表，调试用
+    std::string disassemble() const;
+};
+
+// AST -> 字节码。名字在编译时解析为寄存器：函数参数遮蔽同名全局变量，未声明的 true / false
+// 视为布尔常量。只接受没有语法错误的 AST；遇到未声明的变量、浮点常量等无法执行的程序时
+// 返回 false，原因见 error()。
+// 表达式与语句都用显式任务栈编译，嵌套深度不受调用栈限制。
+class BytecodeCompiler {
+public:
+    bool compile(const ProgramNode &program, BytecodeModule &out);
+    const std::string &error() const { return lastError; }
+
+private:
+    enum class TaskKind : uint8_t;
+    struct Task {
+        TaskKind kind;
+        bool sense;             // Branch 类任务：条件为真（true）还是为假时跳转
+        const ASTNode *node;
+        uint32_t x;             // 标签、目标寄存器等，含义随任务而定
+        uint32_t y;
+    };
+
+    BytecodeModule *module = nullptr;
+    std::string lastError;
+    std::vector<int32_t> slotOf;        // Symbol id -> 变量寄存器，-1 表示未声明
+    std::vector<ValueType> globalTypes;
+    std::vector<ValueType> localTypes;  // 当前函数的参数
+    std::unordered_map<int32_t, uint32_t> constants;    // 常量值 -> 寄存器
+    // 参数与临时值先按代码块内的编号分配（带 LOCAL 标记），全部编译完成、常量个数确定后再换算
+    uint32_t tempTop = 0, tempMax = 0;
+    std::vector<uint32_t> labels;       // 标签 -> 指令下标
+    std::vector<Task> tasks;
+    std::vector<uint32_t> values;       // 已求值表达式所在的寄存器
+
+    bool fail(std::string message);
+    bool operand(const ExprNode *node, uint32_t &reg);
+    uint32_t constantRegister(int32_t value);
+    ValueType typeOf(uint32_t reg) const;
+    bool isBoolean(const ExprNode *node) const;
+    uint32_t allocTemp();
+    void release(uint32_t reg);
+    uint32_t newLabel();
+    void emit(Opcode op, uint32_t a, uint32_t b = 0, uint32_t c = 0);
+    bool runTasks();
+    void finish();
+};
+
+#endif // BYTECODE_H
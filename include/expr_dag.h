@@ -0,0 +1,69 @@
+#ifndef EXPR_DAG_H
+#define EXPR_DAG_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "ast.h"
+#include "interner.h"
+
+// 表达式节点的构造方式
+enum class ExprMode : uint8_t {
+    Tree,       // 每次出现都分配新节点（默认）
+    Shared,     // 哈希共享：结构相同的表达式子树共用一个节点，AST 成为 DAG；
+                // 输出按引用展开，各种格式的结果与 Tree 逐字节相同
+    Folded,     // 在 Shared 的基础上折叠整数常量的 + - * /，输出中的常量表达式换成结果
+};
+
+// 解析 --exprs 的取值：tree、shared 或 folded
+bool parseExprMode(std::string_view name, ExprMode &mode);
+
+// 一次解析中表达式节点的构造统计。tree* 为按 Tree 方式应分配的节点数与字节数，
+// nodes / bytes 为实际分配的（包括折叠后不再被引用的常量）
+struct ExprStats {
+    uint64_t treeNodes = 0;
+    uint64_t treeBytes = 0;
+    uint64_t nodes = 0;
+    uint64_t bytes = 0;
+    uint64_t reused = 0;    // 复用已有节点的次数
+    uint64_t folded = 0;    // 折叠掉的运算数
+
+    uint64_t savedNodes() const { return treeNodes - nodes; }
+    uint64_t savedBytes() const { return treeBytes - bytes; }
+};
+
+// 哈希共享的表达式构造器，由 Parser 在 Shared / Folded 方式下使用。
+// 子节点先于父节点构造、本身已经共享，因此二元节点按 (运算符, 左子指针, 右子指针) 比较，
+// 叶子按 (种类, Symbol) 比较，查找不必遍历子树。开放寻址表只保存节点指针，
+// 跨解析复用容量，reset 只清空不释放；节点分配在解析所用的 arena 中。
+// 共享的节点只记录第一次出现的位置（相对当时所在的顶层项）。
+//
+// 折叠按 32 位补码回绕计算（与字节码 VM 相同），除数为 0 时保留原表达式留给运行时报告；
+// 负数结果表示为 0 - n，与解析器对负号的表示一致，不需要带符号的字面量。
+class ExprDag {
+public:
+    void reset(Arena &arena, Interner &interner, ExprMode mode);
+    // Identifier 或 Literal 叶子
+    ExprNode *leaf(NodeKind kind, Symbol symbol, uint32_t offset);
+    ExprNode *binary(BinaryOp op, ExprNode *left, ExprNode *right, uint32_t offset);
+    const ExprStats &stats() const { return counts; }
+
+private:
+    Arena *arena = nullptr;
+    Interner *interner = nullptr;
+    ExprMode mode = ExprMode::Shared;
+    ExprStats counts;
+    std::vector<ExprNode *> buckets;    // 开放寻址，线性探测
+    size_t count = 0;
+
+    ExprNode *shareLeaf(NodeKind kind, Symbol symbol, uint32_t offset);
+    ExprNode *shareBinary(BinaryOp op, ExprNode *left, ExprNode *right, uint32_t offset);
+    // 常量 value 的共享表示：非负数为字面量，负数为 0 - (-value)
+    ExprNode *constant(int32_t value, uint32_t offset);
+    ExprNode **slot(size_t hash, NodeKind kind, BinaryOp op, Symbol symbol, const ExprNode *left,
+                    const ExprNode *right);
+    void grow();
+};
+
+#endif // EXPR_DAG_H
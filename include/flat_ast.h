@@ -0,0 +1,88 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+#include "ast.h"
+
+// 扁平 AST：节点按先序排列在若干并列数组中（结构数组），用 32 位下标引用。
+// 节点 i 的后代恰好是 [i + 1, end[i])，第一个孩子是 i + 1，下一个兄弟是 end[孩子]，
+// 因此完整遍历就是一次线性扫描，不需要追指针。
+enum class FlatKind : uint8_t {
+    Program,        // 孩子依次为 FuncList、DeclList、StmtList
+    FuncList,
+    DeclList,
+    StmtList,
+    FuncDef,        // s0 = 返回类型, s1 = 函数名, aux = 参数个数；孩子为各 Param，最后是函数体 Block
+    Param,          // s0 = 类型, s1 = 名字, aux = 默认值字符串（无默认值为 0）
+    Decl,           // s0 = 类型；孩子为各 Name
+    Name,           // s0 = 变量名
+    ExprStmt,       // 孩子为表达式
+    IfStmt,         // 孩子为条件、then、[else]；aux = 是否有 else
+    WhileStmt,      // 孩子为条件、循环体
+    BlockStmt,      // 孩子为各语句
+    ReadStmt,       // s0 = 变量名
+    WriteStmt,      // s0 = 变量名
+    Literal,        // s0 = 字面量
+    Identifier,     // s0 = 标识符
+    BinaryExpr,     // s0 = 运算符；孩子为左、右操作数（逻辑非只有一个）
+};
+
+class FlatAST {
+public:
+    using NodeId = uint32_t;
+    using StrId = uint32_t;     // 字符串表下标，0 固定为空串
+
+    vector<FlatKind> kinds;
+    vector<NodeId> ends;        // 子树结束位置（不含）
+    vector<StrId> s0;
+    vector<StrId> s1;
+    vector<uint32_t> aux;
+
+    FlatAST() { clear(); }
+
+    size_t size() const { return kinds.size(); }
+    void clear();
+
+    NodeId firstChild(NodeId id) const { return id + 1; }
+    NodeId nextSibling(NodeId id) const { return ends[id]; }
+    bool hasChildren(NodeId id) const { return ends[id] > id + 1; }
+
+    string_view str(StrId id) const {
+        return string_view(strData.data() + strOffsets[id], strOffsets[id + 1] - strOffsets[id]);
+    }
+    // 追加一个节点（子树结束位置待 close 时回填），返回其下标
+    NodeId open(FlatKind kind, StrId a = 0, StrId b = 0, uint32_t extra = 0);
+    void close(NodeId id) { ends[id] = static_cast<NodeId>(kinds.size()); }
+    // 字符串入表，相同内容只存一份
+    StrId intern(string_view s);
+
+    // 与现有节点树相互转换；assign 会复用已有数组容量
+    static FlatAST fromTree(const ProgramNode &program);
+    void assign(const ProgramNode &program);
+    ProgramNode *toTree(Arena &arena) const;
+
+    // 输出与 ProgramNode::print 完全相同的文本
+    void print(ostream &out) const;
+
+private:
+    // 语句与表达式子树的转换都用显式栈，嵌套深度不占用调用栈
+    void appendNode(const ASTNode *root);
+    ASTNode *buildNode(NodeId root, Arena &arena, Interner &interner, vector<ASTNode *> &values) const;
+    void rehash(size_t buckets);
+
+    struct AppendTask {
+        const ASTNode *node;    // 为空时回填 id 的子树结束位置
+        NodeId id;
+    };
+    vector<AppendTask> appendStack;
+
+    string strData;
+    vector<uint32_t> strOffsets;    // 第 i 个字符串为 strData[strOffsets[i], strOffsets[i+1])
+    vector<uint32_t> strBuckets;    // intern 用的开放寻址哈希表，存 StrId + 1
+};
+
+#endif // FLAT_AST_H
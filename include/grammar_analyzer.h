@@ -0,0 +1,51 @@
+#ifndef GRAMMAR_ANALYZER_H
+#define GRAMMAR_ANALYZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "ast.h"
+#include "ast_writer.h"
+#include "lexer.h"
+#include "parser.h"
+
+// libgrammaranalyzer 的 C++ 接口（C 接口见 grammar_analyzer_c.h）。
+//
+// 一个 GrammarAnalyzer 持有 Lexer、Parser 与输出缓冲，ParseResult 由调用方持有。
+// 两者都在调用之间复用已分配的内存：对同一对象反复解析大小相近的输入时，除记录语法错误
+// 外不再分配内存。GrammarAnalyzer 不是线程安全的，每个线程使用自己的实例。
+
+// 一次解析的结果。AST 与其中的名字都分配在 arena 中，不引用源码，
+// 在下一次以它为目标调用 parse 之前有效
+struct ParseResult {
+    Arena arena;
+    ProgramNode *program = nullptr;
+    std::vector<Diagnostic> diagnostics;   // 为空表示 AST 完整
+
+    bool ok() const { return program && diagnostics.empty(); }
+};
+
+class GrammarAnalyzer {
+public:
+    GrammarAnalyzer() = default;
+    GrammarAnalyzer(const GrammarAnalyzer &) = delete;
+    GrammarAnalyzer &operator=(const GrammarAnalyzer &) = delete;
+
+    // 解析 source 到 result，丢弃 result 中原有的 AST。source 只在调用期间借用。
+    // 返回 result.ok()
+    bool parse(std::string_view source, ParseResult &result);
+    // 把 result 按 format 写入 out（覆盖原内容），与命令行的输出文件相同：
+    // 没有语法错误时为 AST，否则为错误信息。source 须为解析 result 时的源码，用于换算行号
+    void write(std::string_view source, const ParseResult &result, OutputFormat format, std::string &out);
+    // 丢弃上一次调用留下的状态，保留缓冲区
+    void reset();
+
+private:
+    Lexer lexer;
+    Parser parser{lexer};
+    OutputBuffer buffer{64 * 1024};
+    ASTWriter writer{buffer};   // 遍历栈与字符串表跨调用复用
+};
+
+#endif // GRAMMAR_ANALYZER_H
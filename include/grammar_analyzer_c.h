@@ -0,0 +1,62 @@
+#ifndef GRAMMAR_ANALYZER_C_H
+#define GRAMMAR_ANALYZER_C_H
+
+/* libgrammaranalyzer 的 C 接口，供非 C++ 的服务在进程内调用。
+ *
+ * 所有函数都不抛出异常；返回的指针归分析器所有，在对同一分析器的下一次 ga_parse、
+ * ga_reset 或 ga_destroy 之前有效。一个分析器同一时间只能由一个线程使用。
+ * analyzer 为 NULL 时各函数不做任何事：ga_parse 返回 GA_FAILED，ga_output 与
+ * ga_diagnostic 返回 NULL（length 写入 0），ga_diagnostic_count 返回 0。 */
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 接口版本：只在不兼容的修改时递增 */
+#define GA_API_VERSION 1
+
+typedef struct ga_analyzer ga_analyzer;
+
+/* ga_parse 的输出格式，与命令行 --format 相同 */
+enum {
+    GA_FORMAT_TEXT = 0,
+    GA_FORMAT_JSON = 1,
+    GA_FORMAT_BINARY = 2
+};
+
+/* ga_parse 的返回值 */
+enum {
+    GA_OK = 0,              /* 解析成功，输出为 AST */
+    GA_SYNTAX_ERROR = 1,    /* 存在语法错误，输出为错误信息，诊断见 ga_diagnostic */
+    GA_FAILED = -1          /* 参数无效或内存不足，输出为错误原因 */
+};
+
+/* 分析器版本字符串，与解析缓存使用的版本相同 */
+const char *ga_version(void);
+int ga_api_version(void);
+
+/* 失败时返回 NULL */
+ga_analyzer *ga_create(void);
+void ga_destroy(ga_analyzer *analyzer);
+/* 丢弃上一次解析的结果，保留已分配的内存 */
+void ga_reset(ga_analyzer *analyzer);
+
+/* 解析 source 的前 length 个字节（不要求以 '\0' 结尾，调用返回后不再引用），
+ * 并按 format 生成输出 */
+int ga_parse(ga_analyzer *analyzer, const char *source, size_t length, int format);
+
+/* 最近一次 ga_parse 的输出；length 非 NULL 时写入字节数。
+ * 文本与 JSON 输出以 '\0' 结尾，二进制输出可能含有 '\0'，应以 length 为准 */
+const char *ga_output(const ga_analyzer *analyzer, size_t *length);
+
+/* 最近一次 ga_parse 的语法错误数与第 index 条错误：返回错误信息，
+ * offset 非 NULL 时写入出错位置在源码中的字节偏移。index 越界时返回 NULL */
+size_t ga_diagnostic_count(const ga_analyzer *analyzer);
+const char *ga_diagnostic(const ga_analyzer *analyzer, size_t index, size_t *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GRAMMAR_ANALYZER_C_H */
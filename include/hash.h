@@ -0,0 +1,16 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+// XXH64（xxHash 64 位版本）的独立实现，输出与参考实现一致。
+// 用于源码内容寻址，每字节约一条指令，远快于解析本身。
+uint64_t xxh64(const void *data, size_t length, uint64_t seed = 0);
+
+inline uint64_t xxh64(std::string_view s, uint64_t seed = 0) {
+    return xxh64(s.data(), s.size(), seed);
+}
+
+#endif // HASH_H
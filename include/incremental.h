@@ -0,0 +1,94 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "ast.h"
+#include "lexer.h"
+#include "parser.h"
+
+// 增量解析器：持有源码全文与对应的 AST，每次编辑只重新分析受影响的顶层项。
+//
+// 每个顶层项（函数定义、声明或语句）记录它在源码中的起点，范围延伸到下一个顶层项
+// （或程序结尾）的第一个 Token 之前。编辑后从受影响的第一个顶层项起点重新
+// 词法、语法分析，直到某个 Token 落在编辑区之后、且恰好是某个旧顶层项（平移后）的起点，
+// 此后的源码与 Token 序列都未改变，旧子树原样复用。
+// ProgramNode 的三个列表直接引用按种类维护的数组，更新时只在其中拼接变化的一段；
+// 每项记录其前面各种类顶层项的个数，用于定位拼接位置。
+//
+// 语法错误按 Parser::parseProgram 的方式恢复：出错的项跳到下一个语句边界，
+// 作为没有节点的项留在项表中（恢复点同样可以作为同步点），项内的诊断随项一起记录、
+// 随项一起被替换或复用。因此输入到一半的语句只重新分析它所在的一段。
+// 只有编辑触及程序开头或被替换的旧节点积累过多时，才退化为全量解析。
+class IncrementalParser {
+public:
+    IncrementalParser() : parser(lexer) {}
+    IncrementalParser(const IncrementalParser &) = delete;
+    IncrementalParser &operator=(const IncrementalParser &) = delete;
+
+    // 以 source 为全文做一次全量解析
+    void reset(std::string source);
+    // 把 [offset, offset + removed) 替换为 inserted 并更新 AST；编辑范围越界时抛出
+    // std::runtime_error。program() 与 diagnostics() 和对全文调用 Parser::parseProgram 的结果一致
+    void applyEdit(size_t offset, size_t removed, std::string_view inserted);
+
+    // 当前 AST，有语法错误时不含出错的顶层项；在下一次 reset/applyEdit 之前有效
+    const ProgramNode *program() const { return &root; }
+    // 当前全文的语法错误，为空表示 AST 完整
+    const std::vector<Diagnostic> &diagnostics() const { return errors; }
+    const std::string &text() const { return source; }
+
+    struct UpdateStats {
+        bool fullReparse = false;
+        size_t reparsedItems = 0;   // 重新解析产生的顶层项数
+        size_t reusedItems = 0;     // 原样复用的顶层项数
+    };
+    const UpdateStats &lastUpdate() const { return stats; }
+
+private:
+    // 顶层项的种类，对应 ProgramNode 的 functions、decls、stmts
+    enum Slot { FuncSlot, DeclSlot, StmtSlot, SlotCount };
+
+    struct Item {
+        ASTNode *node;                  // 出错（已恢复）的项为空
+        size_t start;
+        uint32_t before[SlotCount];     // 此项之前各种类顶层项的个数
+        uint32_t diagsBefore;           // 此项之前各项的诊断条数（itemDiags 中的下标）
+    };
+
+    std::string source;
+    Lexer lexer;
+    Parser parser;
+    Arena nodes;            // 顶层项的节点与驻留的符号；被替换的旧节点留在其中，直到下次全量解析
+    std::vector<Item> items;
+    std::vector<Item> fresh;
+    // 各项的诊断按项的顺序排列，偏移相对源码开头；每项单独解析，未做跨项的去重
+    std::vector<Diagnostic> itemDiags;
+    std::vector<Diagnostic> freshDiags;
+    std::vector<Diagnostic> taken;      // 从解析器取出诊断用的暂存数组
+    std::vector<Diagnostic> errors;     // 对外的诊断：itemDiags 按 Parser::error 的规则去重
+    // 按种类排列的顶层项，root 的三个列表指向这里
+    std::vector<FuncDefNode *> functions;
+    std::vector<ASTNode *> decls;
+    std::vector<ASTNode *> stmts;
+    ProgramNode root;
+    bool wrapped = false;   // 程序是否以 '{' 开始、由一对花括号包围
+    size_t firstToken = 0;  // 程序第一个 Token 的位置
+    size_t bodyEnd = 0;     // 最后一个顶层项之后的位置（wrapped 时为闭合 '}'）
+    size_t liveBytes = 0;   // 上次全量解析后 nodes 的用量
+
+    UpdateStats stats;
+
+    static Slot slotOf(const ASTNode *node);
+    size_t slotSize(Slot slot) const;
+    void place(ASTNode *node, uint32_t index);
+    void fullParse();
+    size_t parseItems(size_t base, size_t syncFrom, size_t k, size_t shift);
+    void takeDiagnostics(size_t base);
+    void updateRoot();
+};
+
+#endif // INCREMENTAL_H
@@ -0,0 +1,67 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+
+// 驻留字符串条目，与其字符一起分配在 Arena 中，随 AST 一起释放
+struct SymbolEntry {
+    uint32_t id;        // 本次解析内从 1 开始的稠密编号
+    uint32_t length;
+    uint32_t hash;
+    const char *chars;
+};
+
+// 驻留后的名字：同一次解析中相同内容的字符串对应同一个条目，
+// 因此比较是一次指针比较，哈希直接使用稠密编号，也可以用 id() 作为数组下标。
+class Symbol {
+public:
+    Symbol() = default;
+    explicit Symbol(const SymbolEntry *entry) : entry(entry) {}
+
+    uint32_t id() const { return entry ? entry->id : 0; }
+    std::string_view str() const {
+        return entry ? std::string_view(entry->chars, entry->length) : std::string_view();
+    }
+    bool empty() const { return entry == nullptr; }
+
+    bool operator==(Symbol other) const { return entry == other.entry; }
+    bool operator!=(Symbol other) const { return entry != other.entry; }
+
+private:
+    const SymbolEntry *entry = nullptr;
+};
+
+inline std::ostream &operator<<(std::ostream &out, Symbol symbol) {
+    return out << symbol.str();
+}
+
+struct SymbolHash {
+    size_t operator()(Symbol symbol) const { return symbol.id(); }
+};
+
+// 单次解析使用的字符串驻留表。条目分配在 reset 时指定的 Arena 中，
+// 哈希表本身跨解析复用，reset 只清空不释放。
+class Interner {
+public:
+    Interner();
+    // 开始新的一轮驻留，之后产生的条目都分配在 arena 中
+    void reset(Arena &arena);
+    Symbol intern(std::string_view s);
+    // 已驻留的符号数；有效 id 为 [1, size()]
+    uint32_t size() const { return count; }
+    // 按 id 列出已驻留的条目：out[id] 为对应条目，out[0] 为空
+    void entries(std::vector<const SymbolEntry *> &out) const;
+
+private:
+    Arena *arena = nullptr;
+    std::vector<const SymbolEntry *> buckets;   // 开放寻址，线性探测
+    uint32_t count = 0;
+
+    void grow();
+};
+
+#endif // INTERNER_H
@@ -1,13 +1,15 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 
 using namespace std;
 
-enum class TokenType
+enum class TokenType : uint8_t
 {
     KEYWORD,
     IDENTIFIER,
@@ -19,27 +21,94 @@ enum class TokenType
     ERROR
 };
 
+// 具体的 Token 种类：每个关键字、运算符与分隔符各占一个，由 Lexer 在扫描时确定，
+// 语法分析只比较整数，不再比较 lexeme。顺序按所属大类分组，见 tokenTypeOf。
+enum class TokenKind : uint8_t
+{
+    Identifier, Integer, Float, End, Error,
+    // 关键字
+    If, Else, While, Int, Bool, Read, Write, Then, Do, Function,
+    // 运算符
+    Plus, Minus, Star, Slash, Assign, BoolAssign, Eq, Ne, Lt, Le, Gt, Ge, And, Or, Not,
+    // 分隔符
+    Semicolon, Comma, LParen, RParen, LBrace, RBrace,
+};
+
+// 种类所属的大类
+constexpr TokenType tokenTypeOf(TokenKind kind) {
+    return kind == TokenKind::Identifier ? TokenType::IDENTIFIER
+         : kind == TokenKind::Integer    ? TokenType::INTEGER
+         : kind == TokenKind::Float      ? TokenType::FLOAT
+         : kind == TokenKind::End        ? TokenType::END
+         : kind == TokenKind::Error      ? TokenType::ERROR
+         : kind <= TokenKind::Function   ? TokenType::KEYWORD
+         : kind <= TokenKind::Not        ? TokenType::OPERATOR
+                                         : TokenType::DELIMITER;
+}
+
+// 关键字、运算符与分隔符的源码写法；其余种类返回空串
+const char *tokenSpelling(TokenKind kind);
+
+// Token 不再持有自己的字符串：lexeme 是指向 Lexer 所保留源码缓冲区的视图，
+// 构造 Token 不产生任何堆分配。Token 的有效期不能超过产生它的源码缓冲区。
 struct Token
 {
     TokenType type;
-    string lexeme;
+    TokenKind kind;
+    string_view lexeme;
+
+    Token() = default;
+    Token(TokenKind kind, string_view lexeme) : type(tokenTypeOf(kind)), kind(kind), lexeme(lexeme) {}
 };
 
 class Lexer
 {
 public:
+    // 向前看窗口大小：parseProgram 区分函数定义与声明需要看 3 个 Token
+    static constexpr size_t LOOKAHEAD = 4;
+
+    Lexer() = default;
+    // 传入 string 时由 Lexer 保留一份源码（右值直接移入，不再复制）；
+    // 传入 string_view 时只借用，调用方需保证缓冲区在 Token 使用期间有效。
+    explicit Lexer(const string &source) { setSource(source); }
+    explicit Lexer(string &&source) { setSource(std::move(source)); }
+    explicit Lexer(string_view source) { setSource(source); }
+    // src 可能指向自身的 buffer，禁止复制以免产生悬空视图
+    Lexer(const Lexer &) = delete;
+    Lexer &operator=(const Lexer &) = delete;
+
+    void setSource(const string &source);
+    void setSource(string &&source);
+    void setSource(string_view source);
+    // 丢弃当前源码与向前看 Token，保留源码缓冲区的容量供下一次 setSource 复用
+    void reset();
+
+    // 拉取式接口：按需产生 Token，只在环形缓冲区中保留少量向前看 Token。
+    // 到达文件末尾后持续返回 END。
+    Token next();
+    // 查看第 k 个尚未消费的 Token（k < LOOKAHEAD），不消费
+    const Token &peek(size_t k = 0);
+
+    // 一次性切分整个源码（保留给需要完整 Token 序列的调用方）
     vector<Token> tokenize(const string &source);
+    vector<Token> tokenize(string &&source);
+    vector<Token> tokenize(string_view source);
+
+    // 当前被分析的源码，以及 Token 在其中的字节偏移
+    string_view source() const { return src; }
+    size_t offsetOf(const Token &token) const { return token.lexeme.data() - src.data(); }
 
 private:
-    void handleComment(size_t &pos, const string &source);
-    bool isKeyword(const string &lexeme);
-    bool isDelimiter(char c);
-    bool isOperatorChar(char c);
-    Token handleIdentifier(size_t &pos, const string &source);
-    Token handleNumber(size_t &pos, const string &source);
-    Token handleOperator(size_t &pos, const string &source);
-    Token handleDelimiter(size_t &pos, const string &source);
-    Token handleError(size_t &pos, const string &source);
+    string buffer;      // 由 Lexer 持有的源码副本（借用模式下为空）
+    string_view src;    // 当前源码视图，所有 Token 的 lexeme 都指向这里
+    size_t cursor = 0;  // 下一个待扫描字节
+
+    Token ring[LOOKAHEAD];  // 向前看环形缓冲区
+    size_t head = 0;        // 最早未消费 Token 在 ring 中的下标
+    size_t count = 0;       // ring 中已扫描未消费的 Token 数
+
+    Token scanToken();
+    vector<Token> drain();
 };
 
 #endif // LEXER_H
@@ -0,0 +1,53 @@
+#ifndef PARALLEL_PARSER_H
+#define PARALLEL_PARSER_H
+
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "thread_pool.h"
+
+// 单个大文件的并行解析。
+//
+// 先对源码做一次字节级预扫描：按与 Lexer 相同的规则跳过空白和注释，跟踪花括号与圆括号深度，
+// 在顶层的 ';' 或 '}' 之后（后面不是 else 时）切分出顶层项的起点。相邻的顶层项合并成
+// 大小相近的若干段，每段由一个工作线程用独立的 Lexer、Parser、Arena 与驻留表解析到段尾。
+// 之后按段的顺序合并驻留表（得到与顺序解析相同的符号编号），各段并行地把子树中的符号
+// 换成合并后的符号，节点所在的 Arena 并入调用方的 arena，按源码顺序拼成一个 ProgramNode。
+//
+// 任一段出现语法错误（或预扫描发现括号不配对）时，改为对整个文件顺序解析，
+// 因此记录的诊断与部分 AST 都与顺序解析完全相同。
+class ParallelParser {
+public:
+    // 源码不足 2 * minChunkBytes 时直接顺序解析
+    explicit ParallelParser(ThreadPool &pool, size_t minChunkBytes = 64 * 1024);
+    ~ParallelParser();
+    ParallelParser(const ParallelParser &) = delete;
+    ParallelParser &operator=(const ParallelParser &) = delete;
+
+    // 结果与 Parser(Lexer(source)).parseProgram(arena) 相同，语法错误见 diagnostics()
+    ProgramNode *parseProgram(std::string_view source, Arena &arena);
+    // 最近一次解析记录的语法错误，与顺序解析的 Parser::diagnostics() 相同
+    const std::vector<Diagnostic> &diagnostics() const { return diags; }
+
+    // 最近一次解析切分出的段数；为 0 表示走了顺序解析
+    size_t lastChunkCount() const { return chunkCount; }
+
+private:
+    struct Chunk;
+
+    ThreadPool &pool;
+    size_t minChunkBytes;
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    size_t chunkCount = 0;
+    std::vector<size_t> itemStarts;
+    Interner interner;
+    std::vector<Diagnostic> diags;
+
+    ProgramNode *parseSequential(std::string_view source, Arena &arena);
+};
+
+#endif // PARALLEL_PARSER_H
@@ -0,0 +1,53 @@
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "ast_writer.h"
+
+// 分析器输出格式的版本号。解析规则或任何输出格式发生变化时必须递增，
+// 旧版本写入的缓存条目随之失效。
+#define ANALYZER_VERSION "littlec-parser/4"
+
+// 按内容寻址的磁盘解析缓存。键为 XXH64(源码)，种子由分析器版本、输出格式、是否做语义检查
+// 与是否折叠常量（会改变输出的 AST）决定；
+// 值是当时写出的完整输出（AST 或错误信息），命中时一次读取即可直接写出结果。
+//
+// 多进程并发安全：条目先写入临时文件再 rename 到位，读者只会看到完整的旧条目或新条目；
+// 淘汰由 flock 保护的目录锁串行化，正在被其他进程读取的文件即使被删除也不影响读取。
+// 每个条目带有源码长度与内容校验，损坏或不匹配的条目按未命中处理并被删除。
+class ParseCache {
+public:
+    // dir 不存在时自动创建，失败抛出 std::runtime_error。maxBytes 为缓存目录的容量上限
+    ParseCache(std::string dir, uint64_t maxBytes);
+
+    static uint64_t keyOf(std::string_view source, OutputFormat format, bool checked = false, bool folded = false);
+
+    struct Entry {
+        bool ok = false;        // 当时是否成功生成 AST
+        std::string message;    // 失败时的错误信息
+        std::string payload;    // 写入输出文件的内容
+    };
+    // 命中时填充 entry 并刷新条目的最近使用时间
+    bool lookup(uint64_t key, std::string_view source, Entry &entry) const;
+    void store(uint64_t key, std::string_view source, const Entry &entry);
+    // 总大小超过上限时按最近使用时间淘汰到上限的 3/4；其他进程正在淘汰时直接返回
+    void trim();
+
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+
+private:
+    std::string dir;
+    uint64_t maxBytes;
+    mutable std::atomic<uint64_t> hitCount{0};
+    mutable std::atomic<uint64_t> missCount{0};
+    std::atomic<uint64_t> bytesSinceTrim{0};
+    std::atomic<uint64_t> tempCounter{0};
+
+    std::string pathOf(uint64_t key) const;
+};
+
+#endif // PARSE_CACHE_H
@@ -3,39 +3,153 @@
 
 #include "ast.h"
 #include "lexer.h"
+#include "arena.h"
+#include "expr_dag.h"
 #include <vector>
 #include <memory>
-#include <stdexcept>
+#include <string>
 
+class FlatAST;
+
+// 语法错误：出错 Token 在 lexer 源码中的字节偏移与错误信息
+struct Diagnostic {
+    size_t offset;
+    std::string message;
+};
+
+// 把诊断逐条格式化为 "第 L 行: <message>"，以换行分隔（行号由 offset 在 source 中换算）
+std::string formatDiagnostics(std::string_view source, const std::vector<Diagnostic> &diags);
+
+// 语法错误不抛异常：错误按出现顺序记录在 diagnostics() 中，随后以恐慌模式跳到下一个
+// 语句边界（';'、'}'、语句关键字）继续解析，出错的语句不进入 AST。
+// 因此一遍解析即可得到全部错误与由其余部分组成的（不完整的）AST。
 class Parser {
 public:
-    Parser(const std::vector<Token> &tokens) : tokens(tokens), pos(0) {}
-    // 解析整个程序，返回 ProgramNode 指针
+    // 从 lexer 按需拉取 Token，不再持有完整的 Token 序列
+    explicit Parser(Lexer &lexer) : lexer(lexer) {}
+    // 解析整个程序，返回 ProgramNode 指针；返回的树自带一个 Arena
     std::unique_ptr<ProgramNode> parseProgram();
+    // 解析整个程序，所有节点（包括 ProgramNode 本身）分配在调用方提供的 arena 中。
+    // 批处理时可以在文件之间 arena.reset() 复用同一块内存。
+    ProgramNode *parseProgram(Arena &arena);
+    // 解析整个程序并输出为扁平 AST（复用 out 已有的数组容量）。
+    // 节点先在解析器自带的暂存 Arena 中生成，随后一次先序遍历写入 out。
+    void parseProgram(FlatAST &out);
+
+    // 逐个解析顶层项，供增量解析使用。beginItems 指定节点所在的 arena 并清空暂存区，
+    // resetSymbols 为 true 时同时复位驻留表（否则沿用之前驻留的符号）；
+    // 之后每次 parseItem 从 lexer 当前位置解析一个函数定义、声明或语句，出错时返回 nullptr，
+    // 此时 recoverItem 按 parseProgram 的方式跳到下一个语句边界（start 为该项第一个 Token 的位置）。
+    void beginItems(Arena &arena, bool resetSymbols);
+    ASTNode *parseItem();
+    void recoverItem(size_t start) { synchronize(start); }
+    uint32_t symbolCount() const { return interner.size(); }
+
+    // 最近一次解析记录的语法错误；为空表示解析成功、AST 完整
+    const std::vector<Diagnostic> &diagnostics() const { return diags; }
+    bool hasErrors() const { return !diags.empty(); }
+    // 与 out 交换诊断数组：取走诊断而不复制消息，out 原有的数组留给下一次解析复用
+    void swapDiagnostics(std::vector<Diagnostic> &out) { diags.swap(out); }
+    // 丢弃上一次解析留下的诊断、暂存区与扁平 AST 的中间树，保留各缓冲区的容量
+    //（parseProgram 开始时也会复位这些状态）
+    void reset();
+    // 本次解析驻留的符号，按 id 排列（见 Interner::entries）
+    void symbolEntries(std::vector<const SymbolEntry *> &out) const { interner.entries(out); }
+    // 表达式节点的构造方式（默认 ExprMode::Tree），对之后的每次解析生效，见 expr_dag.h
+    void setExprMode(ExprMode mode) { exprMode = mode; }
+    // 最近一次以 Shared / Folded 方式解析时的表达式节点统计
+    const ExprStats &exprStats() const { return exprDag.stats(); }
 
 private:
-    std::vector<Token> tokens;
-    size_t pos;
+    Lexer &lexer;
+    Arena *arena = nullptr;     // 当前解析使用的 Arena
+    Arena flatScratch;          // parseProgram(FlatAST&) 的中间树，每次解析前复位
+    Interner interner;          // 名字与字面量驻留表，每次解析前复位，条目分配在 arena 中
+    ExprMode exprMode = ExprMode::Tree;
+    ExprDag exprDag;            // Shared / Folded 方式的共享表，与驻留表一同复位
+    std::vector<Diagnostic> diags;
+    size_t itemStart = 0;       // 当前顶层项第一个 Token 的位置，子节点的偏移相对于它
+
+    // 构造节点列表用的暂存区：按栈的方式使用，嵌套块各自记录起点，
+    // 结束时把自己的那一段复制进 Arena 并截断，跨文件复用不再分配
+    std::vector<StmtNode *> stmtScratch;
+    std::vector<FuncDefNode *> funcScratch;
+    std::vector<ASTNode *> declScratch;
+    std::vector<ASTNode *> topStmtScratch;
+    std::vector<Symbol> nameScratch;
+    std::vector<Parameter> paramScratch;
+
+    const Token &currentToken();
+    const Token &peekToken(size_t k);
+    // 当前位置是否为函数定义开头： int|bool IDENT (
+    bool atFuncDef();
+    // int/bool 关键字对应的类型
+    static ValueType typeOf(const Token &token);
+    // 在 arena 中构造节点，偏移记为源码位置 pos 相对当前顶层项的距离
+    template <typename T, typename... Args>
+    T *makeNode(size_t pos, Args &&...args) {
+        T *node = arena->make<T>(std::forward<Args>(args)...);
+        node->offset = static_cast<uint32_t>(pos - itemStart);
+        return node;
+    }
+    // 当前 Token 是否为 kind；语法分析只按 TokenKind 分派，不比较 lexeme
+    bool at(TokenKind kind) { return currentToken().kind == kind; }
+    // 当前 Token 不符合预期时记录错误并返回 false，不前进
+    bool consume(TokenKind expected);
+    bool match(TokenKind kind);
+    // 在当前 Token 处记录语法错误；与上一个错误位于同一 Token 时不再重复记录
+    void error(std::string message);
+    // 恐慌模式恢复：跳到下一个语句边界。start 为出错语句第一个 Token 的位置
+    void synchronize(size_t start);
 
-    Token currentToken();
-    void consume(TokenType expected, const std::string &expectedLexeme = "");
-    bool match(TokenType type, const std::string &lexeme = "");
+    void parseProgramBody(ProgramNode &program);
+    void parseTopLevelItem();
 
+    // 以下解析函数出错时记录错误并返回 nullptr，由语句列表所在的一层负责恢复
     // 新增：函数定义解析
-    std::unique_ptr<FuncDefNode> parseFuncDef();
+    FuncDefNode *parseFuncDef();
 
     // 解析全局声明（变量声明）
-    std::unique_ptr<DeclNode> parseDecl();
+    DeclNode *parseDecl();
+
+    // 语句解析：不递归，嵌套的 if/while/块记录在 stmtFrames 中
+    StmtNode *parseStmt();
+    // 解析一条语句的开头：简单语句直接返回；复合语句压入一帧后返回 nullptr，由 parseStmt 继续
+    StmtNode *beginStmt();
+    BlockStmtNode *parseBlock();
+
+    // 表达式解析：表驱动的运算符优先分析，括号与一元运算符不递归。
+    // Arith 只含算术运算（'=' 右侧），Bool 含关系与逻辑运算（':=' 右侧与 if/while 条件）
+    enum class ExprKind : uint8_t { Arith, Bool };
+    ExprNode *parseExpr(ExprKind kind);
+    // 弹出栈顶运算符，与操作数栈顶的一个（负号）或两个操作数归约成一个节点
+    void reduceExpr();
+    // 表达式节点：Tree 方式直接在 arena 中构造，否则经由 exprDag 共享（与折叠）
+    ExprNode *makeLeaf(NodeKind kind, Symbol symbol, uint32_t offset);
+    ExprNode *makeBinary(BinaryOp op, ExprNode *left, ExprNode *right, uint32_t offset);
+    // 复位驻留表与共享表，之后的符号与节点分配在 target 中
+    void resetTables(Arena &target);
 
-    // 语句解析
-    std::unique_ptr<StmtNode> parseStmt();
-    std::unique_ptr<StmtNode> parseBlock();
+    // 尚未完成的复合语句
+    struct StmtFrame {
+        enum Kind : uint8_t { Block, Then, Else, Body } kind;
+        bool atEnd;         // Block：当前子语句从文件结束处开始
+        bool closing;       // Block：子语句在文件结束处出错，块就此结束
+        size_t start;       // Block：当前子语句第一个 Token 的位置，出错时从这里恢复
+        size_t mark;        // Block：子语句在 stmtScratch 中的起点
+        StmtNode *node;     // 正在构造的 BlockStmtNode、IfStmtNode 或 WhileStmtNode
+    };
+    std::vector<StmtFrame> stmtFrames;
 
-    // 表达式解析
-    std::unique_ptr<ExprNode> parseExpr();
-    std::unique_ptr<ExprNode> parseTerm();
-    std::unique_ptr<ExprNode> parseFactor();
-    std::unique_ptr<ExprNode> parsePrimary();
+    // 表达式的运算符栈元素：二元运算符，或一元负号、逻辑非、左括号标记
+    struct ExprOp {
+        enum Kind : uint8_t { Binary, Negate, Not, Paren } kind;
+        BinaryOp op;
+        uint8_t prec;       // 优先级，左括号为 0
+        uint32_t offset;    // 运算符的位置（相对当前顶层项），归约出的节点以此为偏移
+    };
+    std::vector<ExprOp> exprOps;
+    std::vector<ExprNode *> exprValues;
 };
 
 #endif // PARSER_H
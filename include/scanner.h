@@ -0,0 +1,65 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 词法扫描底层加速：256 项字符类别表 + 按 CPU 能力分派的批量跳过函数。
+// 所有 skip/find 函数语义一致：从 pos 开始向后扫描，返回第一个不满足条件的位置
+// （找不到时返回 end），SIMD 版本与标量版本结果完全相同。
+namespace scanner {
+
+enum CharClass : uint8_t {
+    CC_SPACE    = 1 << 0,   // ' ' \t \n \v \f \r（与 C locale 的 isspace 一致）
+    CC_ID_START = 1 << 1,   // 字母或下划线
+    CC_DIGIT    = 1 << 2,   // 0-9
+    CC_ID_CONT  = 1 << 3,   // 字母、数字或下划线
+    CC_DELIM    = 1 << 4,   // ; , ( ) { }
+    CC_OPER     = 1 << 5,   // + - * / = ! < > & | :
+};
+
+constexpr uint8_t classify(unsigned c) {
+    uint8_t cls = 0;
+    if (c == ' ' || (c >= '\t' && c <= '\r'))
+        cls |= CC_SPACE;
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+        cls |= CC_ID_START | CC_ID_CONT;
+    if (c >= '0' && c <= '9')
+        cls |= CC_DIGIT | CC_ID_CONT;
+    // ':' 只作为 ":=" 的开头按操作符处理，":=" 是一个 BoolAssign Token，单独的 ':' 是 ERROR Token。
+    // 改用查表之前 ':' 在分隔符集合中，先于操作符匹配，":=" 被切成 ':' 与 '=' 两个 Token，
+    // 语法中的 id := EXPR 因而无法写出
+    if (c == ';' || c == ',' || c == '(' || c == ')' || c == '{' || c == '}')
+        cls |= CC_DELIM;
+    if (c == '+' || c == '-' || c == '*' || c == '/' || c == '=' || c == '!' ||
+        c == '<' || c == '>' || c == '&' || c == '|' || c == ':')
+        cls |= CC_OPER;
+    return cls;
+}
+
+// classify 的查表版本
+extern const uint8_t CHAR_CLASS[256];
+
+inline bool hasClass(char c, uint8_t cls) {
+    return (CHAR_CLASS[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+enum class Level { Scalar, SSE2, AVX2 };
+
+// 当前使用的指令集级别（启动时按 CPU 自动选择）
+Level activeLevel();
+// 强制切换实现（用于对拍与基准测试），请求的级别高于 CPU 支持时退回可用的最高级别
+void setLevel(Level level);
+const char *levelName(Level level);
+
+size_t skipSpace(const char *s, size_t pos, size_t end);
+size_t skipIdent(const char *s, size_t pos, size_t end);
+size_t skipDigits(const char *s, size_t pos, size_t end);
+// 返回下一个 '\n' 的位置
+size_t findNewline(const char *s, size_t pos, size_t end);
+// 返回下一个 "*/" 中 '*' 的位置
+size_t findBlockEnd(const char *s, size_t pos, size_t end);
+
+} // namespace scanner
+
+#endif // SCANNER_H
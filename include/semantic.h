@@ -0,0 +1,64 @@
+#ifndef SEMANTIC_H
+#define SEMANTIC_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ast.h"
+#include "parser.h"
+
+// 语义检查：对没有语法错误的 AST 做一遍线性遍历，完成名字解析与类型检查。报告：
+//   - 未声明的变量（函数体内参数遮蔽同名全局变量；未声明的 true / false 是 bool 常量），
+//     以及把函数名当作变量使用
+//   - 重复声明的全局变量、重复定义的函数、同一函数中重复的参数
+//   - '=' 的左侧应为 int、右侧为 int 表达式；':=' 的左侧应为 bool、右侧为 bool 表达式
+//   - 算术与大小比较的操作数为 int，'&&' '||' '!' 的操作数为 bool，'==' '!=' 两侧类型相同，
+//     if / while 的条件为 bool
+//   - 参数默认值与参数类型相符（bool 参数只能取 0 或 1），以及不支持的浮点常量
+// 名字按 Symbol 的稠密编号直接索引绑定表（驻留表已经把名字映射成无冲突的编号）；
+// 进入函数时参数的绑定压入撤销栈、离开时按栈恢复，语句与表达式都用显式栈遍历。
+// 各数组跨调用复用，稳态下检查一个程序只在报告错误时分配内存。
+class SemanticAnalyzer {
+public:
+    // 检查 program，返回是否没有发现错误；诊断按源码位置排序，见 diagnostics()
+    bool analyze(const ProgramNode &program);
+    const std::vector<Diagnostic> &diagnostics() const { return diags; }
+    // 与 out 交换诊断数组（同 Parser::swapDiagnostics）
+    void swapDiagnostics(std::vector<Diagnostic> &out) { diags.swap(out); }
+
+private:
+    // 表达式与变量的类型；Error 表示相关错误已经报告过，外层不再重复报告
+    enum class Type : uint8_t { Int, Bool, Error };
+    enum class Binding : uint8_t { None, Global, Param, Function, Undeclared };
+    struct Entry {
+        Binding binding = Binding::None;
+        Type type = Type::Error;
+    };
+    struct ExprTask {
+        const ExprNode *node;
+        bool visited;           // 子表达式是否已经压栈
+    };
+
+    std::vector<Diagnostic> diags;
+    std::vector<Entry> table;                       // Symbol id -> 当前绑定
+    std::vector<std::pair<uint32_t, Entry>> undo;   // 作用域栈：被参数遮蔽的绑定
+    std::vector<const ASTNode *> stmts;
+    std::vector<ExprTask> exprs;
+    std::vector<Type> types;
+    const ASTNode *item = nullptr;  // 当前顶层项；其余节点的偏移相对于它
+    size_t base = 0;
+
+    void report(const ASTNode *node, std::string message);
+    void declare(const ASTNode *node, Symbol name, Binding binding, Type type);
+    // variable 为 true 时名字必须是变量（赋值、read、write 的对象）
+    Type lookup(const ASTNode *node, Symbol name, bool variable);
+    Type leafType(const ExprNode *node);
+    Type binaryType(const BinaryExprNode *node, Type left, Type right);
+    Type typeOf(const ExprNode *expr);
+    void enterItem(const ASTNode *root);
+    void checkStmt(const ASTNode *stmt);
+    void checkFunction(const FuncDefNode *func);
+};
+
+#endif // SEMANTIC_H
@@ -0,0 +1,80 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "thread_pool.h"
+
+// 常驻分析服务（--serve）。省去每次检查都要付出的进程启动开销，并在请求之间复用
+// 已经热身的 Arena、驻留表、Parser 暂存区与输出缓冲。
+//
+// 协议：每个请求是一行头部，PARSE 请求之后紧跟 <字节数> 字节的源码：
+//   PARSE <text|json|binary> <字节数>\n<源码>   分析一段源码
+//   FILE <text|json|binary> <路径>\n            分析服务端可读的文件
+//   STATS\n                                    服务计数器与延迟分位数（JSON）
+//   SHUTDOWN\n                                 停止接受新连接，处理完正在进行的请求后关闭所有连接并退出
+// 每个响应是一行 "<状态> <字节数>\n" 后跟 <字节数> 字节的内容：
+//   OK    内容为所请求格式的 AST
+//   DIAG  存在语法错误，内容为所请求格式的错误输出（与 writeError 相同）
+//   ERR   请求本身有误（未知命令、格式、文件无法读取），内容为错误原因。PARSE 的字节数缺失、
+//         不是整数或超过 256MB 时无法定位下一个请求，回复 ERR 后关闭连接；处理请求时出现异常
+//        （如内存不足）同样只结束该连接
+// 一个连接上的请求按顺序处理，不同连接的请求并行处理。监听时用 poll 等待所有连接上的下一个请求，
+// 请求到达后才交给工作线程，空闲连接不占用工作线程；但请求一旦开始读取，读完并回复之前一直占用
+// 该线程，因此同时发送到一半的请求数超过工作线程数时，其余请求排队等待。
+class AnalyzerServer {
+public:
+    // workers 为同时处理的请求数；之后到达的请求排队等待空闲的工作线程
+    explicit AnalyzerServer(size_t workers);
+    ~AnalyzerServer();
+    AnalyzerServer(const AnalyzerServer &) = delete;
+    AnalyzerServer &operator=(const AnalyzerServer &) = delete;
+
+    // 在 Unix 域套接字 path 上监听，直到收到 SHUTDOWN 或 shutdown()。
+    // 已存在的同名套接字文件会被替换，path 已是其他类型的文件时失败；退出时删除套接字文件。
+    // 失败抛出 std::runtime_error
+    void listen(const std::string &path);
+    // 在一对文件描述符上按同样的协议服务一个连接，直到对端关闭或收到 SHUTDOWN
+    // （--serve=- 使用标准输入输出）
+    void serveConnection(int inFd, int outFd);
+    void shutdown();
+
+    // 与 STATS 请求的响应相同
+    std::string statsJson() const;
+
+private:
+    // 对数刻度的延迟直方图：每个 2 的幂区间分 4 档，计数用原子变量，记录不加锁
+    static constexpr size_t LATENCY_BUCKETS = 4 * 40;
+    std::atomic<uint64_t> latency[LATENCY_BUCKETS] = {};
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> succeeded{0};     // OK
+    std::atomic<uint64_t> syntaxErrors{0};  // DIAG
+    std::atomic<uint64_t> failed{0};        // ERR
+    std::atomic<uint64_t> bytesIn{0};       // 已分析的源码字节数
+    std::atomic<uint64_t> connections{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<int> listenFd{-1};
+    // 正在服务的套接字连接；shutdown 关闭它们的读端，使阻塞在读请求上的连接结束
+    std::mutex activeMutex;
+    std::vector<int> activeFds;
+    // 以下两项由 activeMutex 保护
+    struct Connection;
+    std::vector<Connection *> idle;     // 处理完一个请求、交回 listen 等待下一个请求的连接
+    int wakeFd = -1;                    // 唤醒 listen 中 poll 的管道写端
+
+    ThreadPool pool;
+    std::chrono::steady_clock::time_point started;
+
+    bool serveRequest(Connection &connection);
+    void dispatch(Connection *connection);
+    void closeConnection(Connection *connection);
+    void recordLatency(uint64_t nanoseconds);
+    uint64_t latencyPercentile(double p) const;
+};
+
+#endif // SERVER_H
@@ -0,0 +1,35 @@
+#ifndef SOURCE_FILE_H
+#define SOURCE_FILE_H
+
+#include <string>
+#include <string_view>
+
+// 只读源码缓冲区。普通文件直接 mmap 到内存（并提示内核按顺序预读），
+// 不产生额外的驻留副本；管道、标准输入等无法映射的输入退化为一次性读入。
+// view() 返回的视图在 SourceFile 销毁或重新 load 之前有效，可直接交给 Lexer 借用。
+class SourceFile {
+public:
+    SourceFile() = default;
+    ~SourceFile();
+    SourceFile(const SourceFile &) = delete;
+    SourceFile &operator=(const SourceFile &) = delete;
+
+    // 打开并载入 path，"-" 表示标准输入。失败时返回 false，错误原因见 error()
+    bool load(const std::string &path);
+    void close();
+
+    std::string_view view() const { return data; }
+    bool isMapped() const { return mapping != nullptr; }
+    const std::string &error() const { return lastError; }
+
+private:
+    void *mapping = nullptr;    // mmap 区域（未映射时为空）
+    size_t mappingSize = 0;
+    std::string buffer;         // 读入模式下的缓冲区
+    std::string_view data;
+    std::string lastError;
+
+    bool readAll(int fd);
+};
+
+#endif // SOURCE_FILE_H
@@ -0,0 +1,71 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ast.h"
+
+// 驱动程序的分阶段统计（--stats=FILE）。
+//
+// 每个文件一行 FileStats，由处理该文件的线程独占填写，不需要加锁；未启用统计时
+// processFile 拿到的是空指针，除一次判空外没有任何额外开销。
+// 词法时间来自单独的一遍 Token 计数（只在启用统计时执行）；语法分析由 Parser 按需拉取 Token，
+// 因此 parse 时间包含其中的词法分析，单个文件的合计耗时不再计入 lex 时间；--check 的语义检查
+// 单独计为 check 时间。
+
+constexpr size_t NODE_KIND_COUNT = static_cast<size_t>(NodeKind::Program) + 1;
+
+const char *nodeKindName(NodeKind kind);
+
+// AST 的形状：各类节点个数与最大深度（Program 为第 1 层）
+struct ASTShape {
+    std::array<uint64_t, NODE_KIND_COUNT> counts{};
+    uint32_t maxDepth = 0;
+    uint64_t nodes() const;
+};
+// 显式栈遍历，不受嵌套深度限制
+ASTShape measureAST(const ProgramNode &program);
+
+struct FileStats {
+    std::string name;
+    uint64_t bytes = 0;
+    double readSeconds = 0, lexSeconds = 0, parseSeconds = 0, checkSeconds = 0, writeSeconds = 0;
+    uint64_t tokens = 0;
+    ASTShape shape;
+    uint64_t arenaBytes = 0;    // 本文件 AST 占用的 Arena 字节数
+    uint64_t peakRss = 0;       // 处理完本文件时进程的峰值常驻内存（字节）
+    bool ok = false;
+    bool cached = false;        // 结果来自解析缓存，没有词法与语法分析的数据
+
+    // lexSeconds 来自额外的计数遍，与 parseSeconds 重复，不计入
+    double totalSeconds() const { return readSeconds + parseSeconds + checkSeconds + writeSeconds; }
+};
+
+// 计时辅助：lap() 返回距上次 lap()（或构造）的秒数
+class StopWatch {
+public:
+    StopWatch() : last(std::chrono::steady_clock::now()) {}
+    double lap() {
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        last = now;
+        return seconds;
+    }
+
+private:
+    std::chrono::steady_clock::time_point last;
+};
+
+// 进程的峰值常驻内存（字节）
+uint64_t peakRssBytes();
+
+// 写出 JSON 报告：每个文件一行、全部文件的合计，以及各阶段耗时的 p50/p90/p99/最大值。
+// 失败返回 false
+bool writeStatsReport(const std::string &path, const std::vector<FileStats> &files, size_t jobs,
+                      double wallSeconds);
+
+#endif // STATS_H
@@ -0,0 +1,52 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程有自己的任务队列，空闲时从其他线程的队列取任务。
+// 外部提交的任务按提交顺序轮流分配到各队列；任务队列按队首优先执行，
+// 窃取也从队首取，因此按从大到小提交的任务总是先执行剩余任务里最大的。
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(Task task);
+    // 阻塞直到所有已提交的任务执行完毕
+    void wait();
+
+    size_t size() const { return workers.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};   // 外部提交的轮转下标
+    std::atomic<size_t> pending{0};     // 已提交未完成的任务数
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable allDone;
+    bool stopping = false;
+
+    bool popFrom(size_t index, Task &task);
+    bool findTask(size_t self, Task &task);
+    void workerLoop(size_t self);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,72 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Chrome / Perfetto trace-event 记录（--trace=FILE）。
+//
+// 每个线程第一次记录时创建自己的事件缓冲区，并用 CAS 挂到全局链表上；之后只有该线程
+// 向自己的缓冲区追加事件，记录过程不加锁、线程之间不共享任何可写数据。缓冲区在进程
+// 结束前一直保留，writeTrace 在所有工作完成后遍历链表，把全部事件写成一个 JSON 文件，
+// 每个线程在查看器中占一行。
+//
+// 未启用时 TraceSpan 的构造与析构只读一次全局级别，不取时间、不分配内存。
+
+enum class TraceLevel : int {
+    Off = 0,
+    Phase = 1,      // 每个文件，以及每次 tokenize、parseProgram、写出 AST
+    Function = 2,   // 另外记录每个 parseFuncDef
+};
+
+namespace trace {
+extern std::atomic<int> currentLevel;
+
+inline bool enabled(TraceLevel level) {
+    return currentLevel.load(std::memory_order_relaxed) >= static_cast<int>(level);
+}
+// 开始记录，时间戳以此刻为零点；调用线程在查看器中显示为 main
+void start(TraceLevel level);
+// 写出全部线程已记录的事件；调用时不应再有线程在记录。失败返回 false
+bool write(const std::string &path);
+} // namespace trace
+
+// 作用域内的一段耗时，析构时记录为一个完整事件（"ph": "X"）。
+// name 必须是字符串字面量等静态存储的字符串；arg 会被复制，显示为事件参数 "name"。
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name, TraceLevel level = TraceLevel::Phase) {
+        if (trace::enabled(level))
+            begin(name);
+    }
+    TraceSpan(const char *name, std::string_view arg, TraceLevel level = TraceLevel::Phase) {
+        if (trace::enabled(level)) {
+            begin(name);
+            this->arg = arg;
+        }
+    }
+    ~TraceSpan() {
+        if (name)
+            end();
+    }
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    // 开始时还不知道的参数（如函数名），未记录时忽略
+    void setArg(std::string_view value) {
+        if (name)
+            arg = value;
+    }
+
+private:
+    const char *name = nullptr;
+    uint64_t startNs = 0;
+    std::string arg;
+
+    void begin(const char *spanName);
+    void end();
+};
+
+#endif // TRACE_H
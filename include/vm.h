@@ -0,0 +1,87 @@
+#ifndef VM_H
+#define VM_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ast_writer.h"
+#include "bytecode.h"
+
+enum class VMStatus : uint8_t {
+    Ok,
+    InputExhausted,     // read 时输入已经用完
+    BadInput,           // read 读到的不是整数
+    DivideByZero,
+    LoopLimit,          // while 的迭代次数超过 setLoopLimit 设定的上限
+};
+
+const char *vmStatusMessage(VMStatus status);
+
+// read 语句的输入：空白分隔的十进制整数（可带符号，超出 32 位时回绕）。
+// 可以直接读内存中的缓冲区，也可以从文件描述符按 64KB 成批读入，不逐个数字调用 read。
+class VMInput {
+public:
+    VMInput() = default;
+    explicit VMInput(std::string_view data) { reset(data); }
+    explicit VMInput(int fd) { reset(fd); }
+    VMInput(const VMInput &) = delete;
+    VMInput &operator=(const VMInput &) = delete;
+
+    void reset(std::string_view data);
+    void reset(int fd);
+    // 读下一个整数；返回 Ok、InputExhausted 或 BadInput
+    VMStatus next(int32_t &value);
+
+private:
+    std::string_view data;
+    size_t pos = 0;
+    int fd = -1;                // 从 fd 读入时 data 指向 buffer
+    std::string buffer;
+
+    bool refill();
+};
+
+// write 语句的输出格式：十进制整数加换行，写入调用方打开的 OutputBuffer
+inline void writeValue(OutputBuffer &out, int32_t value) {
+    char text[16];
+    char *p = text + sizeof(text);
+    *--p = '\n';
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+        *--p = '-';
+    out.append(p, static_cast<size_t>(text + sizeof(text) - p));
+}
+
+// 字节码解释器。寄存器文件按模块的 registerCount 一次分配，执行期间不再分配内存；
+// 指令分派在 GCC / Clang 上使用 computed goto（每条指令末尾直接跳到下一条的处理代码），
+// 其他编译器退化为 switch。
+class VM {
+public:
+    explicit VM(const BytecodeModule &module);
+
+    // 每次执行允许的 while 迭代总数，0 表示不限（默认）
+    void setLoopLimit(uint64_t limit) { loopLimit = limit; }
+    // 把全局变量复位为 0，执行顶层语句
+    VMStatus run(VMInput &input, OutputBuffer &output);
+    // 在当前全局变量上执行第 index 个函数的函数体；args 之后的参数取默认值
+    VMStatus call(size_t index, const std::vector<int32_t> &args, VMInput &input, OutputBuffer &output);
+
+    int32_t global(size_t index) const { return registers[index]; }
+    // 上一次 run / call 执行的 while 迭代次数
+    uint64_t iterations() const { return lastIterations; }
+
+private:
+    const BytecodeModule &module;
+    std::vector<int32_t> registers;
+    uint64_t loopLimit = 0;
+    uint64_t lastIterations = 0;
+
+    VMStatus execute(uint32_t entry, VMInput &input, OutputBuffer &output);
+};
+
+#endif // VM_H
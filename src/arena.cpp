@@ -0,0 +1,81 @@
+#include "../include/arena.h"
+#include <cstdlib>
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize) {}
+
+Arena::~Arena() {
+    for (auto &block : blocks)
+        std::free(block.data);
+}
+
+void *Arena::allocateSlow(size_t size, size_t align) {
+    // 依次尝试 reset 后保留下来的后续块，都放不下时再向系统申请
+    size_t need = size + align;
+    while (!blocks.empty() && current + 1 < blocks.size()) {
+        usedBefore += ptr - blocks[current].data;
+        current++;
+        ptr = blocks[current].data;
+        limit = ptr + blocks[current].size;
+        if (blocks[current].size >= need)
+            return allocate(size, align);
+    }
+    // 新块大小随块数倍增（上限 16 倍初始大小），超大对象单独成块
+    size_t grow = blockSize << (blocks.size() < 4 ? blocks.size() : 4);
+    size_t bytes = need > grow ? need : grow;
+    char *data = static_cast<char *>(std::malloc(bytes));
+    if (!data)
+        throw std::bad_alloc();
+    if (!blocks.empty())
+        usedBefore += ptr - blocks[current].data;
+    blocks.push_back({data, bytes});
+    current = blocks.size() - 1;
+    ptr = data;
+    limit = data + bytes;
+    return allocate(size, align);
+}
+
+void Arena::reset() {
+    current = 0;
+    usedBefore = 0;
+    if (blocks.empty()) {
+        ptr = limit = nullptr;
+        return;
+    }
+    ptr = blocks[0].data;
+    limit = ptr + blocks[0].size;
+}
+
+void Arena::adopt(Arena &other) {
+    if (other.blocks.empty())
+        return;
+    if (blocks.empty()) {
+        // 本 Arena 尚未申请内存，直接整体接管 other 的状态
+        std::swap(blocks, other.blocks);
+        std::swap(current, other.current);
+        std::swap(ptr, other.ptr);
+        std::swap(limit, other.limit);
+        std::swap(usedBefore, other.usedBefore);
+        other.reset();
+        return;
+    }
+    size_t used = other.bytesUsed();
+    size_t taken = other.current + 1;
+    blocks.insert(blocks.begin() + current, other.blocks.begin(), other.blocks.begin() + taken);
+    current += taken;
+    usedBefore += used;
+    other.blocks.erase(other.blocks.begin(), other.blocks.begin() + taken);
+    other.reset();
+}
+
+size_t Arena::bytesUsed() const {
+    if (blocks.empty())
+        return 0;
+    return usedBefore + (ptr - blocks[current].data);
+}
+
+size_t Arena::bytesReserved() const {
+    size_t total = 0;
+    for (const auto &block : blocks)
+        total += block.size;
+    return total;
+}
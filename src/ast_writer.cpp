@@ -0,0 +1,917 @@
+#include "../include/ast_writer.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+// 预先生成的缩进串，足够 128 级；更深时分段输出
+const std::string INDENT_SPACES(256, ' ');
+
+const char BINARY_MAGIC[4] = {'G', 'A', 'S', 'T'};
+const uint8_t BINARY_VERSION = 1;
+
+} // namespace
+
+//==========================
+// OutputBuffer
+//==========================
+
+OutputBuffer::OutputBuffer(size_t capacity) : buf(capacity) {}
+
+OutputBuffer::~OutputBuffer() {
+    close();
+}
+
+bool OutputBuffer::open(const std::string &path) {
+    close();
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    ownsFd = true;
+    failed = fd < 0;
+    return !failed;
+}
+
+void OutputBuffer::openString(std::string &str) {
+    close();
+    target = &str;
+    failed = false;
+}
+
+void OutputBuffer::attach(int descriptor) {
+    close();
+    fd = descriptor;
+    ownsFd = false;
+    failed = fd < 0;
+}
+
+bool OutputBuffer::close() {
+    flush();
+    if (fd >= 0 && ownsFd && ::close(fd) != 0)
+        failed = true;
+    fd = -1;
+    target = nullptr;
+    return !failed;
+}
+
+void OutputBuffer::flush() {
+    if (used)
+        writeOut(buf.data(), used);
+    used = 0;
+}
+
+void OutputBuffer::writeOut(const char *s, size_t n) {
+    if (target) {
+        target->append(s, n);
+        return;
+    }
+    while (n > 0 && fd >= 0) {
+        ssize_t written = ::write(fd, s, n);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            failed = true;
+            return;
+        }
+        s += written;
+        n -= written;
+    }
+}
+
+void OutputBuffer::indent(int level) {
+    size_t n = static_cast<size_t>(level) * 2;
+    while (n > INDENT_SPACES.size()) {
+        append(INDENT_SPACES);
+        n -= INDENT_SPACES.size();
+    }
+    append(INDENT_SPACES.data(), n);
+}
+
+bool parseOutputFormat(std::string_view name, OutputFormat &format) {
+    if (name == "text")
+        format = OutputFormat::Text;
+    else if (name == "json")
+        format = OutputFormat::Json;
+    else if (name == "binary")
+        format = OutputFormat::Binary;
+    else
+        return false;
+    return true;
+}
+
+const char *outputExtension(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::Json:   return ".json";
+    case OutputFormat::Binary: return ".bin";
+    default:                   return "";
+    }
+}
+
+//==========================
+// ASTWriter
+//==========================
+
+void ASTWriter::write(const ProgramNode &program, OutputFormat format) {
+    switch (format) {
+    case OutputFormat::Text:
+        textNode(&program, 0);
+        break;
+    case OutputFormat::Json:
+        jsonNode(&program);
+        out.put('\n');
+        break;
+    case OutputFormat::Binary:
+        stringIndex.assign(program.symbolCount + 1, 0);
+        stringCount = 0;
+        out.append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        out.put(static_cast<char>(BINARY_VERSION));
+        out.put(0);     // 0：AST，1：语法错误
+        binaryNode(&program);
+        break;
+    }
+}
+
+void ASTWriter::writeError(std::string_view message, OutputFormat format) {
+    switch (format) {
+    case OutputFormat::Text:
+        out.append("语法分析错误: ");
+        out.append(message);
+        out.put('\n');
+        break;
+    case OutputFormat::Json:
+        out.append("{\"kind\":\"Error\",\"message\":");
+        jsonString(message);
+        out.append("}\n");
+        break;
+    case OutputFormat::Binary:
+        out.append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        out.put(static_cast<char>(BINARY_VERSION));
+        out.put(1);
+        varint(message.size());
+        out.append(message);
+        break;
+    }
+}
+
+// ---- text：与各节点的 print 保持逐字节一致 ----
+// 三种格式都用显式栈按先序遍历：子节点与其后的固定文本逆序压入 pending，
+// 嵌套再深也不占用调用栈。ProgramNode 只出现在根上，其下各顶层项各自遍历。
+
+void ASTWriter::textNode(const ASTNode *root, int rootIndent) {
+    size_t base = pending.size();
+    pending.push_back({root, nullptr, rootIndent});
+    while (pending.size() > base) {
+        Pending task = pending.back();
+        pending.pop_back();
+        const ASTNode *node = task.node;
+        int indent = task.indent;
+        if (!node) {
+            out.indent(indent);
+            out.append(task.text);
+            continue;
+        }
+        switch (node->kind) {
+        case NodeKind::Literal:
+            out.indent(indent);
+            out.append("Literal: ");
+            out.append(static_cast<const LiteralExprNode *>(node)->value.str());
+            out.put('\n');
+            break;
+        case NodeKind::Identifier:
+            out.indent(indent);
+            out.append("Identifier: ");
+            out.append(static_cast<const IdentifierExprNode *>(node)->name.str());
+            out.put('\n');
+            break;
+        case NodeKind::BinaryExpr: {
+            const auto *expr = static_cast<const BinaryExprNode *>(node);
+            out.indent(indent);
+            out.append("BinaryExpr: ");
+            out.append(opName(expr->op));
+            out.put('\n');
+            if (expr->right) pending.push_back({expr->right, nullptr, indent + 1});
+            if (expr->left)  pending.push_back({expr->left, nullptr, indent + 1});
+            break;
+        }
+        case NodeKind::ExprStmt: {
+            const auto *stmt = static_cast<const ExprStmtNode *>(node);
+            out.indent(indent);
+            out.append("ExprStmt:\n");
+            if (stmt->expr)
+                pending.push_back({stmt->expr, nullptr, indent + 1});
+            break;
+        }
+        case NodeKind::IfStmt: {
+            const auto *stmt = static_cast<const IfStmtNode *>(node);
+            out.indent(indent);
+            out.append("IfStmt:\n");
+            out.indent(indent + 1);
+            out.append("Condition:\n");
+            if (stmt->elseStmt) {
+                pending.push_back({stmt->elseStmt, nullptr, indent + 2});
+                pending.push_back({nullptr, "Else:\n", indent + 1});
+            }
+            if (stmt->thenStmt)
+                pending.push_back({stmt->thenStmt, nullptr, indent + 2});
+            pending.push_back({nullptr, "Then:\n", indent + 1});
+            if (stmt->condition)
+                pending.push_back({stmt->condition, nullptr, indent + 2});
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            const auto *stmt = static_cast<const WhileStmtNode *>(node);
+            out.indent(indent);
+            out.append("WhileStmt:\n");
+            out.indent(indent + 1);
+            out.append("Condition:\n");
+            if (stmt->body)
+                pending.push_back({stmt->body, nullptr, indent + 2});
+            pending.push_back({nullptr, "Body:\n", indent + 1});
+            if (stmt->condition)
+                pending.push_back({stmt->condition, nullptr, indent + 2});
+            break;
+        }
+        case NodeKind::BlockStmt: {
+            const auto &stmts = static_cast<const BlockStmtNode *>(node)->stmts;
+            out.indent(indent);
+            out.append("BlockStmt:\n");
+            for (size_t i = stmts.size(); i-- > 0;)
+                pending.push_back({stmts[i], nullptr, indent + 1});
+            break;
+        }
+        case NodeKind::ReadStmt:
+            out.indent(indent);
+            out.append("ReadStmt: ");
+            out.append(static_cast<const ReadStmtNode *>(node)->varName.str());
+            out.put('\n');
+            break;
+        case NodeKind::WriteStmt:
+            out.indent(indent);
+            out.append("WriteStmt: ");
+            out.append(static_cast<const WriteStmtNode *>(node)->varName.str());
+            out.put('\n');
+            break;
+        case NodeKind::Decl: {
+            const auto *decl = static_cast<const DeclNode *>(node);
+            out.indent(indent);
+            out.append("Decl: ");
+            out.append(typeName(decl->type));
+            out.put(' ');
+            for (Symbol name : decl->names) {
+                out.append(name.str());
+                out.put(' ');
+            }
+            out.put('\n');
+            break;
+        }
+        case NodeKind::FuncDef: {
+            const auto *func = static_cast<const FuncDefNode *>(node);
+            out.indent(indent);
+            out.append("FuncDef: ");
+            out.append(typeName(func->returnType));
+            out.put(' ');
+            out.append(func->name.str());
+            out.put('\n');
+            out.indent(indent + 1);
+            out.append("Parameters:\n");
+            for (const Parameter &param : func->params) {
+                out.indent(indent + 2);
+                out.append(typeName(param.type));
+                out.put(' ');
+                out.append(param.name.str());
+                if (!param.defaultVal.empty()) {
+                    out.append(" = ");
+                    out.append(param.defaultVal.str());
+                }
+                out.put('\n');
+            }
+            out.indent(indent + 1);
+            out.append("Body:\n");
+            if (func->body)
+                pending.push_back({func->body, nullptr, indent + 2});
+            break;
+        }
+        case NodeKind::Program: {
+            const auto *program = static_cast<const ProgramNode *>(node);
+            out.indent(indent);
+            out.append("Program\n");
+            if (!program->functions.empty()) {
+                out.indent(indent + 1);
+                out.append("Functions:\n");
+                for (const FuncDefNode *func : program->functions)
+                    textNode(func, indent + 2);
+            }
+            if (!program->decls.empty()) {
+                out.indent(indent + 1);
+                out.append("Declarations:\n");
+                for (const ASTNode *decl : program->decls)
+                    textNode(decl, indent + 2);
+            }
+            if (!program->stmts.empty()) {
+                out.indent(indent + 1);
+                out.append("Statements:\n");
+                for (const ASTNode *stmt : program->stmts)
+                    textNode(stmt, indent + 2);
+            }
+            break;
+        }
+        }
+    }
+}
+
+// ---- json ----
+
+void writeJsonString(OutputBuffer &out, std::string_view s) {
+    static const char HEX[] = "0123456789abcdef";
+    out.put('"');
+    for (char c : s) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out.put('\\');
+            out.put(c);
+        } else if (u < 0x20) {
+            char esc[6] = {'\\', 'u', '0', '0', HEX[u >> 4], HEX[u & 15]};
+            out.append(esc, sizeof(esc));
+        } else {
+            out.put(c);
+        }
+    }
+    out.put('"');
+}
+
+void ASTWriter::jsonString(std::string_view s) { writeJsonString(out, s); }
+
+void ASTWriter::jsonNode(const ASTNode *root) {
+    size_t base = pending.size();
+    // 缺失的子节点输出为 null
+    auto child = [this](const ASTNode *node) { pending.push_back({node, node ? nullptr : "null", 0}); };
+    auto text = [this](const char *s) { pending.push_back({nullptr, s, 0}); };
+    child(root);
+    while (pending.size() > base) {
+        Pending task = pending.back();
+        pending.pop_back();
+        const ASTNode *node = task.node;
+        if (!node) {
+            out.append(task.text);
+            continue;
+        }
+        switch (node->kind) {
+        case NodeKind::Literal:
+            out.append("{\"kind\":\"Literal\",\"value\":");
+            jsonString(static_cast<const LiteralExprNode *>(node)->value.str());
+            out.put('}');
+            break;
+        case NodeKind::Identifier:
+            out.append("{\"kind\":\"Identifier\",\"name\":");
+            jsonString(static_cast<const IdentifierExprNode *>(node)->name.str());
+            out.put('}');
+            break;
+        case NodeKind::BinaryExpr: {
+            const auto *expr = static_cast<const BinaryExprNode *>(node);
+            out.append("{\"kind\":\"BinaryExpr\",\"op\":");
+            jsonString(opName(expr->op));
+            out.append(",\"left\":");
+            text("}");
+            child(expr->right);
+            text(",\"right\":");
+            child(expr->left);
+            break;
+        }
+        case NodeKind::ExprStmt:
+            out.append("{\"kind\":\"ExprStmt\",\"expr\":");
+            text("}");
+            child(static_cast<const ExprStmtNode *>(node)->expr);
+            break;
+        case NodeKind::IfStmt: {
+            const auto *stmt = static_cast<const IfStmtNode *>(node);
+            out.append("{\"kind\":\"IfStmt\",\"condition\":");
+            text("}");
+            if (stmt->elseStmt) {
+                child(stmt->elseStmt);
+                text(",\"else\":");
+            }
+            child(stmt->thenStmt);
+            text(",\"then\":");
+            child(stmt->condition);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            const auto *stmt = static_cast<const WhileStmtNode *>(node);
+            out.append("{\"kind\":\"WhileStmt\",\"condition\":");
+            text("}");
+            child(stmt->body);
+            text(",\"body\":");
+            child(stmt->condition);
+            break;
+        }
+        case NodeKind::BlockStmt: {
+            const auto &stmts = static_cast<const BlockStmtNode *>(node)->stmts;
+            out.append("{\"kind\":\"BlockStmt\",\"stmts\":[");
+            text("]}");
+            for (size_t i = stmts.size(); i-- > 0;) {
+                child(stmts[i]);
+                if (i)
+                    text(",");
+            }
+            break;
+        }
+        case NodeKind::ReadStmt:
+            out.append("{\"kind\":\"ReadStmt\",\"name\":");
+            jsonString(static_cast<const ReadStmtNode *>(node)->varName.str());
+            out.put('}');
+            break;
+        case NodeKind::WriteStmt:
+            out.append("{\"kind\":\"WriteStmt\",\"name\":");
+            jsonString(static_cast<const WriteStmtNode *>(node)->varName.str());
+            out.put('}');
+            break;
+        case NodeKind::Decl: {
+            const auto *decl = static_cast<const DeclNode *>(node);
+            out.append("{\"kind\":\"Decl\",\"type\":");
+            jsonString(typeName(decl->type));
+            out.append(",\"names\":[");
+            bool first = true;
+            for (Symbol name : decl->names) {
+                if (!first)
+                    out.put(',');
+                first = false;
+                jsonString(name.str());
+            }
+            out.append("]}");
+            break;
+        }
+        case NodeKind::FuncDef: {
+            const auto *func = static_cast<const FuncDefNode *>(node);
+            out.append("{\"kind\":\"FuncDef\",\"returnType\":");
+            jsonString(typeName(func->returnType));
+            out.append(",\"name\":");
+            jsonString(func->name.str());
+            out.append(",\"params\":[");
+            bool first = true;
+            for (const Parameter &param : func->params) {
+                if (!first)
+                    out.put(',');
+                first = false;
+                out.append("{\"type\":");
+                jsonString(typeName(param.type));
+                out.append(",\"name\":");
+                jsonString(param.name.str());
+                if (!param.defaultVal.empty()) {
+                    out.append(",\"default\":");
+                    jsonString(param.defaultVal.str());
+                }
+                out.put('}');
+            }
+            out.append("],\"body\":");
+            text("}");
+            child(func->body);
+            break;
+        }
+        case NodeKind::Program: {
+            const auto *program = static_cast<const ProgramNode *>(node);
+            out.append("{\"kind\":\"Program\",\"functions\":[");
+            for (size_t i = 0; i < program->functions.size(); i++) {
+                if (i)
+                    out.put(',');
+                jsonNode(program->functions[i]);
+            }
+            out.append("],\"decls\":[");
+            for (size_t i = 0; i < program->decls.size(); i++) {
+                if (i)
+                    out.put(',');
+                jsonNode(program->decls[i]);
+            }
+            out.append("],\"stmts\":[");
+            for (size_t i = 0; i < program->stmts.size(); i++) {
+                if (i)
+                    out.put(',');
+                jsonNode(program->stmts[i]);
+            }
+            out.append("]}");
+            break;
+        }
+        }
+    }
+}
+
+// ---- binary ----
+// 文件头：'GAST' 版本(1 字节) 状态(1 字节，0 为 AST，1 为错误信息)。
+// 之后按先序输出节点：1 字节 NodeKind，随后是该种类的字段，整数为 LEB128 变长编码。
+// 字符串以字符串表下标引用：0 为空串；下标等于“已出现字符串数 + 1”时表示新字符串，
+// 紧跟长度与内容，读者据此边读边建表。
+
+void ASTWriter::varint(uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+void ASTWriter::binaryString(Symbol symbol) {
+    if (symbol.empty()) {
+        varint(0);
+        return;
+    }
+    if (symbol.id() >= stringIndex.size())
+        stringIndex.resize(symbol.id() + 1, 0);
+    uint32_t &index = stringIndex[symbol.id()];
+    if (index) {
+        varint(index);
+        return;
+    }
+    index = ++stringCount;
+    varint(index);
+    varint(symbol.str().size());
+    out.append(symbol.str());
+}
+
+void ASTWriter::binaryNode(const ASTNode *root) {
+    size_t base = pending.size();
+    pending.push_back({root, nullptr, 0});
+    while (pending.size() > base) {
+        const ASTNode *node = pending.back().node;
+        pending.pop_back();
+        out.put(static_cast<char>(node->kind));
+        switch (node->kind) {
+        case NodeKind::Literal:
+            binaryString(static_cast<const LiteralExprNode *>(node)->value);
+            break;
+        case NodeKind::Identifier:
+            binaryString(static_cast<const IdentifierExprNode *>(node)->name);
+            break;
+        case NodeKind::BinaryExpr: {
+            const auto *expr = static_cast<const BinaryExprNode *>(node);
+            out.put(static_cast<char>(expr->op));
+            pending.push_back({expr->right, nullptr, 0});
+            if (expr->left)     // 逻辑非只写出右操作数
+                pending.push_back({expr->left, nullptr, 0});
+            break;
+        }
+        case NodeKind::ExprStmt:
+            pending.push_back({static_cast<const ExprStmtNode *>(node)->expr, nullptr, 0});
+            break;
+        case NodeKind::IfStmt: {
+            const auto *stmt = static_cast<const IfStmtNode *>(node);
+            out.put(stmt->elseStmt ? 1 : 0);
+            if (stmt->elseStmt)
+                pending.push_back({stmt->elseStmt, nullptr, 0});
+            pending.push_back({stmt->thenStmt, nullptr, 0});
+            pending.push_back({stmt->condition, nullptr, 0});
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            const auto *stmt = static_cast<const WhileStmtNode *>(node);
+            pending.push_back({stmt->body, nullptr, 0});
+            pending.push_back({stmt->condition, nullptr, 0});
+            break;
+        }
+        case NodeKind::BlockStmt: {
+            const auto &stmts = static_cast<const BlockStmtNode *>(node)->stmts;
+            varint(stmts.size());
+            for (size_t i = stmts.size(); i-- > 0;)
+                pending.push_back({stmts[i], nullptr, 0});
+            break;
+        }
+        case NodeKind::ReadStmt:
+            binaryString(static_cast<const ReadStmtNode *>(node)->varName);
+            break;
+        case NodeKind::WriteStmt:
+            binaryString(static_cast<const WriteStmtNode *>(node)->varName);
+            break;
+        case NodeKind::Decl: {
+            const auto *decl = static_cast<const DeclNode *>(node);
+            out.put(static_cast<char>(decl->type));
+            varint(decl->names.size());
+            for (Symbol name : decl->names)
+                binaryString(name);
+            break;
+        }
+        case NodeKind::FuncDef: {
+            const auto *func = static_cast<const FuncDefNode *>(node);
+            out.put(static_cast<char>(func->returnType));
+            binaryString(func->name);
+            varint(func->params.size());
+            for (const Parameter &param : func->params) {
+                out.put(static_cast<char>(param.type));
+                binaryString(param.name);
+                binaryString(param.defaultVal);
+            }
+            pending.push_back({func->body, nullptr, 0});
+            break;
+        }
+        case NodeKind::Program: {
+            const auto *program = static_cast<const ProgramNode *>(node);
+            varint(program->functions.size());
+            for (const FuncDefNode *func : program->functions)
+                binaryNode(func);
+            varint(program->decls.size());
+            for (const ASTNode *decl : program->decls)
+                binaryNode(decl);
+            varint(program->stmts.size());
+            for (const ASTNode *stmt : program->stmts)
+                binaryNode(stmt);
+            break;
+        }
+        }
+    }
+}
+
+//==========================
+// binary 读取
+//==========================
+
+namespace {
+
+class BinaryReader {
+public:
+    BinaryReader(std::string_view data, Arena &arena) : data(data), arena(arena) {
+        interner.reset(arena);
+    }
+
+    uint8_t byte() {
+        if (pos >= data.size())
+            throw std::runtime_error("AST 二进制数据被截断");
+        return static_cast<uint8_t>(data[pos++]);
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return value;
+        }
+        throw std::runtime_error("AST 二进制数据中的整数编码无效");
+    }
+
+    std::string_view bytes(size_t n) {
+        if (n > data.size() - pos)
+            throw std::runtime_error("AST 二进制数据被截断");
+        std::string_view s = data.substr(pos, n);
+        pos += n;
+        return s;
+    }
+
+    Symbol string() {
+        uint64_t index = varint();
+        if (index == 0)
+            return Symbol();
+        if (index <= strings.size())
+            return strings[index - 1];
+        if (index != strings.size() + 1)
+            throw std::runtime_error("AST 二进制数据中的字符串引用无效");
+        Symbol symbol = interner.intern(bytes(varint()));
+        strings.push_back(symbol);
+        return symbol;
+    }
+
+    template <typename T>
+    T *expect(ASTNode *node, NodeKind kind) {
+        if (!node || node->kind != kind)
+            throw std::runtime_error("AST 二进制数据中的节点种类无效");
+        return static_cast<T *>(node);
+    }
+
+    ExprNode *expr(ASTNode *node) {
+        if (!node || (node->kind != NodeKind::Literal && node->kind != NodeKind::Identifier &&
+                      node->kind != NodeKind::BinaryExpr))
+            throw std::runtime_error("AST 二进制数据中期望表达式节点");
+        return static_cast<ExprNode *>(node);
+    }
+
+    StmtNode *stmt(ASTNode *node) {
+        switch (node->kind) {
+        case NodeKind::ExprStmt: case NodeKind::IfStmt: case NodeKind::WhileStmt:
+        case NodeKind::BlockStmt: case NodeKind::ReadStmt: case NodeKind::WriteStmt:
+            return static_cast<StmtNode *>(node);
+        default:
+            throw std::runtime_error("AST 二进制数据中期望语句节点");
+        }
+    }
+
+    ValueType type() {
+        uint8_t t = byte();
+        if (t > static_cast<uint8_t>(ValueType::Bool))
+            throw std::runtime_error("AST 二进制数据中的类型无效");
+        return static_cast<ValueType>(t);
+    }
+
+    // 读取一棵完整的子树。不递归：尚缺子节点的节点记录在 frames 中，
+    // 已读完的子节点按顺序暂存在 values 中，凑齐后一并交给父节点
+    ASTNode *readTree();
+
+    Interner interner;
+    std::vector<Symbol> strings;
+
+private:
+    std::string_view data;
+    size_t pos = 0;
+    Arena &arena;
+
+    struct Frame {
+        ASTNode *node;
+        size_t mark;        // 子节点在 values 中的起点
+        uint64_t need;      // 当前这一组还需要的子节点数
+        uint8_t phase;      // Program：正在读第几个列表
+    };
+    std::vector<Frame> frames;
+    std::vector<ASTNode *> values;
+
+    uint64_t count() {
+        uint64_t n = varint();
+        if (n > data.size())
+            throw std::runtime_error("AST 二进制数据中的列表长度无效");
+        return n;
+    }
+
+    template <typename T, typename Fn>
+    ArenaList<T> list(Fn readOne) {
+        uint64_t n = count();
+        std::vector<T> items;
+        items.reserve(n);
+        for (uint64_t i = 0; i < n; i++)
+            items.push_back(readOne());
+        return arena.copyList(items.data(), items.size());
+    }
+
+    // values 中 frame 的子节点逐个转换后复制进 arena
+    template <typename T, typename Fn>
+    ArenaList<T> children(const Frame &frame, Fn convert) {
+        std::vector<T> items;
+        items.reserve(values.size() - frame.mark);
+        for (size_t i = frame.mark; i < values.size(); i++)
+            items.push_back(convert(values[i]));
+        return arena.copyList(items.data(), items.size());
+    }
+
+    // 读取一个节点自身的字段；还有子节点要读时压入一帧并返回 nullptr
+    ASTNode *readHeader();
+    // frame 的子节点已经凑齐：填入节点并返回；Program 还有下一个列表时返回 nullptr
+    ASTNode *complete(Frame &frame);
+    ASTNode *open(ASTNode *node, uint64_t need) {
+        frames.push_back({node, values.size(), need, 0});
+        return nullptr;
+    }
+};
+
+ASTNode *BinaryReader::readHeader() {
+    uint8_t tag = byte();
+    if (tag > static_cast<uint8_t>(NodeKind::Program))
+        throw std::runtime_error("AST 二进制数据中的节点种类无效");
+    switch (static_cast<NodeKind>(tag)) {
+    case NodeKind::Literal:
+        return arena.make<LiteralExprNode>(string());
+    case NodeKind::Identifier:
+        return arena.make<IdentifierExprNode>(string());
+    case NodeKind::BinaryExpr: {
+        uint8_t op = byte();
+        if (op > static_cast<uint8_t>(BinaryOp::Not))
+            throw std::runtime_error("AST 二进制数据中的运算符无效");
+        // 逻辑非只有右操作数
+        auto *node = arena.make<BinaryExprNode>(static_cast<BinaryOp>(op), nullptr, nullptr);
+        return open(node, node->op == BinaryOp::Not ? 1 : 2);
+    }
+    case NodeKind::ExprStmt:
+        return open(arena.make<ExprStmtNode>(nullptr), 1);
+    case NodeKind::IfStmt: {
+        auto *node = arena.make<IfStmtNode>();
+        return open(node, byte() != 0 ? 3 : 2);
+    }
+    case NodeKind::WhileStmt:
+        return open(arena.make<WhileStmtNode>(), 2);
+    case NodeKind::BlockStmt:
+        return open(arena.make<BlockStmtNode>(), count());
+    case NodeKind::ReadStmt:
+        return arena.make<ReadStmtNode>(string());
+    case NodeKind::WriteStmt:
+        return arena.make<WriteStmtNode>(string());
+    case NodeKind::Decl: {
+        auto *node = arena.make<DeclNode>();
+        node->type = type();
+        node->names = list<Symbol>([this] { return string(); });
+        return node;
+    }
+    case NodeKind::FuncDef: {
+        auto *node = arena.make<FuncDefNode>();
+        node->returnType = type();
+        node->name = string();
+        node->params = list<Parameter>([this] {
+            Parameter param;
+            param.type = type();
+            param.name = string();
+            param.defaultVal = string();
+            return param;
+        });
+        return open(node, 1);
+    }
+    case NodeKind::Program:
+        // 三个列表依次为函数、声明、语句，各自以长度开头
+        return open(arena.make<ProgramNode>(), count());
+    }
+    return nullptr;
+}
+
+ASTNode *BinaryReader::complete(Frame &frame) {
+    ASTNode *node = frame.node;
+    ASTNode **child = values.data() + frame.mark;
+    switch (node->kind) {
+    case NodeKind::BinaryExpr: {
+        auto *binary = static_cast<BinaryExprNode *>(node);
+        if (frame.need == 1) {
+            binary->right = expr(child[0]);
+        } else {
+            binary->left = expr(child[0]);
+            binary->right = expr(child[1]);
+        }
+        break;
+    }
+    case NodeKind::ExprStmt:
+        static_cast<ExprStmtNode *>(node)->expr = expr(child[0]);
+        break;
+    case NodeKind::IfStmt: {
+        auto *ifStmt = static_cast<IfStmtNode *>(node);
+        ifStmt->condition = expr(child[0]);
+        ifStmt->thenStmt = stmt(child[1]);
+        if (frame.need == 3)
+            ifStmt->elseStmt = stmt(child[2]);
+        break;
+    }
+    case NodeKind::WhileStmt: {
+        auto *whileStmt = static_cast<WhileStmtNode *>(node);
+        whileStmt->condition = expr(child[0]);
+        whileStmt->body = stmt(child[1]);
+        break;
+    }
+    case NodeKind::BlockStmt:
+        static_cast<BlockStmtNode *>(node)->stmts =
+            children<StmtNode *>(frame, [this](ASTNode *item) { return stmt(item); });
+        break;
+    case NodeKind::FuncDef:
+        static_cast<FuncDefNode *>(node)->body = expect<BlockStmtNode>(child[0], NodeKind::BlockStmt);
+        break;
+    case NodeKind::Program: {
+        auto *program = static_cast<ProgramNode *>(node);
+        if (frame.phase == 0) {
+            program->functions = children<FuncDefNode *>(
+                frame, [this](ASTNode *item) { return expect<FuncDefNode>(item, NodeKind::FuncDef); });
+        } else if (frame.phase == 1) {
+            program->decls = children<ASTNode *>(frame, [this](ASTNode *item) {
+                return static_cast<ASTNode *>(expect<DeclNode>(item, NodeKind::Decl));
+            });
+        } else {
+            program->stmts = children<ASTNode *>(frame, [this](ASTNode *item) {
+                return static_cast<ASTNode *>(stmt(item));
+            });
+        }
+        values.resize(frame.mark);
+        if (++frame.phase < 3) {
+            frame.need = count();
+            return nullptr;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    values.resize(frame.mark);
+    frames.pop_back();
+    return node;
+}
+
+ASTNode *BinaryReader::readTree() {
+    size_t base = frames.size();
+    while (true) {
+        ASTNode *node = readHeader();
+        // 读完的节点交给父节点；父节点因此凑齐子节点时继续向上
+        while (true) {
+            if (node) {
+                if (frames.size() == base)
+                    return node;
+                values.push_back(node);
+            }
+            Frame &frame = frames.back();
+            if (values.size() - frame.mark < frame.need)
+                break;
+            node = complete(frame);
+        }
+    }
+}
+
+} // namespace
+
+ProgramNode *readBinaryAST(std::string_view data, Arena &arena, std::string &error) {
+    if (data.size() < 6 || data.compare(0, 4, std::string_view(BINARY_MAGIC, 4)) != 0)
+        throw std::runtime_error("不是 AST 二进制数据");
+    if (static_cast<uint8_t>(data[4]) != BINARY_VERSION)
+        throw std::runtime_error("不支持的 AST 二进制数据版本");
+    BinaryReader reader(data.substr(6), arena);
+    if (data[5] != 0) {
+        error = std::string(reader.bytes(reader.varint()));
+        return nullptr;
+    }
+    auto *program = reader.expect<ProgramNode>(reader.readTree(), NodeKind::Program);
+    program->symbolCount = reader.interner.size();
+    return program;
+}
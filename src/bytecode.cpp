@@ -0,0 +1,534 @@
+#include "../include/bytecode.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// 参数与临时值的寄存器在编译期间带此标记，finish 时换算为常量区之后的实际编号
+constexpr uint32_t LOCAL = 1u << 23;
+constexpr uint32_t NONE = ~0u;
+
+const char *const OPCODE_NAMES[OPCODE_COUNT] = {
+    "Move", "Add", "Sub", "Mul", "Div", "Eq", "Ne", "Lt", "Le", "Gt", "Ge",
+    "Jump", "JumpIfZero", "JumpIfNonZero", "JumpEq", "JumpNe", "JumpLt", "JumpLe", "JumpGt", "JumpGe",
+    "LoopTick", "ReadInt", "ReadBool", "Write", "Halt",
+};
+
+// 各操作码的操作数用途：哪些字段是寄存器，跳转目标在哪个字段
+enum : uint8_t { REG_A = 1, REG_B = 2, REG_C = 4, TARGET_B = 8, TARGET_C = 16 };
+
+constexpr uint8_t operandKinds(Opcode op) {
+    switch (op) {
+    case Opcode::Move:
+        return REG_A | REG_B;
+    case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div:
+    case Opcode::Eq: case Opcode::Ne: case Opcode::Lt: case Opcode::Le: case Opcode::Gt: case Opcode::Ge:
+        return REG_A | REG_B | REG_C;
+    case Opcode::Jump:
+        return TARGET_B;
+    case Opcode::JumpIfZero: case Opcode::JumpIfNonZero:
+        return REG_A | TARGET_B;
+    case Opcode::JumpEq: case Opcode::JumpNe: case Opcode::JumpLt:
+    case Opcode::JumpLe: case Opcode::JumpGt: case Opcode::JumpGe:
+        return REG_A | REG_B | TARGET_C;
+    case Opcode::ReadInt: case Opcode::ReadBool: case Opcode::Write:
+        return REG_A;
+    default:
+        return 0;
+    }
+}
+
+bool isRelational(BinaryOp op) {
+    return op >= BinaryOp::Eq && op <= BinaryOp::Ge;
+}
+
+// 关系运算对应的计算指令与分支指令，以及取反后的关系
+Opcode compareOpcode(BinaryOp op) {
+    return static_cast<Opcode>(static_cast<int>(Opcode::Eq) + static_cast<int>(op) - static_cast<int>(BinaryOp::Eq));
+}
+
+Opcode branchOpcode(BinaryOp op) {
+    return static_cast<Opcode>(static_cast<int>(Opcode::JumpEq) + static_cast<int>(op) -
+                               static_cast<int>(BinaryOp::Eq));
+}
+
+BinaryOp invertRelation(BinaryOp op) {
+    switch (op) {
+    case BinaryOp::Eq: return BinaryOp::Ne;
+    case BinaryOp::Ne: return BinaryOp::Eq;
+    case BinaryOp::Lt: return BinaryOp::Ge;
+    case BinaryOp::Le: return BinaryOp::Gt;
+    case BinaryOp::Gt: return BinaryOp::Le;
+    default:           return BinaryOp::Lt;     // Ge
+    }
+}
+
+Opcode arithOpcode(BinaryOp op) {
+    return static_cast<Opcode>(static_cast<int>(Opcode::Add) + static_cast<int>(op));
+}
+
+} // namespace
+
+const char *opcodeName(Opcode op) {
+    return OPCODE_NAMES[static_cast<size_t>(op)];
+}
+
+bool literalValue(std::string_view text, int32_t &value) {
+    if (text == "true" || text == "false") {
+        value = text == "true";
+        return true;
+    }
+    if (text.empty())
+        return false;
+    uint32_t result = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9')
+            return false;
+        result = result * 10 + static_cast<uint32_t>(c - '0');
+    }
+    value = static_cast<int32_t>(result);
+    return true;
+}
+
+int BytecodeModule::findGlobal(std::string_view name) const {
+    for (size_t i = 0; i < globalNames.size(); i++)
+        if (globalNames[i] == name)
+            return static_cast<int>(i);
+    return -1;
+}
+
+int BytecodeModule::findFunction(std::string_view name) const {
+    for (size_t i = 0; i < functions.size(); i++)
+        if (functions[i].name == name)
+            return static_cast<int>(i);
+    return -1;
+}
+
+std::string BytecodeModule::disassemble() const {
+    std::string out;
+    char line[96];
+    auto label = [&](uint32_t pc) {
+        if (pc == mainEntry)
+            out += "<main>:\n";
+        for (const BytecodeFunction &func : functions)
+            if (func.entry == pc)
+                out += "<" + func.name + ">:\n";
+    };
+    for (uint32_t pc = 0; pc < code.size(); pc++) {
+        label(pc);
+        const Instruction &ins = code[pc];
+        uint8_t kinds = operandKinds(ins.opcode());
+        int n = snprintf(line, sizeof(line), "%6u  %-14s", pc, opcodeName(ins.opcode()));
+        if (kinds & REG_A)
+            n += snprintf(line + n, sizeof(line) - n, " r%u", static_cast<unsigned>(ins.a));
+        if (kinds & REG_B)
+            n += snprintf(line + n, sizeof(line) - n, " r%u", ins.b);
+        if (kinds & REG_C)
+            n += snprintf(line + n, sizeof(line) - n, " r%u", ins.c);
+        if (kinds & (TARGET_B | TARGET_C))
+            n += snprintf(line + n, sizeof(line) - n, " -> %u", kinds & TARGET_B ? ins.b : ins.c);
+        out.append(line, static_cast<size_t>(n));
+        out += '\n';
+    }
+    return out;
+}
+
+//==========================
+// BytecodeCompiler
+//==========================
+
+enum class BytecodeCompiler::TaskKind : uint8_t {
+    Stmt,           // 编译语句 node
+    Store,          // 弹出一个值，存入变量寄存器 x；y 非 0 时存入前规范为 0/1
+    Value,          // 求值表达式 node，结果寄存器压入 values；x 为建议的目标寄存器（NONE 表示任意）
+    Binary,         // 弹出两个值（逻辑非一个），计算 node 的运算，结果存入 x（NONE 时分配临时寄存器）
+    LogicLeft,      // && / || 的左操作数已求值：规范为 0/1 并短路跳转
+    LogicRight,     // && / || 的右操作数已求值：结果存入 x，放置标签 y
+    Branch,         // 条件 node 为 sense 时跳到标签 x，否则顺序执行
+    CompareBranch,  // 弹出两个值，按关系运算 node 分支
+    TestBranch,     // 弹出一个值，非 0 / 为 0 时分支
+    Label,          // 把标签 x 放在当前位置
+    Jump,           // 无条件跳到标签 x
+    Emit,           // 生成单条指令 x（操作码），操作数 y
+};
+
+bool BytecodeCompiler::fail(std::string message) {
+    if (lastError.empty())
+        lastError = std::move(message);
+    return false;
+}
+
+uint32_t BytecodeCompiler::constantRegister(int32_t value) {
+    auto found = constants.find(value);
+    if (found != constants.end())
+        return found->second;
+    uint32_t reg = module->globalCount + static_cast<uint32_t>(constants.size());
+    constants.emplace(value, reg);
+    module->initialRegisters.push_back(value);
+    return reg;
+}
+
+// 叶子表达式直接使用变量或常量所在的寄存器，不生成指令
+bool BytecodeCompiler::operand(const ExprNode *node, uint32_t &reg) {
+    Symbol name = node->kind == NodeKind::Identifier ? static_cast<const IdentifierExprNode *>(node)->name
+                                                     : static_cast<const LiteralExprNode *>(node)->value;
+    if (node->kind == NodeKind::Identifier && slotOf[name.id()] >= 0) {
+        reg = static_cast<uint32_t>(slotOf[name.id()]);
+        return true;
+    }
+    int32_t value;
+    if (!literalValue(name.str(), value)) {
+        if (node->kind == NodeKind::Identifier)
+            return fail("未声明的变量 " + std::string(name.str()));
+        return fail("不支持的常量 " + std::string(name.str()));
+    }
+    reg = constantRegister(value);
+    return true;
+}
+
+ValueType BytecodeCompiler::typeOf(uint32_t reg) const {
+    return reg & LOCAL ? localTypes[reg & ~LOCAL] : globalTypes[reg];
+}
+
+// 值一定是 0/1 的表达式：关系与逻辑运算、bool 变量以及 true / false
+bool BytecodeCompiler::isBoolean(const ExprNode *node) const {
+    if (node->kind == NodeKind::BinaryExpr) {
+        BinaryOp op = static_cast<const BinaryExprNode *>(node)->op;
+        return isRelational(op) || op == BinaryOp::And || op == BinaryOp::Or || op == BinaryOp::Not;
+    }
+    Symbol name = node->kind == NodeKind::Identifier ? static_cast<const IdentifierExprNode *>(node)->name
+                                                     : static_cast<const LiteralExprNode *>(node)->value;
+    if (node->kind == NodeKind::Identifier && slotOf[name.id()] >= 0)
+        return typeOf(static_cast<uint32_t>(slotOf[name.id()])) == ValueType::Bool;
+    return name.str() == "true" || name.str() == "false";
+}
+
+uint32_t BytecodeCompiler::allocTemp() {
+    uint32_t reg = LOCAL | tempTop++;
+    tempMax = std::max(tempMax, tempTop);
+    return reg;
+}
+
+// 临时寄存器按栈的顺序分配与释放；变量、常量与参数寄存器不释放
+void BytecodeCompiler::release(uint32_t reg) {
+    if (reg & LOCAL && (reg & ~LOCAL) == tempTop - 1 && (reg & ~LOCAL) >= localTypes.size())
+        tempTop--;
+}
+
+uint32_t BytecodeCompiler::newLabel() {
+    labels.push_back(NONE);
+    return static_cast<uint32_t>(labels.size() - 1);
+}
+
+void BytecodeCompiler::emit(Opcode op, uint32_t a, uint32_t b, uint32_t c) {
+    Instruction ins;
+    ins.op = static_cast<uint32_t>(op);
+    ins.a = a;
+    ins.b = b;
+    ins.c = c;
+    module->code.push_back(ins);
+}
+
+bool BytecodeCompiler::runTasks() {
+    while (!tasks.empty() && lastError.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+        switch (task.kind) {
+        case TaskKind::Stmt: {
+            const ASTNode *node = task.node;
+            if (!node)
+                break;
+            switch (node->kind) {
+            case NodeKind::ExprStmt: {
+                auto *expr = static_cast<const ExprStmtNode *>(node)->expr;
+                auto *assign = static_cast<const BinaryExprNode *>(expr);
+                if (!expr || expr->kind != NodeKind::BinaryExpr ||
+                    (assign->op != BinaryOp::Assign && assign->op != BinaryOp::BoolAssign) ||
+                    assign->left->kind != NodeKind::Identifier)
+                    return fail("只支持赋值形式的表达式语句");
+                Symbol name = static_cast<const IdentifierExprNode *>(assign->left)->name;
+                if (slotOf[name.id()] < 0)
+                    return fail("未声明的变量 " + std::string(name.str()));
+                uint32_t slot = static_cast<uint32_t>(slotOf[name.id()]);
+                uint32_t normalize = typeOf(slot) == ValueType::Bool && !isBoolean(assign->right);
+                tasks.push_back({TaskKind::Store, false, nullptr, slot, normalize});
+                tasks.push_back({TaskKind::Value, false, assign->right, normalize ? NONE : slot, 0});
+                break;
+            }
+            case NodeKind::IfStmt: {
+                auto *stmt = static_cast<const IfStmtNode *>(node);
+                uint32_t elseLabel = newLabel();
+                if (stmt->elseStmt) {
+                    uint32_t endLabel = newLabel();
+                    tasks.push_back({TaskKind::Label, false, nullptr, endLabel, 0});
+                    tasks.push_back({TaskKind::Stmt, false, stmt->elseStmt, 0, 0});
+                    tasks.push_back({TaskKind::Label, false, nullptr, elseLabel, 0});
+                    tasks.push_back({TaskKind::Jump, false, nullptr, endLabel, 0});
+                } else {
+                    tasks.push_back({TaskKind::Label, false, nullptr, elseLabel, 0});
+                }
+                tasks.push_back({TaskKind::Stmt, false, stmt->thenStmt, 0, 0});
+                tasks.push_back({TaskKind::Branch, false, stmt->condition, elseLabel, 0});
+                break;
+            }
+            case NodeKind::WhileStmt: {
+                // 条件放在循环体之后，每次迭代只执行一次条件分支
+                auto *stmt = static_cast<const WhileStmtNode *>(node);
+                uint32_t bodyLabel = newLabel(), conditionLabel = newLabel();
+                tasks.push_back({TaskKind::Branch, true, stmt->condition, bodyLabel, 0});
+                tasks.push_back({TaskKind::Label, false, nullptr, conditionLabel, 0});
+                tasks.push_back({TaskKind::Emit, false, nullptr, static_cast<uint32_t>(Opcode::LoopTick), 0});
+                tasks.push_back({TaskKind::Stmt, false, stmt->body, 0, 0});
+                tasks.push_back({TaskKind::Label, false, nullptr, bodyLabel, 0});
+                tasks.push_back({TaskKind::Jump, false, nullptr, conditionLabel, 0});
+                break;
+            }
+            case NodeKind::BlockStmt: {
+                const auto &stmts = static_cast<const BlockStmtNode *>(node)->stmts;
+                for (size_t i = stmts.size(); i-- > 0;)
+                    tasks.push_back({TaskKind::Stmt, false, stmts[i], 0, 0});
+                break;
+            }
+            case NodeKind::ReadStmt:
+            case NodeKind::WriteStmt: {
+                Symbol name = node->kind == NodeKind::ReadStmt ? static_cast<const ReadStmtNode *>(node)->varName
+                                                               : static_cast<const WriteStmtNode *>(node)->varName;
+                if (slotOf[name.id()] < 0)
+                    return fail("未声明的变量 " + std::string(name.str()));
+                uint32_t slot = static_cast<uint32_t>(slotOf[name.id()]);
+                if (node->kind == NodeKind::WriteStmt)
+                    emit(Opcode::Write, slot);
+                else
+                    emit(typeOf(slot) == ValueType::Bool ? Opcode::ReadBool : Opcode::ReadInt, slot);
+                break;
+            }
+            default:
+                return fail("不支持的语句");
+            }
+            break;
+        }
+        case TaskKind::Store: {
+            uint32_t reg = values.back();
+            values.pop_back();
+            if (task.y)
+                emit(Opcode::Ne, task.x, reg, constantRegister(0));
+            else if (reg != task.x)
+                emit(Opcode::Move, task.x, reg);
+            release(reg);
+            break;
+        }
+        case TaskKind::Value: {
+            auto *expr = static_cast<const ExprNode *>(task.node);
+            if (expr->kind != NodeKind::BinaryExpr) {
+                uint32_t reg;
+                if (!operand(expr, reg))
+                    return false;
+                values.push_back(reg);
+                break;
+            }
+            auto *binary = static_cast<const BinaryExprNode *>(expr);
+            if (binary->op == BinaryOp::And || binary->op == BinaryOp::Or) {
+                tasks.push_back({TaskKind::LogicLeft, false, binary, 0, 0});
+                tasks.push_back({TaskKind::Value, false, binary->left, NONE, 0});
+            } else if (binary->op == BinaryOp::Assign || binary->op == BinaryOp::BoolAssign) {
+                return fail("赋值不能出现在表达式中");
+            } else {
+                // 只有最外层的运算直接写入目标变量：此时两个操作数都已读出
+                tasks.push_back({TaskKind::Binary, false, binary, task.x, 0});
+                tasks.push_back({TaskKind::Value, false, binary->right, NONE, 0});
+                if (binary->left)
+                    tasks.push_back({TaskKind::Value, false, binary->left, NONE, 0});
+            }
+            break;
+        }
+        case TaskKind::Binary: {
+            auto *binary = static_cast<const BinaryExprNode *>(task.node);
+            uint32_t right = values.back();
+            values.pop_back();
+            if (binary->op == BinaryOp::Not) {
+                // bool 的值只有 0/1，!x 即 x == 0
+                release(right);
+                uint32_t target = task.x != NONE ? task.x : allocTemp();
+                emit(Opcode::Eq, target, right, constantRegister(0));
+                values.push_back(target);
+                break;
+            }
+            uint32_t left = values.back();
+            values.pop_back();
+            release(right);
+            release(left);
+            uint32_t target = task.x != NONE ? task.x : allocTemp();
+            emit(isRelational(binary->op) ? compareOpcode(binary->op) : arithOpcode(binary->op), target, left, right);
+            values.push_back(target);
+            break;
+        }
+        case TaskKind::LogicLeft: {
+            // 结果先放左操作数的 0/1 值：&& 为 0、|| 为 1 时已经是结果，跳过右操作数
+            auto *binary = static_cast<const BinaryExprNode *>(task.node);
+            uint32_t left = values.back();
+            values.pop_back();
+            release(left);
+            uint32_t target = allocTemp();
+            uint32_t end = newLabel();
+            emit(Opcode::Ne, target, left, constantRegister(0));
+            emit(binary->op == BinaryOp::And ? Opcode::JumpIfZero : Opcode::JumpIfNonZero, target, end);
+            tasks.push_back({TaskKind::LogicRight, false, binary, target, end});
+            tasks.push_back({TaskKind::Value, false, binary->right, NONE, 0});
+            break;
+        }
+        case TaskKind::LogicRight: {
+            uint32_t right = values.back();
+            values.pop_back();
+            release(right);
+            emit(Opcode::Ne, task.x, right, constantRegister(0));
+            labels[task.y] = static_cast<uint32_t>(module->code.size());
+            values.push_back(task.x);
+            break;
+        }
+        case TaskKind::Branch: {
+            auto *expr = static_cast<const ExprNode *>(task.node);
+            auto *binary = static_cast<const BinaryExprNode *>(expr);
+            if (expr->kind == NodeKind::BinaryExpr && binary->op == BinaryOp::Not) {
+                tasks.push_back({TaskKind::Branch, !task.sense, binary->right, task.x, 0});
+            } else if (expr->kind == NodeKind::BinaryExpr && isRelational(binary->op)) {
+                tasks.push_back({TaskKind::CompareBranch, task.sense, binary, task.x, 0});
+                tasks.push_back({TaskKind::Value, false, binary->right, NONE, 0});
+                tasks.push_back({TaskKind::Value, false, binary->left, NONE, 0});
+            } else if (expr->kind == NodeKind::BinaryExpr && (binary->op == BinaryOp::And || binary->op == BinaryOp::Or)) {
+                // a && b 为假时跳转：任一为假即跳；为真时跳转：a 为假则跳过 b。|| 对称
+                bool isAnd = binary->op == BinaryOp::And;
+                if (task.sense != isAnd) {
+                    tasks.push_back({TaskKind::Branch, task.sense, binary->right, task.x, 0});
+                    tasks.push_back({TaskKind::Branch, task.sense, binary->left, task.x, 0});
+                } else {
+                    uint32_t skip = newLabel();
+                    tasks.push_back({TaskKind::Label, false, nullptr, skip, 0});
+                    tasks.push_back({TaskKind::Branch, task.sense, binary->right, task.x, 0});
+                    tasks.push_back({TaskKind::Branch, !task.sense, binary->left, skip, 0});
+                }
+            } else {
+                tasks.push_back({TaskKind::TestBranch, task.sense, nullptr, task.x, 0});
+                tasks.push_back({TaskKind::Value, false, expr, NONE, 0});
+            }
+            break;
+        }
+        case TaskKind::CompareBranch: {
+            BinaryOp op = static_cast<const BinaryExprNode *>(task.node)->op;
+            uint32_t right = values.back();
+            values.pop_back();
+            uint32_t left = values.back();
+            values.pop_back();
+            release(right);
+            release(left);
+            emit(branchOpcode(task.sense ? op : invertRelation(op)), left, right, task.x);
+            break;
+        }
+        case TaskKind::TestBranch: {
+            uint32_t reg = values.back();
+            values.pop_back();
+            release(reg);
+            emit(task.sense ? Opcode::JumpIfNonZero : Opcode::JumpIfZero, reg, task.x);
+            break;
+        }
+        case TaskKind::Label:
+            labels[task.x] = static_cast<uint32_t>(module->code.size());
+            break;
+        case TaskKind::Jump:
+            emit(Opcode::Jump, 0, task.x);
+            break;
+        case TaskKind::Emit:
+            emit(static_cast<Opcode>(task.x), task.y);
+            break;
+        }
+    }
+    return lastError.empty();
+}
+
+bool BytecodeCompiler::compile(const ProgramNode &program, BytecodeModule &out) {
+    out = BytecodeModule();
+    module = &out;
+    lastError.clear();
+    slotOf.assign(program.symbolCount + 1, -1);
+    globalTypes.clear();
+    localTypes.clear();
+    constants.clear();
+    labels.clear();
+    tasks.clear();
+    values.clear();
+    tempMax = 0;
+
+    // 全局变量：重复声明的名字沿用第一次分配的寄存器
+    for (const ASTNode *node : program.decls) {
+        if (node->kind != NodeKind::Decl)
+            continue;
+        auto *decl = static_cast<const DeclNode *>(node);
+        for (Symbol name : decl->names) {
+            if (slotOf[name.id()] >= 0)
+                continue;
+            slotOf[name.id()] = static_cast<int32_t>(out.globalCount++);
+            globalTypes.push_back(decl->type);
+            out.globalNames.emplace_back(name.str());
+        }
+    }
+    out.initialRegisters.assign(out.globalCount, 0);
+
+    out.mainEntry = 0;
+    tempTop = 0;
+    for (size_t i = program.stmts.size(); i-- > 0;)
+        tasks.push_back({TaskKind::Stmt, false, program.stmts[i], 0, 0});
+    if (!runTasks())
+        return false;
+    emit(Opcode::Halt, 0);
+
+    for (const FuncDefNode *func : program.functions) {
+        BytecodeFunction compiled;
+        compiled.name = std::string(func->name.str());
+        compiled.returnType = func->returnType;
+        compiled.entry = static_cast<uint32_t>(out.code.size());
+        // 参数占代码块的前几个局部寄存器，编译期间遮蔽同名全局变量
+        std::vector<std::pair<uint32_t, int32_t>> shadowed;
+        localTypes.clear();
+        tempTop = 0;
+        for (const Parameter &param : func->params) {
+            int32_t value = 0;
+            if (!param.defaultVal.empty() && !literalValue(param.defaultVal.str(), value))
+                return fail("不支持的默认值 " + std::string(param.defaultVal.str()));
+            localTypes.push_back(param.type);
+            compiled.paramTypes.push_back(param.type);
+            compiled.defaults.push_back(param.type == ValueType::Bool ? value != 0 : value);
+            shadowed.push_back({param.name.id(), slotOf[param.name.id()]});
+            slotOf[param.name.id()] = static_cast<int32_t>(allocTemp());
+        }
+        tasks.push_back({TaskKind::Stmt, false, func->body, 0, 0});
+        if (!runTasks())
+            return false;
+        emit(Opcode::Halt, 0);
+        for (size_t i = shadowed.size(); i-- > 0;)
+            slotOf[shadowed[i].first] = shadowed[i].second;
+        out.functions.push_back(std::move(compiled));
+    }
+    finish();
+    return true;
+}
+
+// 常量个数此时已确定：局部寄存器换算为实际编号，标签换算为指令下标
+void BytecodeCompiler::finish() {
+    uint32_t localBase = static_cast<uint32_t>(module->initialRegisters.size());
+    module->registerCount = localBase + tempMax;
+    auto relocate = [&](uint32_t reg) { return reg & LOCAL ? localBase + (reg & ~LOCAL) : reg; };
+    for (Instruction &ins : module->code) {
+        uint8_t kinds = operandKinds(ins.opcode());
+        if (kinds & REG_A)
+            ins.a = relocate(ins.a);
+        if (kinds & REG_B)
+            ins.b = relocate(ins.b);
+        if (kinds & REG_C)
+            ins.c = relocate(ins.c);
+        if (kinds & TARGET_B)
+            ins.b = labels[ins.b];
+        if (kinds & TARGET_C)
+            ins.c = labels[ins.c];
+    }
+    for (BytecodeFunction &func : module->functions)
+        func.paramBase = localBase;
+}
@@ -0,0 +1,213 @@
+#include "../include/expr_dag.h"
+#include <algorithm>
+#include <string>
+
+namespace {
+
+constexpr uint64_t GOLDEN = 0x9E3779B97F4A7C15ull;
+
+size_t hashOf(NodeKind kind, BinaryOp op, Symbol symbol, const ExprNode *left, const ExprNode *right) {
+    uint64_t h = static_cast<uint64_t>(kind) << 8 | static_cast<uint64_t>(op);
+    h = h * GOLDEN ^ symbol.id();
+    h = h * GOLDEN ^ reinterpret_cast<uintptr_t>(left);
+    h = h * GOLDEN ^ reinterpret_cast<uintptr_t>(right);
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+Symbol symbolOf(const ExprNode *node) {
+    return node->kind == NodeKind::Identifier ? static_cast<const IdentifierExprNode *>(node)->name
+                                              : static_cast<const LiteralExprNode *>(node)->value;
+}
+
+size_t hashNode(const ExprNode *node) {
+    if (node->kind != NodeKind::BinaryExpr)
+        return hashOf(node->kind, BinaryOp::Add, symbolOf(node), nullptr, nullptr);
+    auto *binary = static_cast<const BinaryExprNode *>(node);
+    return hashOf(NodeKind::BinaryExpr, binary->op, Symbol(), binary->left, binary->right);
+}
+
+// 十进制整数字面量的值，超出 32 位的部分回绕（与字节码的常量相同）
+bool integerValue(const ExprNode *node, uint32_t &value) {
+    if (node->kind != NodeKind::Literal)
+        return false;
+    std::string_view text = static_cast<const LiteralExprNode *>(node)->value.str();
+    if (text.empty())
+        return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9')
+            return false;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return true;
+}
+
+// 整数常量：字面量，或由两个字面量相减得到（负号 0 - n）
+bool constantValue(const ExprNode *node, uint32_t &value) {
+    if (node->kind != NodeKind::BinaryExpr)
+        return integerValue(node, value);
+    auto *binary = static_cast<const BinaryExprNode *>(node);
+    uint32_t left, right;
+    if (binary->op != BinaryOp::Sub || !integerValue(binary->left, left) || !integerValue(binary->right, right))
+        return false;
+    value = left - right;
+    return true;
+}
+
+bool evaluate(BinaryOp op, uint32_t a, uint32_t b, int32_t &value) {
+    uint32_t result;
+    switch (op) {
+    case BinaryOp::Add: result = a + b; break;
+    case BinaryOp::Sub: result = a - b; break;
+    case BinaryOp::Mul: result = a * b; break;
+    case BinaryOp::Div:
+        if (b == 0)
+            return false;
+        // INT32_MIN / -1 溢出，按回绕处理
+        result = static_cast<int32_t>(b) == -1
+                     ? 0u - a
+                     : static_cast<uint32_t>(static_cast<int32_t>(a) / static_cast<int32_t>(b));
+        break;
+    default:
+        return false;
+    }
+    value = static_cast<int32_t>(result);
+    return true;
+}
+
+} // namespace
+
+bool parseExprMode(std::string_view name, ExprMode &mode) {
+    if (name == "tree")
+        mode = ExprMode::Tree;
+    else if (name == "shared")
+        mode = ExprMode::Shared;
+    else if (name == "folded")
+        mode = ExprMode::Folded;
+    else
+        return false;
+    return true;
+}
+
+void ExprDag::reset(Arena &target, Interner &symbols, ExprMode exprMode) {
+    arena = &target;
+    interner = &symbols;
+    mode = exprMode;
+    counts = ExprStats();
+    if (buckets.empty())
+        buckets.assign(1024, nullptr);
+    else
+        std::fill(buckets.begin(), buckets.end(), nullptr);
+    count = 0;
+}
+
+ExprNode *ExprDag::leaf(NodeKind kind, Symbol symbol, uint32_t offset) {
+    counts.treeNodes++;
+    counts.treeBytes += kind == NodeKind::Identifier ? sizeof(IdentifierExprNode) : sizeof(LiteralExprNode);
+    return shareLeaf(kind, symbol, offset);
+}
+
+ExprNode *ExprDag::binary(BinaryOp op, ExprNode *left, ExprNode *right, uint32_t offset) {
+    counts.treeNodes++;
+    counts.treeBytes += sizeof(BinaryExprNode);
+    uint32_t a, b;
+    int32_t value;
+    // 只折叠 + - * /；逻辑非等一元运算的 left 为空
+    bool arithmetic = op == BinaryOp::Add || op == BinaryOp::Sub || op == BinaryOp::Mul || op == BinaryOp::Div;
+    if (mode == ExprMode::Folded && arithmetic && constantValue(left, a) && constantValue(right, b) &&
+        evaluate(op, a, b, value)) {
+        ExprNode *result = constant(value, offset);
+        // 0 - n 本身就是负数常量的表示，不算折叠
+        auto *same = static_cast<const BinaryExprNode *>(result);
+        if (result->kind != NodeKind::BinaryExpr || same->op != op || same->left != left || same->right != right)
+            counts.folded++;
+        return result;
+    }
+    return shareBinary(op, left, right, offset);
+}
+
+ExprNode *ExprDag::constant(int32_t value, uint32_t offset) {
+    if (value >= 0)
+        return shareLeaf(NodeKind::Literal, interner->intern(std::to_string(value)), offset);
+    uint32_t magnitude = 0u - static_cast<uint32_t>(value);
+    ExprNode *zero = shareLeaf(NodeKind::Literal, interner->intern("0"), offset);
+    ExprNode *positive = shareLeaf(NodeKind::Literal, interner->intern(std::to_string(magnitude)), offset);
+    return shareBinary(BinaryOp::Sub, zero, positive, offset);
+}
+
+ExprNode *ExprDag::shareLeaf(NodeKind kind, Symbol symbol, uint32_t offset) {
+    ExprNode **found = slot(hashOf(kind, BinaryOp::Add, symbol, nullptr, nullptr), kind, BinaryOp::Add, symbol,
+                            nullptr, nullptr);
+    if (*found) {
+        counts.reused++;
+        return *found;
+    }
+    ExprNode *node;
+    if (kind == NodeKind::Identifier) {
+        node = arena->make<IdentifierExprNode>(symbol);
+        counts.bytes += sizeof(IdentifierExprNode);
+    } else {
+        node = arena->make<LiteralExprNode>(symbol);
+        counts.bytes += sizeof(LiteralExprNode);
+    }
+    node->offset = offset;
+    counts.nodes++;
+    *found = node;
+    if (++count * 2 > buckets.size())
+        grow();
+    return node;
+}
+
+ExprNode *ExprDag::shareBinary(BinaryOp op, ExprNode *left, ExprNode *right, uint32_t offset) {
+    ExprNode **found = slot(hashOf(NodeKind::BinaryExpr, op, Symbol(), left, right), NodeKind::BinaryExpr, op,
+                            Symbol(), left, right);
+    if (*found) {
+        counts.reused++;
+        return *found;
+    }
+    ExprNode *node = arena->make<BinaryExprNode>(op, left, right);
+    node->offset = offset;
+    counts.nodes++;
+    counts.bytes += sizeof(BinaryExprNode);
+    *found = node;
+    if (++count * 2 > buckets.size())
+        grow();
+    return node;
+}
+
+// 与给定结构相同的节点所在的槽，没有时为应插入的空槽
+ExprNode **ExprDag::slot(size_t hash, NodeKind kind, BinaryOp op, Symbol symbol, const ExprNode *left,
+                         const ExprNode *right) {
+    size_t mask = buckets.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        ExprNode *node = buckets[i];
+        if (!node)
+            return &buckets[i];
+        if (node->kind != kind)
+            continue;
+        if (kind != NodeKind::BinaryExpr) {
+            if (symbolOf(node) == symbol)
+                return &buckets[i];
+            continue;
+        }
+        auto *binary = static_cast<const BinaryExprNode *>(node);
+        if (binary->op == op && binary->left == left && binary->right == right)
+            return &buckets[i];
+    }
+}
+
+void ExprDag::grow() {
+    std::vector<ExprNode *> old(buckets.size() * 2, nullptr);
+    old.swap(buckets);
+    size_t mask = buckets.size() - 1;
+    for (ExprNode *node : old) {
+        if (!node)
+            continue;
+        size_t i = hashNode(node) & mask;
+        while (buckets[i])
+            i = (i + 1) & mask;
+        buckets[i] = node;
+    }
+}
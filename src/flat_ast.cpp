@@ -0,0 +1,437 @@
+#include "../include/flat_ast.h"
+#include <algorithm>
+
+namespace {
+
+uint32_t hashString(string_view s) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    for (unsigned char c : s)
+        h = (h ^ c) * 16777619u;
+    return h;
+}
+
+// 打印时每个未结束祖先的状态
+struct PrintFrame {
+    FlatAST::NodeId id;
+    FlatAST::NodeId end;
+    FlatKind kind;
+    int indent;
+    uint32_t childNo;   // 已打印的孩子数
+};
+
+ValueType typeFromName(string_view name) {
+    return name == "bool" ? ValueType::Bool : ValueType::Int;
+}
+
+} // namespace
+
+void FlatAST::clear() {
+    kinds.clear();
+    ends.clear();
+    s0.clear();
+    s1.clear();
+    aux.clear();
+    strData.clear();
+    strOffsets.assign(2, 0);    // 0 号字符串为空串
+    strBuckets.assign(64, 0);
+}
+
+FlatAST::NodeId FlatAST::open(FlatKind kind, StrId a, StrId b, uint32_t extra) {
+    NodeId id = static_cast<NodeId>(kinds.size());
+    kinds.push_back(kind);
+    ends.push_back(id + 1);
+    s0.push_back(a);
+    s1.push_back(b);
+    aux.push_back(extra);
+    return id;
+}
+
+void FlatAST::rehash(size_t buckets) {
+    strBuckets.assign(buckets, 0);
+    size_t mask = buckets - 1;
+    for (StrId id = 1; id + 1 < strOffsets.size(); id++) {
+        size_t slot = hashString(str(id)) & mask;
+        while (strBuckets[slot])
+            slot = (slot + 1) & mask;
+        strBuckets[slot] = id + 1;
+    }
+}
+
+FlatAST::StrId FlatAST::intern(string_view s) {
+    if (s.empty())
+        return 0;
+    size_t mask = strBuckets.size() - 1;
+    size_t slot = hashString(s) & mask;
+    while (uint32_t entry = strBuckets[slot]) {
+        if (str(entry - 1) == s)
+            return entry - 1;
+        slot = (slot + 1) & mask;
+    }
+    StrId id = static_cast<StrId>(strOffsets.size() - 1);
+    strData.append(s);
+    strOffsets.push_back(static_cast<uint32_t>(strData.size()));
+    strBuckets[slot] = id + 1;
+    if ((strOffsets.size() - 1) * 2 > strBuckets.size())
+        rehash(strBuckets.size() * 2);
+    return id;
+}
+
+//==========================
+// 节点树 -> 扁平数组
+//==========================
+
+FlatAST FlatAST::fromTree(const ProgramNode &program) {
+    FlatAST flat;
+    flat.assign(program);
+    return flat;
+}
+
+void FlatAST::assign(const ProgramNode &program) {
+    clear();
+    NodeId root = open(FlatKind::Program);
+
+    NodeId funcs = open(FlatKind::FuncList);
+    for (const FuncDefNode *func : program.functions) {
+        NodeId f = open(FlatKind::FuncDef, intern(typeName(func->returnType)), intern(func->name.str()),
+                        static_cast<uint32_t>(func->params.size()));
+        for (const Parameter &param : func->params)
+            open(FlatKind::Param, intern(typeName(param.type)), intern(param.name.str()),
+                 intern(param.defaultVal.str()));
+        appendNode(func->body);
+        close(f);
+    }
+    close(funcs);
+
+    NodeId decls = open(FlatKind::DeclList);
+    for (const ASTNode *node : program.decls) {
+        const auto *decl = static_cast<const DeclNode *>(node);
+        NodeId d = open(FlatKind::Decl, intern(typeName(decl->type)));
+        for (Symbol name : decl->names)
+            open(FlatKind::Name, intern(name.str()));
+        close(d);
+    }
+    close(decls);
+
+    NodeId stmts = open(FlatKind::StmtList);
+    for (const ASTNode *node : program.stmts)
+        appendNode(node);
+    close(stmts);
+
+    close(root);
+}
+
+// 按先序追加以 root 为根的语句或表达式子树。不递归：appendStack 中为待追加的子节点，
+// node 为空的项表示在此处回填节点 id 的子树结束位置
+void FlatAST::appendNode(const ASTNode *root) {
+    size_t base = appendStack.size();
+    appendStack.push_back({root, 0});
+    while (appendStack.size() > base) {
+        AppendTask task = appendStack.back();
+        appendStack.pop_back();
+        const ASTNode *node = task.node;
+        if (!node) {
+            close(task.id);
+            continue;
+        }
+        // 孩子逆序入栈，先出栈的是第一个孩子
+        switch (node->kind) {
+        case NodeKind::ExprStmt: {
+            appendStack.push_back({nullptr, open(FlatKind::ExprStmt)});
+            appendStack.push_back({static_cast<const ExprStmtNode *>(node)->expr, 0});
+            break;
+        }
+        case NodeKind::IfStmt: {
+            const auto *stmt = static_cast<const IfStmtNode *>(node);
+            appendStack.push_back({nullptr, open(FlatKind::IfStmt, 0, 0, stmt->elseStmt != nullptr)});
+            if (stmt->elseStmt)
+                appendStack.push_back({stmt->elseStmt, 0});
+            appendStack.push_back({stmt->thenStmt, 0});
+            appendStack.push_back({stmt->condition, 0});
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            const auto *stmt = static_cast<const WhileStmtNode *>(node);
+            appendStack.push_back({nullptr, open(FlatKind::WhileStmt)});
+            appendStack.push_back({stmt->body, 0});
+            appendStack.push_back({stmt->condition, 0});
+            break;
+        }
+        case NodeKind::BlockStmt: {
+            const auto &stmts = static_cast<const BlockStmtNode *>(node)->stmts;
+            appendStack.push_back({nullptr, open(FlatKind::BlockStmt)});
+            for (size_t k = stmts.size(); k-- > 0;)
+                appendStack.push_back({stmts[k], 0});
+            break;
+        }
+        case NodeKind::ReadStmt:
+            open(FlatKind::ReadStmt, intern(static_cast<const ReadStmtNode *>(node)->varName.str()));
+            break;
+        case NodeKind::WriteStmt:
+            open(FlatKind::WriteStmt, intern(static_cast<const WriteStmtNode *>(node)->varName.str()));
+            break;
+        case NodeKind::Literal:
+            open(FlatKind::Literal, intern(static_cast<const LiteralExprNode *>(node)->value.str()));
+            break;
+        case NodeKind::Identifier:
+            open(FlatKind::Identifier, intern(static_cast<const IdentifierExprNode *>(node)->name.str()));
+            break;
+        case NodeKind::BinaryExpr: {
+            const auto *expr = static_cast<const BinaryExprNode *>(node);
+            appendStack.push_back({nullptr, open(FlatKind::BinaryExpr, intern(opName(expr->op)))});
+            appendStack.push_back({expr->right, 0});
+            if (expr->left)     // 逻辑非只有右操作数一个孩子
+                appendStack.push_back({expr->left, 0});
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+//==========================
+// 扁平数组 -> 节点树
+//==========================
+
+ProgramNode *FlatAST::toTree(Arena &arena) const {
+    auto *program = arena.make<ProgramNode>();
+    if (kinds.empty())
+        return program;
+    Interner interner;
+    interner.reset(arena);
+    vector<FuncDefNode *> funcs;
+    vector<ASTNode *> decls, stmts, values;
+    vector<Parameter> params;
+    vector<Symbol> names;
+
+    for (NodeId list = firstChild(0); list < ends[0]; list = nextSibling(list)) {
+        for (NodeId id = firstChild(list); id < ends[list]; id = nextSibling(id)) {
+            switch (kinds[id]) {
+            case FlatKind::FuncDef: {
+                auto *func = arena.make<FuncDefNode>();
+                func->returnType = typeFromName(str(s0[id]));
+                func->name = interner.intern(str(s1[id]));
+                params.clear();
+                NodeId child = firstChild(id);
+                for (uint32_t i = 0; i < aux[id]; i++, child = nextSibling(child)) {
+                    Symbol defaultVal = aux[child] ? interner.intern(str(aux[child])) : Symbol();
+                    params.push_back({typeFromName(str(s0[child])), interner.intern(str(s1[child])), defaultVal});
+                }
+                func->params = arena.copyList(params.data(), params.size());
+                func->body = static_cast<BlockStmtNode *>(buildNode(child, arena, interner, values));
+                funcs.push_back(func);
+                break;
+            }
+            case FlatKind::Decl: {
+                auto *decl = arena.make<DeclNode>();
+                decl->type = typeFromName(str(s0[id]));
+                names.clear();
+                for (NodeId child = firstChild(id); child < ends[id]; child = nextSibling(child))
+                    names.push_back(interner.intern(str(s0[child])));
+                decl->names = arena.copyList(names.data(), names.size());
+                decls.push_back(decl);
+                break;
+            }
+            default:
+                stmts.push_back(buildNode(id, arena, interner, values));
+                break;
+            }
+        }
+    }
+    program->functions = arena.copyList(funcs.data(), funcs.size());
+    program->decls = arena.copyList(decls.data(), decls.size());
+    program->stmts = arena.copyList(stmts.data(), stmts.size());
+    program->symbolCount = interner.size();
+    return program;
+}
+
+// 重建以 root 为根的语句或表达式子树。不递归：逆序扫描子树的先序区间，
+// 每个节点的孩子都已建好，按第一个孩子在栈顶的顺序压在 values 中
+ASTNode *FlatAST::buildNode(NodeId root, Arena &arena, Interner &interner, vector<ASTNode *> &values) const {
+    size_t base = values.size();
+    auto pop = [&] {
+        ASTNode *node = values.back();
+        values.pop_back();
+        return node;
+    };
+    for (NodeId id = ends[root]; id-- > root;) {
+        ASTNode *node = nullptr;
+        switch (kinds[id]) {
+        case FlatKind::ExprStmt:
+            node = arena.make<ExprStmtNode>(static_cast<ExprNode *>(pop()));
+            break;
+        case FlatKind::IfStmt: {
+            auto *stmt = arena.make<IfStmtNode>();
+            stmt->condition = static_cast<ExprNode *>(pop());
+            stmt->thenStmt = static_cast<StmtNode *>(pop());
+            if (aux[id])
+                stmt->elseStmt = static_cast<StmtNode *>(pop());
+            node = stmt;
+            break;
+        }
+        case FlatKind::WhileStmt: {
+            auto *stmt = arena.make<WhileStmtNode>();
+            stmt->condition = static_cast<ExprNode *>(pop());
+            stmt->body = static_cast<StmtNode *>(pop());
+            node = stmt;
+            break;
+        }
+        case FlatKind::BlockStmt: {
+            size_t n = 0;
+            for (NodeId child = firstChild(id); child < ends[id]; child = nextSibling(child))
+                n++;
+            // 栈顶是第一个孩子：翻转后即为源码顺序
+            std::reverse(values.end() - n, values.end());
+            auto *block = arena.make<BlockStmtNode>();
+            block->stmts = arena.copyList(reinterpret_cast<StmtNode *const *>(&*(values.end() - n)), n);
+            values.resize(values.size() - n);
+            node = block;
+            break;
+        }
+        case FlatKind::ReadStmt:
+            node = arena.make<ReadStmtNode>(interner.intern(str(s0[id])));
+            break;
+        case FlatKind::WriteStmt:
+            node = arena.make<WriteStmtNode>(interner.intern(str(s0[id])));
+            break;
+        case FlatKind::Literal:
+            node = arena.make<LiteralExprNode>(interner.intern(str(s0[id])));
+            break;
+        case FlatKind::Identifier:
+            node = arena.make<IdentifierExprNode>(interner.intern(str(s0[id])));
+            break;
+        case FlatKind::BinaryExpr: {
+            BinaryOp op = BinaryOp::Add;
+            binaryOpFromName(str(s0[id]), op);
+            ExprNode *left = op == BinaryOp::Not ? nullptr : static_cast<ExprNode *>(pop());
+            node = arena.make<BinaryExprNode>(op, left, static_cast<ExprNode *>(pop()));
+            break;
+        }
+        default:
+            break;
+        }
+        values.push_back(node);
+    }
+    ASTNode *result = values.back();
+    values.resize(base);
+    return result;
+}
+
+//==========================
+// 线性打印：按先序依次处理每个节点，用一个祖先栈推算缩进与小标题
+//==========================
+
+void FlatAST::print(ostream &out) const {
+    vector<PrintFrame> stack;
+    for (NodeId id = 0; id < kinds.size(); id++) {
+        while (!stack.empty() && stack.back().end <= id)
+            stack.pop_back();
+
+        int indent = 0;
+        if (!stack.empty()) {
+            PrintFrame &parent = stack.back();
+            uint32_t childNo = parent.childNo++;
+            indent = parent.indent + 1;
+            switch (parent.kind) {
+            case FlatKind::Program:
+                break;
+            case FlatKind::FuncDef:
+                // 参数与函数体都比 FuncDef 深两级，函数体前补 "Body:" 标题
+                indent = parent.indent + 2;
+                if (childNo == aux[parent.id]) {
+                    printIndent(out, parent.indent + 1);
+                    out << "Body:\n";
+                }
+                break;
+            case FlatKind::IfStmt:
+            case FlatKind::WhileStmt: {
+                static const char *const IF_LABELS[] = {"Condition:\n", "Then:\n", "Else:\n"};
+                static const char *const WHILE_LABELS[] = {"Condition:\n", "Body:\n"};
+                printIndent(out, parent.indent + 1);
+                out << (parent.kind == FlatKind::IfStmt ? IF_LABELS[childNo] : WHILE_LABELS[childNo]);
+                indent = parent.indent + 2;
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        switch (kinds[id]) {
+        case FlatKind::Program:
+            printIndent(out, indent);
+            out << "Program\n";
+            break;
+        case FlatKind::FuncList:
+        case FlatKind::DeclList:
+        case FlatKind::StmtList:
+            if (hasChildren(id)) {
+                static const char *const TITLES[] = {"Functions:\n", "Declarations:\n", "Statements:\n"};
+                printIndent(out, indent);
+                out << TITLES[static_cast<int>(kinds[id]) - static_cast<int>(FlatKind::FuncList)];
+            }
+            break;
+        case FlatKind::FuncDef:
+            printIndent(out, indent);
+            out << "FuncDef: " << str(s0[id]) << " " << str(s1[id]) << "\n";
+            printIndent(out, indent + 1);
+            out << "Parameters:\n";
+            break;
+        case FlatKind::Param:
+            printIndent(out, indent);
+            out << str(s0[id]) << " " << str(s1[id]);
+            if (aux[id])
+                out << " = " << str(aux[id]);
+            out << "\n";
+            break;
+        case FlatKind::Decl:
+            printIndent(out, indent);
+            out << "Decl: " << str(s0[id]) << " ";
+            for (NodeId child = firstChild(id); child < ends[id]; child = nextSibling(child))
+                out << str(s0[child]) << " ";
+            out << "\n";
+            id = ends[id] - 1;  // Name 孩子已经内联输出
+            continue;
+        case FlatKind::ExprStmt:
+            printIndent(out, indent);
+            out << "ExprStmt:\n";
+            break;
+        case FlatKind::IfStmt:
+            printIndent(out, indent);
+            out << "IfStmt:\n";
+            break;
+        case FlatKind::WhileStmt:
+            printIndent(out, indent);
+            out << "WhileStmt:\n";
+            break;
+        case FlatKind::BlockStmt:
+            printIndent(out, indent);
+            out << "BlockStmt:\n";
+            break;
+        case FlatKind::ReadStmt:
+            printIndent(out, indent);
+            out << "ReadStmt: " << str(s0[id]) << "\n";
+            break;
+        case FlatKind::WriteStmt:
+            printIndent(out, indent);
+            out << "WriteStmt: " << str(s0[id]) << "\n";
+            break;
+        case FlatKind::Literal:
+            printIndent(out, indent);
+            out << "Literal: " << str(s0[id]) << "\n";
+            break;
+        case FlatKind::Identifier:
+            printIndent(out, indent);
+            out << "Identifier: " << str(s0[id]) << "\n";
+            break;
+        case FlatKind::BinaryExpr:
+            printIndent(out, indent);
+            out << "BinaryExpr: " << str(s0[id]) << "\n";
+            break;
+        case FlatKind::Name:
+            break;
+        }
+        if (hasChildren(id))
+            stack.push_back({id, ends[id], kinds[id], indent, 0});
+    }
+}
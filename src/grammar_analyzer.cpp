@@ -0,0 +1,116 @@
+#include "../include/grammar_analyzer.h"
+#include "../include/grammar_analyzer_c.h"
+#include "../include/parse_cache.h"
+#include <new>
+
+bool GrammarAnalyzer::parse(std::string_view source, ParseResult &result) {
+    result.program = nullptr;
+    result.arena.reset();
+    lexer.setSource(source);
+    result.program = parser.parseProgram(result.arena);
+    parser.swapDiagnostics(result.diagnostics);
+    // AST 不引用源码，不再持有调用方的缓冲区
+    lexer.reset();
+    return result.ok();
+}
+
+void GrammarAnalyzer::write(std::string_view source, const ParseResult &result, OutputFormat format,
+                            std::string &out) {
+    out.clear();
+    buffer.openString(out);
+    if (!result.diagnostics.empty())
+        writer.writeError(formatDiagnostics(source, result.diagnostics), format);
+    else if (result.program)
+        writer.write(*result.program, format);
+    buffer.close();
+}
+
+void GrammarAnalyzer::reset() {
+    lexer.reset();
+    parser.reset();
+}
+
+// C 接口：每个 ga_analyzer 是一个 GrammarAnalyzer 加上它自己的结果与输出
+struct ga_analyzer {
+    GrammarAnalyzer analyzer;
+    ParseResult result;
+    std::string output;
+};
+
+const char *ga_version(void) {
+    return ANALYZER_VERSION;
+}
+
+int ga_api_version(void) {
+    return GA_API_VERSION;
+}
+
+ga_analyzer *ga_create(void) {
+    return new (std::nothrow) ga_analyzer;
+}
+
+void ga_destroy(ga_analyzer *analyzer) {
+    delete analyzer;
+}
+
+void ga_reset(ga_analyzer *analyzer) {
+    if (!analyzer)
+        return;
+    analyzer->analyzer.reset();
+    analyzer->result.arena.reset();
+    analyzer->result.program = nullptr;
+    analyzer->result.diagnostics.clear();
+    analyzer->output.clear();
+}
+
+int ga_parse(ga_analyzer *analyzer, const char *source, size_t length, int format) {
+    if (!analyzer)
+        return GA_FAILED;
+    ga_reset(analyzer);
+    // 异常不能穿过 C 接口，错误信息的赋值同样可能因内存不足而抛出
+    try {
+        OutputFormat outputFormat;
+        switch (format) {
+        case GA_FORMAT_TEXT: outputFormat = OutputFormat::Text; break;
+        case GA_FORMAT_JSON: outputFormat = OutputFormat::Json; break;
+        case GA_FORMAT_BINARY: outputFormat = OutputFormat::Binary; break;
+        default:
+            analyzer->output = "未知的输出格式";
+            return GA_FAILED;
+        }
+        if (!source && length) {
+            analyzer->output = "源码指针为空";
+            return GA_FAILED;
+        }
+        std::string_view view(source ? source : "", length);
+        bool ok = analyzer->analyzer.parse(view, analyzer->result);
+        analyzer->analyzer.write(view, analyzer->result, outputFormat, analyzer->output);
+        return ok ? GA_OK : GA_SYNTAX_ERROR;
+    } catch (const std::exception &e) {
+        ga_reset(analyzer);
+        try {
+            analyzer->output = e.what();
+        } catch (...) {
+        }
+        return GA_FAILED;
+    }
+}
+
+const char *ga_output(const ga_analyzer *analyzer, size_t *length) {
+    if (length)
+        *length = analyzer ? analyzer->output.size() : 0;
+    return analyzer ? analyzer->output.c_str() : nullptr;
+}
+
+size_t ga_diagnostic_count(const ga_analyzer *analyzer) {
+    return analyzer ? analyzer->result.diagnostics.size() : 0;
+}
+
+const char *ga_diagnostic(const ga_analyzer *analyzer, size_t index, size_t *offset) {
+    if (!analyzer || index >= analyzer->result.diagnostics.size())
+        return nullptr;
+    const Diagnostic &diag = analyzer->result.diagnostics[index];
+    if (offset)
+        *offset = diag.offset;
+    return diag.message.c_str();
+}
@@ -0,0 +1,236 @@
+#include "../include/incremental.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// 把 v 的 [lo, hi) 一段调整为 count 个元素（新增的元素待调用方填写）
+template <typename T>
+void resizeRange(std::vector<T> &v, size_t lo, size_t hi, size_t count) {
+    if (count > hi - lo)
+        v.insert(v.begin() + hi, count - (hi - lo), T());
+    else
+        v.erase(v.begin() + lo + count, v.begin() + hi);
+}
+
+} // namespace
+
+IncrementalParser::Slot IncrementalParser::slotOf(const ASTNode *node) {
+    if (node->kind == NodeKind::FuncDef)
+        return FuncSlot;
+    return node->kind == NodeKind::Decl ? DeclSlot : StmtSlot;
+}
+
+size_t IncrementalParser::slotSize(Slot slot) const {
+    switch (slot) {
+    case FuncSlot: return functions.size();
+    case DeclSlot: return decls.size();
+    default:       return stmts.size();
+    }
+}
+
+void IncrementalParser::place(ASTNode *node, uint32_t index) {
+    switch (slotOf(node)) {
+    case FuncSlot: functions[index] = static_cast<FuncDefNode *>(node); break;
+    case DeclSlot: decls[index] = node; break;
+    default:       stmts[index] = node; break;
+    }
+}
+
+void IncrementalParser::reset(std::string text) {
+    source = std::move(text);
+    fullParse();
+}
+
+void IncrementalParser::fullParse() {
+    items.clear();
+    fresh.clear();
+    itemDiags.clear();
+    freshDiags.clear();
+    functions.clear();
+    decls.clear();
+    stmts.clear();
+    nodes.reset();
+    stats = {};
+    stats.fullReparse = true;
+
+    lexer.setSource(std::string_view(source));
+    parser.beginItems(nodes, true);
+    firstToken = lexer.offsetOf(lexer.peek(0));
+    wrapped = lexer.peek(0).kind == TokenKind::LBrace;
+    if (wrapped)
+        lexer.next();
+    parseItems(0, 0, 0, 0);
+    items.swap(fresh);
+    itemDiags.swap(freshDiags);
+    for (Item &item : items) {
+        for (int s = 0; s < SlotCount; s++)
+            item.before[s] = slotSize(Slot(s));
+        if (!item.node)
+            continue;
+        if (item.node->kind == NodeKind::FuncDef)
+            functions.push_back(static_cast<FuncDefNode *>(item.node));
+        else if (item.node->kind == NodeKind::Decl)
+            decls.push_back(item.node);
+        else
+            stmts.push_back(item.node);
+    }
+    liveBytes = nodes.bytesUsed();
+    stats.reparsedItems = items.size();
+    updateRoot();
+}
+
+// 从 lexer 当前位置（lexer 的视图从源码偏移 base 处开始）逐个解析顶层项追加到 fresh，
+// 各项的诊断追加到 freshDiags，项的 diagsBefore 为 freshDiags 中的下标。
+// 当前 Token 位于 syncFrom 及之后、且恰好是旧项 items[k..] 之一平移 shift 后的起点时停止，
+// 返回该旧项下标；到达程序结尾时返回 items.size()。shift 按无符号回绕表示负的平移量。
+size_t IncrementalParser::parseItems(size_t base, size_t syncFrom, size_t k, size_t shift) {
+    while (true) {
+        const Token &token = lexer.peek(0);
+        size_t pos = base + lexer.offsetOf(token);
+        while (k < items.size() && items[k].start + shift < pos)
+            k++;
+        if (pos >= syncFrom && k < items.size() && items[k].start + shift == pos)
+            return k;
+        // 与 Parser::parseProgramBody 一致：wrapped 时遇到 '}' 结束，'}' 之后的内容被忽略；
+        // 否则到文件结束为止。wrapped 时缺少 '}' 由 parseItem 在 END 上报错后结束。
+        bool atEnd = token.kind == TokenKind::End;
+        if (wrapped ? token.kind == TokenKind::RBrace : atEnd) {
+            bodyEnd = pos;
+            return items.size();
+        }
+        fresh.push_back({nullptr, pos, {}, static_cast<uint32_t>(freshDiags.size())});
+        ASTNode *node = parser.parseItem();
+        if (node)
+            node->offset = static_cast<uint32_t>(pos);
+        else
+            parser.recoverItem(pos - base);
+        fresh.back().node = node;
+        takeDiagnostics(base);
+        if (atEnd) {
+            bodyEnd = pos;
+            return items.size();
+        }
+    }
+}
+
+// 把解析器记录的诊断移到 freshDiags（偏移加上 base），下一项从空的诊断开始
+void IncrementalParser::takeDiagnostics(size_t base) {
+    if (!parser.hasErrors())
+        return;
+    parser.swapDiagnostics(taken);
+    for (Diagnostic &d : taken) {
+        d.offset += base;
+        freshDiags.push_back(std::move(d));
+    }
+    taken.clear();
+}
+
+void IncrementalParser::applyEdit(size_t offset, size_t removed, std::string_view inserted) {
+    if (offset > source.size() || removed > source.size() - offset)
+        throw std::runtime_error("编辑范围超出源码长度");
+    source.replace(offset, removed, inserted.data(), inserted.size());
+
+    // 编辑触及程序开头（可能改变是否由花括号包围）时全量解析
+    if (offset <= firstToken) {
+        fullParse();
+        return;
+    }
+    size_t editEnd = offset + removed;
+    size_t shift = inserted.size() - removed;   // 无符号回绕，加到旧位置上即为平移
+    if (offset > bodyEnd) {
+        // 只改动了闭合 '}' 之后被忽略的内容，AST 不变
+        stats = {};
+        stats.reusedItems = items.size();
+        return;
+    }
+
+    // 受影响的第一个顶层项：范围（到下一项起点为止）与编辑起点相接或相交的项。
+    // 前一项解析时会看到它的第一个 Token（if 之后是否有 else、出错后停在哪个边界），
+    // 因此从前一项的起点（一个 Token 边界）开始重新分析；更早的项与编辑无关。
+    auto byStart = [](const Item &item, size_t pos) { return item.start < pos; };
+    size_t i = std::lower_bound(items.begin(), items.end(), offset, byStart) - items.begin();
+    i -= std::min<size_t>(i, 2);
+    size_t base = i > 0 ? items[i].start : (wrapped ? firstToken + 1 : firstToken);
+    // 可能复用的第一个旧项：起点不早于编辑终点
+    size_t k = std::lower_bound(items.begin() + i, items.end(), editEnd, byStart) - items.begin();
+    size_t oldBodyEnd = bodyEnd;
+
+    fresh.clear();
+    freshDiags.clear();
+    lexer.setSource(std::string_view(source).substr(base));
+    parser.beginItems(nodes, false);
+    size_t synced = parseItems(base, offset + inserted.size(), k, shift);
+    if (synced < items.size())
+        bodyEnd = oldBodyEnd + shift;
+
+    // 各种类数组中被替换的一段 [lo, hi)，换成新解析出的同种类项
+    uint32_t lo[SlotCount], hi[SlotCount], added[SlotCount] = {};
+    for (int s = 0; s < SlotCount; s++) {
+        lo[s] = i < items.size() ? items[i].before[s] : slotSize(Slot(s));
+        hi[s] = synced < items.size() ? items[synced].before[s] : slotSize(Slot(s));
+    }
+    for (Item &item : fresh) {
+        std::copy(lo, lo + SlotCount, item.before);
+        for (int s = 0; s < SlotCount; s++)
+            item.before[s] += added[s];
+        if (item.node)
+            added[slotOf(item.node)]++;
+    }
+    resizeRange(functions, lo[FuncSlot], hi[FuncSlot], added[FuncSlot]);
+    resizeRange(decls, lo[DeclSlot], hi[DeclSlot], added[DeclSlot]);
+    resizeRange(stmts, lo[StmtSlot], hi[StmtSlot], added[StmtSlot]);
+    for (const Item &item : fresh) {
+        if (item.node)
+            place(item.node, item.before[slotOf(item.node)]);
+    }
+
+    // 诊断同样替换 [i, synced) 各项的一段，其后的平移位置
+    uint32_t diagLo = i < items.size() ? items[i].diagsBefore : static_cast<uint32_t>(itemDiags.size());
+    uint32_t diagHi = synced < items.size() ? items[synced].diagsBefore : static_cast<uint32_t>(itemDiags.size());
+    for (Item &item : fresh)
+        item.diagsBefore += diagLo;
+    resizeRange(itemDiags, diagLo, diagHi, freshDiags.size());
+    std::move(freshDiags.begin(), freshDiags.end(), itemDiags.begin() + diagLo);
+    for (size_t d = diagLo + freshDiags.size(); d < itemDiags.size(); d++)
+        itemDiags[d].offset += shift;
+    uint32_t diagDelta = static_cast<uint32_t>(freshDiags.size()) - (diagHi - diagLo);
+
+    // 复用的尾部：平移位置（子节点的偏移相对顶层项，不受影响）并修正各种类计数
+    uint32_t delta[SlotCount];
+    for (int s = 0; s < SlotCount; s++)
+        delta[s] = added[s] - (hi[s] - lo[s]);
+    for (size_t j = synced; j < items.size(); j++) {
+        items[j].start += shift;
+        if (items[j].node)
+            items[j].node->offset += static_cast<uint32_t>(shift);
+        for (int s = 0; s < SlotCount; s++)
+            items[j].before[s] += delta[s];
+        items[j].diagsBefore += diagDelta;
+    }
+    stats = {};
+    stats.reparsedItems = fresh.size();
+    stats.reusedItems = i + (items.size() - synced);
+    resizeRange(items, i, synced, fresh.size());
+    std::copy(fresh.begin(), fresh.end(), items.begin() + i);
+
+    // 被替换的旧节点积累到与存活节点相当时，全量解析一次回收 nodes
+    if (nodes.bytesUsed() > 2 * liveBytes + (1 << 20)) {
+        fullParse();
+        return;
+    }
+    updateRoot();
+}
+
+void IncrementalParser::updateRoot() {
+    root.functions = {functions.data(), static_cast<uint32_t>(functions.size())};
+    root.decls = {decls.data(), static_cast<uint32_t>(decls.size())};
+    root.stmts = {stmts.data(), static_cast<uint32_t>(stmts.size())};
+    root.symbolCount = parser.symbolCount();
+    // 与 Parser::error 相同：与上一条位于同一 Token 的错误不再重复报告
+    errors.clear();
+    for (const Diagnostic &d : itemDiags) {
+        if (errors.empty() || errors.back().offset != d.offset)
+            errors.push_back(d);
+    }
+}
@@ -0,0 +1,61 @@
+#include "../include/interner.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint32_t hashString(std::string_view s) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    for (unsigned char c : s)
+        h = (h ^ c) * 16777619u;
+    return h;
+}
+
+} // namespace
+
+Interner::Interner() : buckets(256, nullptr) {}
+
+void Interner::reset(Arena &target) {
+    arena = &target;
+    std::fill(buckets.begin(), buckets.end(), nullptr);
+    count = 0;
+}
+
+Symbol Interner::intern(std::string_view s) {
+    uint32_t hash = hashString(s);
+    size_t mask = buckets.size() - 1;
+    size_t slot = hash & mask;
+    while (const SymbolEntry *entry = buckets[slot]) {
+        if (entry->hash == hash && entry->length == s.size() &&
+            std::memcmp(entry->chars, s.data(), s.size()) == 0)
+            return Symbol(entry);
+        slot = (slot + 1) & mask;
+    }
+    std::string_view chars = arena->copyString(s);
+    auto *entry = arena->make<SymbolEntry>(SymbolEntry{++count, static_cast<uint32_t>(s.size()), hash, chars.data()});
+    buckets[slot] = entry;
+    if (count * 2 > buckets.size())
+        grow();
+    return Symbol(entry);
+}
+
+void Interner::grow() {
+    std::vector<const SymbolEntry *> old(buckets.size() * 2, nullptr);
+    old.swap(buckets);
+    size_t mask = buckets.size() - 1;
+    for (const SymbolEntry *entry : old) {
+        if (!entry)
+            continue;
+        size_t slot = entry->hash & mask;
+        while (buckets[slot])
+            slot = (slot + 1) & mask;
+        buckets[slot] = entry;
+    }
+}
+
+void Interner::entries(std::vector<const SymbolEntry *> &out) const {
+    out.assign(count + 1, nullptr);
+    for (const SymbolEntry *entry : buckets)
+        if (entry)
+            out[entry->id] = entry;
+}
@@ -1,139 +1,373 @@
 #include "../include/lexer.h"
-#include <unordered_set>
-#include <cctype>
+#include "../include/scanner.h"
+#include "../include/trace.h"
 
 namespace {
-    // 关键字集合，新增 "function"
-    const unordered_set<string> KEYWORDS = {"if", "else", "while", "int", "bool", "read", "write", "then", "do", "function"};
-    // 操作符集合
-    const unordered_set<string> OPERATORS = {"+", "-", "*", "/", "=", ":=", "==", "!=", "<", "<=", ">", ">=", "&&", "||", "!"};
-    // 分隔符集合
-    const unordered_set<char> DELIMITERS = {';', ',', '(', ')', '{', '}', ':'};
+
+//==========================
+// 记号规格：每个关键字、运算符与分隔符一行。
+// 标识符、数字、空白与注释是固定的模式，由 buildRawDFA 直接构造。
+// 新增记号只需在 TokenKind 中加一个种类、在这里加一行，DFA 在编译期随之重新生成。
+//==========================
+
+struct TokenSpec {
+    const char *text;
+    TokenKind kind;
+};
+
+constexpr TokenSpec TOKEN_SPECS[] = {
+    {"if", TokenKind::If},
+    {"else", TokenKind::Else},
+    {"while", TokenKind::While},
+    {"int", TokenKind::Int},
+    {"bool", TokenKind::Bool},
+    {"read", TokenKind::Read},
+    {"write", TokenKind::Write},
+    {"then", TokenKind::Then},
+    {"do", TokenKind::Do},
+    {"function", TokenKind::Function},
+    {"+", TokenKind::Plus},
+    {"-", TokenKind::Minus},
+    {"*", TokenKind::Star},
+    {"/", TokenKind::Slash},
+    {"=", TokenKind::Assign},
+    {":=", TokenKind::BoolAssign},
+    {"==", TokenKind::Eq},
+    {"!=", TokenKind::Ne},
+    {"<", TokenKind::Lt},
+    {"<=", TokenKind::Le},
+    {">", TokenKind::Gt},
+    {">=", TokenKind::Ge},
+    {"&&", TokenKind::And},
+    {"||", TokenKind::Or},
+    {"!", TokenKind::Not},
+    {";", TokenKind::Semicolon},
+    {",", TokenKind::Comma},
+    {"(", TokenKind::LParen},
+    {")", TokenKind::RParen},
+    {"{", TokenKind::LBrace},
+    {"}", TokenKind::RBrace},
+};
+
+constexpr size_t KIND_COUNT = static_cast<size_t>(TokenKind::RBrace) + 1;
+
+// 关键字、运算符与分隔符的每个种类恰好有一条规格，且规格的写法与所属大类相符
+constexpr bool specsMatchKinds() {
+    size_t seen[KIND_COUNT] = {};
+    for (const TokenSpec &spec : TOKEN_SPECS) {
+        bool word = scanner::classify(static_cast<unsigned char>(spec.text[0])) & scanner::CC_ID_START;
+        TokenType type = tokenTypeOf(spec.kind);
+        if (word != (type == TokenType::KEYWORD) || (type != TokenType::KEYWORD && type != TokenType::OPERATOR &&
+                                                      type != TokenType::DELIMITER))
+            return false;
+        seen[static_cast<size_t>(spec.kind)]++;
+    }
+    for (size_t k = static_cast<size_t>(TokenKind::If); k < KIND_COUNT; k++)
+        if (seen[k] != 1)
+            return false;
+    return true;
 }
+static_assert(specsMatchKinds(), "TOKEN_SPECS 与 TokenKind 不一致");
 
+struct Spellings {
+    const char *text[KIND_COUNT] = {};
+};
 
-void Lexer::handleComment(size_t &pos, const string &source) {
-    if (pos + 1 >= source.size()) return;
-    if (source[pos + 1] == '/') { // 行注释
-        pos += 2;
-        while (pos < source.size() && source[pos] != '\n')
-            pos++;
-    } else if (source[pos + 1] == '*') { // 块注释
-        pos += 2;
-        while (pos < source.size()) {
-            if (source[pos] == '*' && pos + 1 < source.size() && source[pos + 1] == '/'){
-                pos += 2;
-                return;
+constexpr Spellings makeSpellings() {
+    Spellings spellings;
+    for (size_t k = 0; k < KIND_COUNT; k++)
+        spellings.text[k] = "";
+    for (const TokenSpec &spec : TOKEN_SPECS)
+        spellings.text[static_cast<size_t>(spec.kind)] = spec.text;
+    return spellings;
+}
+
+constexpr Spellings SPELLINGS = makeSpellings();
+
+//==========================
+// 编译期生成的 DFA。
+// 先按规格与固定模式在 256 个字节上构造原始 DFA（规格部分为一棵字典树），再把在所有状态下
+// 转移都相同的字节合并为字节类，最后用 Moore 划分细化合并等价状态。
+// 状态 0 为死状态，1 为起始状态。接受状态记录 TokenKind，SKIP 表示空白与注释。
+// 自环状态标记 run：进入后用 scanner 的批量跳过函数一次吃掉自环上的字节，结果与逐字节转移相同。
+//==========================
+
+constexpr uint8_t NO_ACCEPT = 0xFF;
+constexpr uint8_t SKIP = 0xFE;
+
+enum Run : uint8_t {
+    RUN_NONE,
+    RUN_SPACE,      // 空白
+    RUN_IDENT,      // 标识符（已不可能是关键字）
+    RUN_DIGITS,     // 整数或小数部分
+    RUN_LINE,       // 行注释，停在 '\n'
+    RUN_BLOCK,      // 块注释，停在 "*/" 的 '*'
+};
+
+constexpr size_t MAX_STATES = 96;
+constexpr size_t MAX_CLASSES = 64;
+
+constexpr uint8_t DEAD = 0, START = 1;
+
+struct RawDFA {
+    size_t count = 0;
+    uint8_t next[MAX_STATES][256] = {};
+    uint8_t accept[MAX_STATES] = {};
+    uint8_t run[MAX_STATES] = {};
+};
+
+constexpr uint8_t accepting(TokenKind kind) { return static_cast<uint8_t>(kind); }
+
+constexpr RawDFA buildRawDFA() {
+    // 固定模式的状态
+    enum : uint8_t { SPACE = 2, IDENT, INT, FLOAT, LINE, BLOCK, BLOCK_STAR, BLOCK_END, FIXED_COUNT };
+    RawDFA d;
+    d.count = FIXED_COUNT;
+    for (size_t state = 0; state < MAX_STATES; state++)
+        d.accept[state] = NO_ACCEPT;
+    for (unsigned c = 0; c < 256; c++) {
+        uint8_t cls = scanner::classify(c);
+        if (cls & scanner::CC_SPACE)
+            d.next[START][c] = d.next[SPACE][c] = SPACE;
+        if (cls & scanner::CC_ID_START)
+            d.next[START][c] = IDENT;
+        if (cls & scanner::CC_ID_CONT)
+            d.next[IDENT][c] = IDENT;
+        if (cls & scanner::CC_DIGIT) {
+            d.next[START][c] = d.next[INT][c] = INT;
+            d.next[FLOAT][c] = FLOAT;
+        }
+        if (c != '\n')
+            d.next[LINE][c] = LINE;
+        d.next[BLOCK][c] = c == '*' ? BLOCK_STAR : BLOCK;
+        d.next[BLOCK_STAR][c] = c == '*' ? BLOCK_STAR : c == '/' ? BLOCK_END : BLOCK;
+    }
+    // 至多一个小数点："1." 也是浮点数，第二个小数点留给下一个 Token
+    d.next[INT]['.'] = FLOAT;
+    d.accept[SPACE] = d.accept[LINE] = d.accept[BLOCK] = d.accept[BLOCK_STAR] = d.accept[BLOCK_END] = SKIP;
+    d.accept[IDENT] = accepting(TokenKind::Identifier);
+    d.accept[INT] = accepting(TokenKind::Integer);
+    d.accept[FLOAT] = accepting(TokenKind::Float);
+    d.run[SPACE] = RUN_SPACE;
+    d.run[IDENT] = RUN_IDENT;
+    d.run[INT] = d.run[FLOAT] = RUN_DIGITS;
+    d.run[LINE] = RUN_LINE;
+    d.run[BLOCK] = RUN_BLOCK;
+
+    // 规格插入字典树。关键字前缀状态本身是标识符：其余标识符字节转到 IDENT
+    for (const TokenSpec &spec : TOKEN_SPECS) {
+        bool word = tokenTypeOf(spec.kind) == TokenType::KEYWORD;
+        uint8_t state = START;
+        for (const char *p = spec.text; *p; p++) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (d.next[state][c] < FIXED_COUNT) {
+                uint8_t created = static_cast<uint8_t>(d.count++);
+                if (word) {
+                    for (unsigned b = 0; b < 256; b++)
+                        if (scanner::classify(b) & scanner::CC_ID_CONT)
+                            d.next[created][b] = IDENT;
+                    d.accept[created] = accepting(TokenKind::Identifier);
+                }
+                d.next[state][c] = created;
             }
-            pos++;
+            state = d.next[state][c];
         }
+        d.accept[state] = accepting(spec.kind);
     }
+    // '/' 之后的 '/' 与 '*' 开始注释
+    uint8_t slash = d.next[START]['/'];
+    d.next[slash]['/'] = LINE;
+    d.next[slash]['*'] = BLOCK;
+    return d;
 }
 
-bool Lexer::isKeyword(const string &lexeme) {
-    return KEYWORDS.count(lexeme) > 0;
+struct LexerDFA {
+    size_t stateCount = 0;
+    size_t classCount = 0;
+    size_t rawStateCount = 0;
+    uint8_t byteClass[256] = {};
+    uint8_t next[MAX_STATES][MAX_CLASSES] = {};
+    uint8_t accept[MAX_STATES] = {};
+    uint8_t run[MAX_STATES] = {};
+};
+
+constexpr LexerDFA buildDFA() {
+    const RawDFA raw = buildRawDFA();
+    LexerDFA dfa;
+    dfa.rawStateCount = raw.count;
+
+    // 字节类：在所有状态下转移都相同的字节归为一类
+    uint8_t representative[MAX_CLASSES] = {};
+    for (unsigned c = 0; c < 256; c++) {
+        size_t k = 0;
+        for (; k < dfa.classCount; k++) {
+            bool same = true;
+            for (size_t state = 0; state < raw.count && same; state++)
+                same = raw.next[state][c] == raw.next[state][representative[k]];
+            if (same)
+                break;
+        }
+        if (k == dfa.classCount)
+            representative[dfa.classCount++] = static_cast<uint8_t>(c);
+        dfa.byteClass[c] = static_cast<uint8_t>(k);
+    }
+
+    // Moore 划分细化：初始按 (accept, run) 分组，之后反复按各字节类的后继所在分组细分，
+    // 直到分组数不再增加。编号按状态首次出现的顺序分配，死状态与起始状态仍为 0 与 1
+    uint8_t group[MAX_STATES] = {};
+    size_t groups = 0;
+    for (size_t state = 0; state < raw.count; state++) {
+        size_t g = 0;
+        for (; g < state; g++)
+            if (raw.accept[g] == raw.accept[state] && raw.run[g] == raw.run[state])
+                break;
+        group[state] = g < state ? group[g] : static_cast<uint8_t>(groups++);
+    }
+    while (true) {
+        uint8_t refined[MAX_STATES] = {};
+        size_t refinedCount = 0;
+        for (size_t state = 0; state < raw.count; state++) {
+            size_t other = 0;
+            for (; other < state; other++) {
+                bool same = group[other] == group[state];
+                for (size_t k = 0; k < dfa.classCount && same; k++)
+                    same = group[raw.next[other][representative[k]]] == group[raw.next[state][representative[k]]];
+                if (same)
+                    break;
+            }
+            refined[state] = other < state ? refined[other] : static_cast<uint8_t>(refinedCount++);
+        }
+        for (size_t state = 0; state < raw.count; state++)
+            group[state] = refined[state];
+        if (refinedCount == groups)
+            break;
+        groups = refinedCount;
+    }
+
+    dfa.stateCount = groups;
+    for (size_t state = 0; state < raw.count; state++) {
+        uint8_t g = group[state];
+        dfa.accept[g] = raw.accept[state];
+        dfa.run[g] = raw.run[state];
+        for (size_t k = 0; k < dfa.classCount; k++)
+            dfa.next[g][k] = group[raw.next[state][representative[k]]];
+    }
+    return dfa;
 }
 
-bool Lexer::isDelimiter(char c) {
-    return DELIMITERS.count(c) > 0;
+constexpr LexerDFA DFA = buildDFA();
+static_assert(DFA.rawStateCount < MAX_STATES && DFA.classCount <= MAX_CLASSES, "请增大 MAX_STATES 或 MAX_CLASSES");
+static_assert(DFA.next[DEAD][0] == DEAD && DFA.accept[START] == NO_ACCEPT, "死状态与起始状态的编号不应改变");
+
+} // namespace
+
+const char *tokenSpelling(TokenKind kind) {
+    return SPELLINGS.text[static_cast<size_t>(kind)];
 }
 
-bool Lexer::isOperatorChar(char c) {
-    string op_chars = "+-*/=!<>&|:";
-    return op_chars.find(c) != string::npos;
+void Lexer::setSource(const string &source) {
+    buffer = source;
+    src = buffer;
+    cursor = head = count = 0;
 }
 
-Token Lexer::handleIdentifier(size_t &pos, const string &source) {
-    size_t start = pos;
-    while (pos < source.size() && (isalnum(source[pos]) || source[pos] == '_'))
-        pos++;
-    string lexeme = source.substr(start, pos - start);
-    if (isKeyword(lexeme))
-        return {TokenType::KEYWORD, lexeme};
-    else
-        return {TokenType::IDENTIFIER, lexeme};
+void Lexer::setSource(string &&source) {
+    buffer = std::move(source);
+    src = buffer;
+    cursor = head = count = 0;
 }
 
-Token Lexer::handleNumber(size_t &pos, const string &source) {
-    size_t start = pos;
-    bool hasDot = false;
-    while (pos < source.size() && (isdigit(source[pos]) || source[pos] == '.')) {
-        if (source[pos] == '.') {
-            if (hasDot) break;
-            hasDot = true;
-        }
-        pos++;
-    }
-    string lexeme = source.substr(start, pos - start);
-    if (hasDot)
-        return {TokenType::FLOAT, lexeme};
-    else
-        return {TokenType::INTEGER, lexeme};
-}
-
-Token Lexer::handleOperator(size_t &pos, const string &source) {
-    string op;
-    op.push_back(source[pos]);
-    pos++;
-    // 尝试识别两字符操作符
-    if (pos < source.size()) {
-        string op2 = op;
-        op2.push_back(source[pos]);
-        if (OPERATORS.count(op2)) {
-            pos++;
-            return {TokenType::OPERATOR, op2};
-        }
-    }
-    if (OPERATORS.count(op))
-        return {TokenType::OPERATOR, op};
-    return {TokenType::ERROR, op};
+void Lexer::setSource(string_view source) {
+    buffer.clear();
+    src = source;
+    cursor = head = count = 0;
 }
 
+void Lexer::reset() {
+    buffer.clear();
+    src = {};
+    cursor = head = count = 0;
+}
 
-Token Lexer::handleDelimiter(size_t &pos, const string &source) {
-    char c = source[pos];
-    pos++;
-    return {TokenType::DELIMITER, string(1, c)};
+const Token &Lexer::peek(size_t k) {
+    while (count <= k) {
+        ring[(head + count) % LOOKAHEAD] = scanToken();
+        count++;
+    }
+    return ring[(head + k) % LOOKAHEAD];
 }
 
-Token Lexer::handleError(size_t &pos, const string &source) {
-    string err(1, source[pos]);
-    pos++;
-    return {TokenType::ERROR, err};
+Token Lexer::next() {
+    Token token = peek(0);
+    head = (head + 1) % LOOKAHEAD;
+    count--;
+    return token;
 }
 
 vector<Token> Lexer::tokenize(const string &source) {
+    setSource(source);
+    return drain();
+}
+
+vector<Token> Lexer::tokenize(string &&source) {
+    setSource(std::move(source));
+    return drain();
+}
+
+vector<Token> Lexer::tokenize(string_view source) {
+    setSource(source);
+    return drain();
+}
+
+vector<Token> Lexer::drain() {
+    TraceSpan span("Lexer::tokenize");
     vector<Token> tokens;
-    size_t pos = 0;
-    while (pos < source.size()) {
-        if (isspace(source[pos])) {
+    // 按平均每个 Token 约 8 字节预估容量，减少大文件上的扩容复制
+    tokens.reserve(src.size() / 8 + 1);
+    do {
+        tokens.push_back(next());
+    } while (tokens.back().kind != TokenKind::End);
+    return tokens;
+}
+
+// 整个词法分析是一个状态机循环：每个字节查一次字节类与转移表，按最长匹配取最后一个接受状态。
+// 空白与注释的接受结果为 SKIP，从其后继续；一个接受状态也没有经过时，首字节作为错误 Token。
+Token Lexer::scanToken() {
+    const char *s = src.data();
+    const size_t end = src.size();
+    size_t pos = cursor;
+    while (pos < end) {
+        size_t start = pos;
+        uint8_t state = START;
+        uint8_t accept = NO_ACCEPT;
+        size_t acceptEnd = start + 1;
+        while (pos < end) {
+            uint8_t next = DFA.next[state][DFA.byteClass[static_cast<unsigned char>(s[pos])]];
+            if (next == DEAD)
+                break;
+            state = next;
             pos++;
-            continue;
-        }
-        if (source[pos] == '/') {
-            if (pos + 1 < source.size() && (source[pos + 1] == '/' || source[pos + 1] == '*')) {
-                handleComment(pos, source);
-                continue;
+            switch (DFA.run[state]) {
+            case RUN_NONE:   break;
+            case RUN_SPACE:  pos = scanner::skipSpace(s, pos, end); break;
+            case RUN_IDENT:  pos = scanner::skipIdent(s, pos, end); break;
+            case RUN_DIGITS: pos = scanner::skipDigits(s, pos, end); break;
+            case RUN_LINE:   pos = scanner::findNewline(s, pos, end); break;
+            case RUN_BLOCK:  pos = scanner::findBlockEnd(s, pos, end); break;
+            }
+            if (DFA.accept[state] != NO_ACCEPT) {
+                accept = DFA.accept[state];
+                acceptEnd = pos;
             }
         }
-        if (isalpha(source[pos]) || source[pos] == '_') {
-            tokens.push_back(handleIdentifier(pos, source));
-            continue;
-        }
-        if (isdigit(source[pos])) {
-            tokens.push_back(handleNumber(pos, source));
-            continue;
-        }
-        if (isDelimiter(source[pos])) {
-            tokens.push_back(handleDelimiter(pos, source));
-            continue;
-        }
-        if (isOperatorChar(source[pos])) {
-            tokens.push_back(handleOperator(pos, source));
+        pos = acceptEnd;
+        if (accept == SKIP)
             continue;
-        }
-        tokens.push_back(handleError(pos, source));
+        cursor = pos;
+        TokenKind kind = accept == NO_ACCEPT ? TokenKind::Error : static_cast<TokenKind>(accept);
+        return {kind, src.substr(start, pos - start)};
     }
-    tokens.push_back({TokenType::END, ""});
-    return tokens;
+    cursor = pos;
+    // END 的 lexeme 为指向源码末尾的空视图，保证 offsetOf 对所有 Token 都有意义
+    return {TokenKind::End, src.substr(end)};
 }
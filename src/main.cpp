@@ -1,9 +1,26 @@
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <filesystem>
+#include <csignal>
+#include <unistd.h>
+#include "ast_writer.h"
+#include "bytecode.h"
 #include "lexer.h"
+#include "parallel_parser.h"
+#include "parse_cache.h"
 #include "parser.h"
+#include "semantic.h"
+#include "server.h"
+#include "source_file.h"
+#include "stats.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "vm.h"
 
 #define inputDir "./IO/testCases/" // 请修改为实际的源代码目录
 #define outputDir "./IO/output/"   // 请修改为实际的输出目录
@@ -11,12 +28,22 @@
 using namespace std;
 namespace fs = std::filesystem;
 
-vector<string> FileQueue() {
-    vector<string> file_list;
+// 一个待处理的输入：显示名、输入路径（"-" 表示标准输入）与输出文件路径
+struct InputFile {
+    string name;
+    string path;
+    string output;
+};
+
+vector<InputFile> FileQueue() {
+    vector<InputFile> file_list;
     try {
         for (const auto &entry : fs::directory_iterator(inputDir)) {
-            if (entry.is_regular_file())
-                file_list.push_back(entry.path().filename().string());
+            if (entry.is_regular_file()) {
+                string file = entry.path().filename().string();
+                // 输出文件名与输入文件相同
+                file_list.push_back({file, string(inputDir) + file, string(outputDir) + file});
+            }
         }
     } catch (const fs::filesystem_error &e) {
         throw runtime_error("目录访问失败: " + string(e.what()));
@@ -24,60 +51,506 @@ vector<string> FileQueue() {
     return file_list;
 }
 
-bool writeASTToFile(const ASTNode &ast, const string &filename) {
-    ofstream out(filename);
-    if (!out) {
-        cout << "无法打开输出文件：" << filename << endl;
+bool writeASTToFile(const ProgramNode &ast, const string &filename, OutputFormat format,
+                    OutputBuffer &out, ostream &log) {
+    TraceSpan span("writeASTToFile");
+    if (!out.open(filename)) {
+        log << "无法打开输出文件：" << filename << endl;
+        return false;
+    }
+    ASTWriter(out).write(ast, format);
+    return out.close();
+}
+
+// 把已经渲染好的输出（来自缓存或内存缓冲）写到文件
+bool writeOutput(const string &filename, string_view content, OutputBuffer &out, ostream &log) {
+    TraceSpan span("writeOutput");
+    if (!out.open(filename)) {
+        log << "无法打开输出文件：" << filename << endl;
+        return false;
+    }
+    out.append(content);
+    return out.close();
+}
+
+// 命令行直接给出的输入文件；"-" 表示从标准输入读取，结果写入输出目录下的 stdin
+vector<InputFile> inputsFromArgs(const vector<string> &paths) {
+    vector<InputFile> file_list;
+    for (const auto &path : paths) {
+        if (path == "-")
+            file_list.push_back({"stdin", path, string(outputDir) + "stdin"});
+        else
+            file_list.push_back({fs::path(path).filename().string(), path,
+                                 string(outputDir) + fs::path(path).filename().string()});
+    }
+    return file_list;
+}
+
+// 处理单个文件：读入、词法与语法分析、写出结果。控制台信息写入 log，
+// 并行模式下由调用方按文件顺序统一输出。返回是否成功生成 AST。
+// splitter 非空时单个文件按顶层项切分、在线程池上并行解析。
+// stats 非空时记录各阶段耗时与 AST 统计（成功与否及峰值内存由调用方填写）。
+// check 为 true 时语法分析成功后再做语义检查，语义错误与语法错误一样写入输出文件。
+// exprMode 不是 Tree 时表达式节点共享（与折叠），共享表不跨段，因此不切分而顺序解析。
+bool processFile(const InputFile &input, OutputFormat format, bool check, ExprMode exprMode, ostream &log, Arena &arena,
+                 OutputBuffer &out, ParseCache *cache, ParallelParser *splitter = nullptr,
+                 FileStats *stats = nullptr) {
+    const string currentOutput = input.output + outputExtension(format);
+    log << "当前文件: " << input.name << endl;
+    TraceSpan span("file", input.name);
+    StopWatch watch;
+    if (stats)
+        stats->name = input.name;
+    // 普通文件直接映射，Lexer 借用映射区域，不再复制源码
+    SourceFile source;
+    if (!source.load(input.path)) {
+        log << "无法找到输入文件: " << input.name << endl;
+        return false;
+    }
+    if (stats) {
+        stats->bytes = source.view().size();
+        stats->readSeconds = watch.lap();
+    }
+
+    // 内容未变的文件直接用缓存中的结果，跳过词法与语法分析
+    thread_local ParseCache::Entry entry;
+    uint64_t key = 0;
+    if (cache) {
+        key = ParseCache::keyOf(source.view(), format, check, exprMode == ExprMode::Folded);
+        if (cache->lookup(key, source.view(), entry)) {
+            log << "命中解析缓存" << endl;
+            bool written = writeOutput(currentOutput, entry.payload, out, log);
+            if (stats) {
+                stats->cached = true;
+                stats->writeSeconds = watch.lap();
+            }
+            if (!written) {
+                log << "写入文件失败" << endl;
+                return false;
+            }
+            if (!entry.ok) {
+                log << "语法分析错误:\n" << entry.message << endl;
+                return false;
+            }
+            log << "结果已写入: " << currentOutput << "\n\n";
+            return true;
+        }
+    }
+
+    // 词法分析：由 Parser 按需拉取 Token
+    log << "正在词法分析..." << endl;
+    Lexer lexer(source.view());
+    if (stats) {
+        // 单独数一遍 Token 得到词法分析的耗时，只在启用统计时执行
+        TraceSpan countSpan("countTokens");
+        Lexer counter(source.view());
+        while (counter.next().kind != TokenKind::End)
+            stats->tokens++;
+        stats->lexSeconds = watch.lap();
+    }
+    log << "词法分析完成, 开始语法分析..." << endl;
+
+    // 语法分析
+    Parser parser(lexer);
+    parser.setExprMode(exprMode);
+    if (exprMode != ExprMode::Tree)
+        splitter = nullptr;
+    arena.reset();
+    ProgramNode *ast = splitter ? splitter->parseProgram(source.view(), arena) : parser.parseProgram(arena);
+    const vector<Diagnostic> *found = splitter ? &splitter->diagnostics() : &parser.diagnostics();
+    if (stats) {
+        stats->parseSeconds = watch.lap();
+        stats->arenaBytes = arena.bytesUsed();
+        stats->shape = measureAST(*ast);
+        watch.lap();
+    }
+    const char *phase = "语法分析错误";
+    if (check && found->empty()) {
+        thread_local SemanticAnalyzer analyzer;
+        TraceSpan checkSpan("SemanticAnalyzer::analyze");
+        if (!analyzer.analyze(*ast)) {
+            // 共享的节点只记录第一次出现的位置，按树重新解析一遍以得到每处错误的准确位置
+            if (exprMode != ExprMode::Tree) {
+                parser.setExprMode(ExprMode::Tree);
+                lexer.setSource(source.view());
+                arena.reset();
+                ast = parser.parseProgram(arena);
+                analyzer.analyze(*ast);
+            }
+            found = &analyzer.diagnostics();
+            phase = "语义错误";
+        }
+        if (stats)
+            stats->checkSeconds = watch.lap();
+    }
+    const vector<Diagnostic> &diags = *found;
+    if (!diags.empty()) {
+        // 一遍解析收集到的全部错误写入输出文件（不完整的 AST 不输出）
+        string message = formatDiagnostics(source.view(), diags);
+        if (cache) {
+            entry.ok = false;
+            entry.message = message;
+            entry.payload.clear();
+            out.openString(entry.payload);
+            ASTWriter(out).writeError(message, format);
+            out.close();
+            if (writeOutput(currentOutput, entry.payload, out, log))
+                cache->store(key, source.view(), entry);
+        } else if (out.open(currentOutput)) {
+            ASTWriter(out).writeError(message, format);
+            out.close();
+        }
+        if (stats)
+            stats->writeSeconds = watch.lap();
+        log << phase << "（共 " << diags.size() << " 处）:\n" << message << endl;
         return false;
     }
-    ast.print(out);
+    log << (check ? "语法分析与语义检查完成" : "语法分析完成") << endl;
+    if (exprMode != ExprMode::Tree) {
+        const ExprStats &exprs = parser.exprStats();
+        log << "表达式节点 " << exprs.treeNodes << " 个，实际分配 " << exprs.nodes << " 个（复用 " << exprs.reused
+            << " 次，折叠 " << exprs.folded << " 处），节省 " << exprs.savedNodes() << " 个节点、"
+            << exprs.savedBytes() << " 字节" << endl;
+    }
+    // 输出 AST 到文件；启用缓存时先渲染到内存，写出后原样存入缓存
+    bool written;
+    if (cache) {
+        entry.ok = true;
+        entry.message.clear();
+        entry.payload.clear();
+        out.openString(entry.payload);
+        ASTWriter(out).write(*ast, format);
+        out.close();
+        written = writeOutput(currentOutput, entry.payload, out, log);
+        if (written)
+            cache->store(key, source.view(), entry);
+    } else {
+        written = writeASTToFile(*ast, currentOutput, format, out, log);
+    }
+    if (stats)
+        stats->writeSeconds = watch.lap();
+    if (written) {
+        log << "结果已写入: " << currentOutput << "\n\n";
+        return true;
+    }
+    log << "写入文件失败" << endl;
+    return false;
+}
+
+struct Options {
+    size_t jobs = 0;        // -j N：并行处理文件或服务请求的线程数，未给出时由 parseOptions 取默认值
+    OutputFormat format = OutputFormat::Text;   // --format：AST 输出格式
+    string cacheDir;                            // --cache-dir：解析缓存目录，为空时不使用缓存
+    uint64_t cacheSize = 256;                   // --cache-size：缓存容量上限（MB）
+    string statsPath;                           // --stats：分阶段统计报告（JSON），为空时不统计
+    string tracePath;                           // --trace：trace-event 输出文件，为空时不记录
+    bool traceFunctions = false;                // --trace-functions：另外记录每个函数定义的解析
+    string servePath;                           // --serve：常驻服务的套接字路径，"-" 为标准输入输出
+    bool check = false;                         // --check：语法分析后做语义检查
+    ExprMode exprMode = ExprMode::Tree;         // --exprs：表达式节点的构造方式
+    bool run = false;                           // --run：编译成字节码并执行，不输出 AST
+    uint64_t loopLimit = 0;                     // --loop-limit：每个程序的 while 迭代上限，0 表示不限
+    vector<string> inputs;  // 命令行给出的输入文件，为空时处理 inputDir 下的全部文件
+};
+
+void printUsage(const char *prog) {
+    cerr << "用法: " << prog << " [-j N] [--format=text|json|binary] [--check] [--exprs=MODE]\n"
+         << "       [--cache-dir=DIR [--cache-size=MB]] [--stats=FILE] [--trace=FILE [--trace-functions]] [文件...]\n"
+         << "       " << prog << " [-j N] --serve=SOCKET|-\n"
+         << "       " << prog << " --run [--loop-limit=N] 文件...\n"
+         << "  -j N    使用 N 个工作线程并行处理文件（默认 1，0 表示 CPU 核数）；\n"
+         << "          文件数少于 N 时逐个处理，每个大文件按顶层函数、声明与语句切分后并行解析\n"
+         << "  --format=FMT  AST 输出格式：text（默认）、json 或 binary，后两者输出文件加 .json/.bin 后缀\n"
+         << "  --check  语法分析成功后检查未声明或重复声明的名字与类型错误，有错误时不输出 AST\n"
+         << "  --exprs=MODE  表达式节点的构造方式：tree（默认）；shared 合并结构相同的子表达式，输出不变；\n"
+         << "          folded 另外折叠整数常量运算。后两者报告节省的节点数与字节数，单个文件不再切分并行解析\n"
+         << "  --cache-dir=DIR  把解析结果按源码内容缓存在 DIR 中，未修改的文件直接复用\n"
+         << "  --cache-size=MB  缓存容量上限，超出后按最近使用时间淘汰（默认 256）\n"
+         << "  --stats=FILE  把每个文件的读入、词法、语法、语义检查、输出耗时，Token 数、各类节点数、最大嵌套深度、\n"
+         << "          Arena 用量与峰值内存，连同合计与分位数写成 JSON 报告\n"
+         << "  --trace=FILE  写出 Chrome/Perfetto trace-event JSON：每个文件以及每次词法分析、语法分析、\n"
+         << "          输出各为一段，每个线程一行；--trace-functions 另外记录每个函数定义的解析\n"
+         << "  --serve=SOCKET  作为常驻服务在 Unix 域套接字上接受分析请求（协议见 include/server.h），\n"
+         << "          -j N 为同时处理的请求数（默认 CPU 核数），空闲的连接不占用工作线程；\n"
+         << "          \"-\" 表示在标准输入输出上服务单个连接\n"
+         << "  --run   把每个文件编译成字节码依次执行：read 从标准输入读整数，write 输出到标准输出\n"
+         << "  --loop-limit=N  执行时每个程序最多 N 次 while 迭代，超出即停止（默认不限）\n"
+         << "  文件    只处理给出的文件，\"-\" 表示标准输入；省略时处理 " << inputDir << " 下的全部文件\n";
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value;
+        if (arg.rfind("--format=", 0) == 0) {
+            if (!parseOutputFormat(string_view(arg).substr(9), options.format))
+                return false;
+            continue;
+        }
+        if (arg.rfind("--cache-dir=", 0) == 0) {
+            options.cacheDir = arg.substr(12);
+            if (options.cacheDir.empty())
+                return false;
+            continue;
+        }
+        if (arg.rfind("--stats=", 0) == 0) {
+            options.statsPath = arg.substr(8);
+            if (options.statsPath.empty())
+                return false;
+            continue;
+        }
+        if (arg.rfind("--trace=", 0) == 0) {
+            options.tracePath = arg.substr(8);
+            if (options.tracePath.empty())
+                return false;
+            continue;
+        }
+        if (arg.rfind("--serve=", 0) == 0) {
+            options.servePath = arg.substr(8);
+            if (options.servePath.empty())
+                return false;
+            continue;
+        }
+        if (arg.rfind("--exprs=", 0) == 0) {
+            if (!parseExprMode(string_view(arg).substr(8), options.exprMode))
+                return false;
+            continue;
+        }
+        if (arg == "--check") {
+            options.check = true;
+            continue;
+        }
+        if (arg == "--run") {
+            options.run = true;
+            continue;
+        }
+        if (arg.rfind("--loop-limit=", 0) == 0) {
+            char *end = nullptr;
+            options.loopLimit = strtoull(arg.c_str() + 13, &end, 10);
+            if (arg.size() == 13 || *end != '\0')
+                return false;
+            continue;
+        }
+        if (arg == "--trace-functions") {
+            options.traceFunctions = true;
+            continue;
+        }
+        if (arg.rfind("--cache-size=", 0) == 0) {
+            char *end = nullptr;
+            options.cacheSize = strtoull(arg.c_str() + 13, &end, 10);
+            if (arg.size() == 13 || *end != '\0' || options.cacheSize == 0)
+                return false;
+            continue;
+        }
+        if (arg == "-j" && i + 1 < argc)
+            value = argv[++i];
+        else if (arg.rfind("-j", 0) == 0 && arg.size() > 2)
+            value = arg.substr(2);
+        else if (arg == "-" || arg[0] != '-') {
+            options.inputs.push_back(arg);
+            continue;
+        } else
+            return false;
+        char *end = nullptr;
+        unsigned long jobs = strtoul(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0')
+            return false;
+        options.jobs = jobs ? jobs : max(1u, thread::hardware_concurrency());
+    }
+    // 处理文件默认单线程；常驻服务默认每个核一个工作线程
+    if (options.jobs == 0)
+        options.jobs = options.servePath.empty() ? 1 : max(1u, thread::hardware_concurrency());
     return true;
 }
 
-int main() {
+// 并行处理全部文件：按文件大小从大到小提交到工作窃取线程池，
+// 主线程按 fileList 原有顺序等待并输出每个文件的控制台信息，保证输出与顺序执行一致。
+// stats 非空时每个文件的统计写入其中对应的一项，各项只由处理该文件的线程写入。
+size_t processParallel(const vector<InputFile> &fileList, size_t jobs, OutputFormat format,
+                       bool check, ExprMode exprMode, ParseCache *cache, vector<FileStats> *stats) {
+    struct Result {
+        string log;
+        bool ok = false;
+        bool done = false;
+    };
+    vector<Result> results(fileList.size());
+    mutex doneMutex;
+    condition_variable doneChanged;
+
+    vector<pair<uintmax_t, size_t>> order;
+    for (size_t i = 0; i < fileList.size(); i++) {
+        error_code ec;
+        uintmax_t size = fs::file_size(fileList[i].path, ec);
+        order.push_back({ec ? 0 : size, i});
+    }
+    stable_sort(order.begin(), order.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    ThreadPool pool(jobs);
+    for (const auto &entry : order) {
+        size_t index = entry.second;
+        pool.submit([&, index] {
+            // 每个工作线程复用自己的 Arena 与输出缓冲
+            thread_local Arena arena;
+            thread_local OutputBuffer out;
+            ostringstream log;
+            FileStats *fileStats = stats ? &(*stats)[index] : nullptr;
+            bool ok = processFile(fileList[index], format, check, exprMode, log, arena, out, cache, nullptr, fileStats);
+            if (fileStats) {
+                fileStats->ok = ok;
+                fileStats->peakRss = peakRssBytes();
+            }
+            lock_guard<mutex> lock(doneMutex);
+            results[index].log = log.str();
+            results[index].ok = ok;
+            results[index].done = true;
+            doneChanged.notify_all();
+        });
+    }
+
+    size_t succeeded = 0;
+    for (auto &result : results) {
+        unique_lock<mutex> lock(doneMutex);
+        doneChanged.wait(lock, [&] { return result.done; });
+        cout << result.log << flush;
+        succeeded += result.ok;
+    }
+    pool.wait();
+    return succeeded;
+}
+
+// 依次解析、检查、编译并执行每个文件的顶层语句。所有程序共用标准输入，前一个程序
+// 没有读完的数字留给下一个；输出攒满缓冲区再写到标准输出。遇到错误即停止。
+bool runPrograms(const vector<InputFile> &fileList, uint64_t loopLimit) {
+    VMInput input(STDIN_FILENO);
+    OutputBuffer out(64 * 1024);
+    out.attach(STDOUT_FILENO);
+    Arena arena;
+    SemanticAnalyzer analyzer;
+    BytecodeCompiler compiler;
+    BytecodeModule module;
+    bool ok = true;
+    for (const InputFile &file : fileList) {
+        SourceFile source;
+        if (!source.load(file.path)) {
+            cerr << "无法找到输入文件: " << file.name << endl;
+            ok = false;
+            break;
+        }
+        Lexer lexer(source.view());
+        Parser parser(lexer);
+        arena.reset();
+        ProgramNode *ast = parser.parseProgram(arena);
+        if (!parser.diagnostics().empty()) {
+            cerr << file.name << " 语法分析错误:\n" << formatDiagnostics(source.view(), parser.diagnostics()) << endl;
+            ok = false;
+            break;
+        }
+        if (!analyzer.analyze(*ast)) {
+            cerr << file.name << " 语义错误:\n" << formatDiagnostics(source.view(), analyzer.diagnostics()) << endl;
+            ok = false;
+            break;
+        }
+        if (!compiler.compile(*ast, module)) {
+            cerr << file.name << " 无法执行: " << compiler.error() << endl;
+            ok = false;
+            break;
+        }
+        VM vm(module);
+        vm.setLoopLimit(loopLimit);
+        VMStatus status = vm.run(input, out);
+        if (status != VMStatus::Ok) {
+            out.close();
+            cerr << file.name << " 执行停止: " << vmStatusMessage(status) << endl;
+            ok = false;
+            break;
+        }
+    }
+    return out.close() && ok;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!options.tracePath.empty())
+        trace::start(options.traceFunctions ? TraceLevel::Function : TraceLevel::Phase);
     try {
-        vector<string> fileList = FileQueue();
-        for (const auto &file : fileList) {
-            string currentFileName = string(inputDir) + file;
-            string currentOutput = string(outputDir) + file; // 输出文件名与输入文件相同
-            cout << "当前文件: " << file << endl;
-            ifstream in(currentFileName);
-            if (!in) {
-                cout << "无法找到输入文件: " << file << endl;
-                continue;
+        if (!options.servePath.empty()) {
+            // 客户端中途断开时 write 返回错误而不是终止进程
+            signal(SIGPIPE, SIG_IGN);
+            AnalyzerServer server(options.jobs);
+            if (options.servePath == "-")
+                server.serveConnection(STDIN_FILENO, STDOUT_FILENO);
+            else
+                server.listen(options.servePath);
+            return EXIT_SUCCESS;
+        }
+        if (options.run) {
+            if (options.inputs.empty()) {
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
             }
-            stringstream buffer;
-            buffer << in.rdbuf();
-            string source = buffer.str();
-
-            // 词法分析
-            cout << "正在词法分析..." << endl;
-            Lexer lexer;
-            auto tokens = lexer.tokenize(source);
-            cout << "词法分析完成, 开始语法分析..." << endl;
-
-            // 语法分析
-            Parser parser(tokens);
-            unique_ptr<ProgramNode> ast;
-            try {
-                ast = parser.parseProgram();
-            } catch (const exception &e) {
-                // 将错误信息写入输出文件
-                ofstream errOut(currentOutput);
-                if (errOut) {
-                    errOut << "语法分析错误: " << e.what() << "\n";
+            return runPrograms(inputsFromArgs(options.inputs), options.loopLimit) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        auto start = chrono::steady_clock::now();
+        vector<InputFile> fileList = options.inputs.empty() ? FileQueue() : inputsFromArgs(options.inputs);
+        unique_ptr<ParseCache> cache;
+        if (!options.cacheDir.empty())
+            cache = make_unique<ParseCache>(options.cacheDir, options.cacheSize << 20);
+        size_t succeeded = 0;
+        vector<FileStats> stats(options.statsPath.empty() ? 0 : fileList.size());
+        vector<FileStats> *statsOut = stats.empty() ? nullptr : &stats;
+        if (options.jobs > 1 && fileList.size() >= options.jobs) {
+            succeeded = processParallel(fileList, options.jobs, options.format, options.check, options.exprMode,
+                                        cache.get(), statsOut);
+        } else {
+            // 所有文件共用一个 Arena，每个文件开始前整体复位，AST 内存只在首次增长时申请
+            Arena arena;
+            OutputBuffer out;
+            // 文件不足以占满所有线程时，改为在文件内部并行
+            unique_ptr<ThreadPool> pool;
+            unique_ptr<ParallelParser> splitter;
+            if (options.jobs > 1) {
+                pool = make_unique<ThreadPool>(options.jobs);
+                splitter = make_unique<ParallelParser>(*pool);
+            }
+            for (size_t i = 0; i < fileList.size(); i++) {
+                FileStats *fileStats = statsOut ? &stats[i] : nullptr;
+                bool ok = processFile(fileList[i], options.format, options.check, options.exprMode, cout, arena, out,
+                                      cache.get(), splitter.get(), fileStats);
+                if (fileStats) {
+                    fileStats->ok = ok;
+                    fileStats->peakRss = peakRssBytes();
                 }
-                cout << "语法分析错误: " << e.what() << endl;
-                continue;
+                succeeded += ok;
             }
-            cout << "语法分析完成" << endl;
-            // 输出 AST 到文件
-            if (writeASTToFile(*ast, currentOutput))
-                cout << "结果已写入: " << currentOutput << "\n\n";
-            else
-                cout << "写入文件失败" << endl;
         }
+        if (cache)
+            cache->trim();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
         cout << "所有文件处理完成，请到输出文件夹查看结果" << endl;
+        cout << "共 " << fileList.size() << " 个文件（成功 " << succeeded << "，失败 "
+             << fileList.size() - succeeded << "），线程数 " << options.jobs << "，用时 "
+             << fixed << setprecision(3) << seconds << " 秒，"
+             << setprecision(1) << (seconds > 0 ? fileList.size() / seconds : 0.0) << " 文件/秒" << endl;
+        if (cache)
+            cout << "解析缓存：命中 " << cache->hits() << "，未命中 " << cache->misses() << endl;
+        if (statsOut) {
+            if (!writeStatsReport(options.statsPath, stats, options.jobs, seconds)) {
+                cerr << "无法写入统计报告：" << options.statsPath << endl;
+                return EXIT_FAILURE;
+            }
+            cout << "统计报告已写入: " << options.statsPath << endl;
+        }
+        if (!options.tracePath.empty()) {
+            if (!trace::write(options.tracePath)) {
+                cerr << "无法写入跟踪文件：" << options.tracePath << endl;
+                return EXIT_FAILURE;
+            }
+            cout << "跟踪文件已写入: " << options.tracePath << endl;
+        }
     } catch (const exception &e) {
         cerr << "错误: " << e.what() << endl;
         return EXIT_FAILURE;
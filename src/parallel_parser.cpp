@@ -0,0 +1,321 @@
+#include "../include/parallel_parser.h"
+#include "../include/scanner.h"
+#include "../include/trace.h"
+#include <condition_variable>
+#include <mutex>
+
+namespace {
+
+// 跳过空白与注释，规则与 Lexer::scanToken 一致，返回下一个 Token 的起点
+size_t skipTrivia(std::string_view src, size_t pos) {
+    const char *s = src.data();
+    size_t end = src.size();
+    while (pos < end) {
+        if (scanner::CHAR_CLASS[static_cast<unsigned char>(s[pos])] & scanner::CC_SPACE) {
+            pos = scanner::skipSpace(s, pos + 1, end);
+        } else if (s[pos] == '/' && pos + 1 < end && s[pos + 1] == '/') {
+            pos = scanner::findNewline(s, pos + 2, end);
+        } else if (s[pos] == '/' && pos + 1 < end && s[pos + 1] == '*') {
+            pos = scanner::findBlockEnd(s, pos + 2, end);
+            if (pos < end)
+                pos += 2;
+        } else {
+            break;
+        }
+    }
+    return pos;
+}
+
+bool startsElse(std::string_view src, size_t pos) {
+    if (src.compare(pos, 4, "else") != 0)
+        return false;
+    return scanner::skipIdent(src.data(), pos, src.size()) == pos + 4;
+}
+
+// 预扫描：把各顶层项的起点写入 starts，bodyEnd 为最后一个顶层项之后的位置
+// （程序由花括号包围时为匹配的 '}'，否则为源码末尾）。括号不配对时返回 false。
+// 顶层项内部的 ';'（如参数列表中的分隔符）因圆括号或花括号深度非零而不会被当作边界。
+bool findItemStarts(std::string_view src, std::vector<size_t> &starts, size_t &bodyEnd) {
+    starts.clear();
+    const char *s = src.data();
+    size_t end = src.size();
+    size_t pos = skipTrivia(src, 0);
+    bool wrapped = pos < end && s[pos] == '{';
+    if (wrapped)
+        pos = skipTrivia(src, pos + 1);
+    if (pos < end && !(wrapped && s[pos] == '}'))
+        starts.push_back(pos);
+
+    int braces = 0, parens = 0;
+    while (pos < end) {
+        // 逐字节只关心括号、';' 与注释起始；其他字节都不会改变切分状态
+        char c = s[pos++];
+        bool boundary = false;
+        switch (c) {
+        case '/':
+            if (pos < end && (s[pos] == '/' || s[pos] == '*'))
+                pos = skipTrivia(src, pos - 1);
+            break;
+        case '{':
+            braces++;
+            break;
+        case '}':
+            if (braces == 0) {
+                // 包围整个程序的 '}'：之后的内容不参与解析
+                if (!wrapped || parens != 0)
+                    return false;
+                bodyEnd = pos - 1;
+                return true;
+            }
+            boundary = --braces == 0 && parens == 0;
+            break;
+        case '(':
+            parens++;
+            break;
+        case ')':
+            if (--parens < 0)
+                return false;
+            break;
+        case ';':
+            boundary = braces == 0 && parens == 0;
+            break;
+        default:
+            break;
+        }
+        if (!boundary)
+            continue;
+        pos = skipTrivia(src, pos);
+        // if ... then STMT 之后的 else 仍属于同一个 if 语句
+        if (pos < end && !startsElse(src, pos) && !(wrapped && s[pos] == '}'))
+            starts.push_back(pos);
+    }
+    bodyEnd = end;
+    return !wrapped && braces == 0 && parens == 0;
+}
+
+// 把顶层项中的符号换成合并后驻留表中的符号；map[id] 为段内编号 id 对应的新符号（map[0] 为空）。
+// 用显式栈遍历子树（顺序无关），stack 由调用方复用
+void remapItem(ASTNode *item, const std::vector<Symbol> &map, std::vector<ASTNode *> &stack) {
+    stack.push_back(item);
+    while (!stack.empty()) {
+        ASTNode *node = stack.back();
+        stack.pop_back();
+        switch (node->kind) {
+        case NodeKind::Literal: {
+            auto *literal = static_cast<LiteralExprNode *>(node);
+            literal->value = map[literal->value.id()];
+            break;
+        }
+        case NodeKind::Identifier: {
+            auto *identifier = static_cast<IdentifierExprNode *>(node);
+            identifier->name = map[identifier->name.id()];
+            break;
+        }
+        case NodeKind::BinaryExpr: {
+            auto *binary = static_cast<BinaryExprNode *>(node);
+            if (binary->left)
+                stack.push_back(binary->left);
+            stack.push_back(binary->right);
+            break;
+        }
+        case NodeKind::ExprStmt:
+            stack.push_back(static_cast<ExprStmtNode *>(node)->expr);
+            break;
+        case NodeKind::IfStmt: {
+            auto *stmt = static_cast<IfStmtNode *>(node);
+            stack.push_back(stmt->condition);
+            stack.push_back(stmt->thenStmt);
+            if (stmt->elseStmt)
+                stack.push_back(stmt->elseStmt);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto *stmt = static_cast<WhileStmtNode *>(node);
+            stack.push_back(stmt->condition);
+            stack.push_back(stmt->body);
+            break;
+        }
+        case NodeKind::BlockStmt:
+            for (StmtNode *child : static_cast<BlockStmtNode *>(node)->stmts)
+                stack.push_back(child);
+            break;
+        case NodeKind::ReadStmt: {
+            auto *stmt = static_cast<ReadStmtNode *>(node);
+            stmt->varName = map[stmt->varName.id()];
+            break;
+        }
+        case NodeKind::WriteStmt: {
+            auto *stmt = static_cast<WriteStmtNode *>(node);
+            stmt->varName = map[stmt->varName.id()];
+            break;
+        }
+        case NodeKind::Decl:
+            for (Symbol &name : static_cast<DeclNode *>(node)->names)
+                name = map[name.id()];
+            break;
+        case NodeKind::FuncDef: {
+            auto *func = static_cast<FuncDefNode *>(node);
+            func->name = map[func->name.id()];
+            for (Parameter &param : func->params) {
+                param.name = map[param.name.id()];
+                param.defaultVal = map[param.defaultVal.id()];
+            }
+            stack.push_back(func->body);
+            break;
+        }
+        case NodeKind::Program:
+            break;
+        }
+    }
+}
+
+// 等待一组任务完成；线程池可能同时运行其他任务，因此不使用 ThreadPool::wait
+class Latch {
+public:
+    explicit Latch(size_t count) : count(count) {}
+    void countDown() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--count == 0)
+            done.notify_all();
+    }
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return count == 0; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t count;
+};
+
+} // namespace
+
+// 一段源码的解析状态，跨调用复用（Arena 中的块在合并时被调用方的 arena 接管）
+struct ParallelParser::Chunk {
+    Lexer lexer;
+    Parser parser{lexer};
+    Arena arena;
+    std::string_view text;
+    std::vector<ASTNode *> items;
+    std::vector<const SymbolEntry *> entries;
+    std::vector<Symbol> map;
+    std::vector<ASTNode *> walk;    // remapItem 的遍历栈
+    bool failed = false;
+};
+
+ParallelParser::ParallelParser(ThreadPool &pool, size_t minChunkBytes)
+    : pool(pool), minChunkBytes(minChunkBytes) {}
+
+ParallelParser::~ParallelParser() = default;
+
+ProgramNode *ParallelParser::parseSequential(std::string_view source, Arena &arena) {
+    chunkCount = 0;
+    Lexer lexer(source);
+    Parser parser(lexer);
+    ProgramNode *program = parser.parseProgram(arena);
+    diags = parser.diagnostics();
+    return program;
+}
+
+ProgramNode *ParallelParser::parseProgram(std::string_view source, Arena &arena) {
+    diags.clear();
+    size_t bodyEnd = 0;
+    if (pool.size() < 2 || source.size() < 2 * minChunkBytes ||
+        !findItemStarts(source, itemStarts, bodyEnd) || itemStarts.size() < 2)
+        return parseSequential(source, arena);
+
+    // 相邻顶层项合并成段：每段至少 minChunkBytes，段数约为线程数的 4 倍以便均衡负载
+    size_t target = std::max(minChunkBytes, (bodyEnd - itemStarts.front()) / (pool.size() * 4));
+    chunkCount = 0;
+    size_t begin = itemStarts.front();
+    for (size_t i = 1; i <= itemStarts.size(); i++) {
+        size_t end = i < itemStarts.size() ? itemStarts[i] : bodyEnd;
+        if (end - begin < target && i < itemStarts.size())
+            continue;
+        if (chunkCount == chunks.size())
+            chunks.push_back(std::make_unique<Chunk>());
+        chunks[chunkCount++]->text = source.substr(begin, end - begin);
+        begin = end;
+    }
+    if (chunkCount < 2)
+        return parseSequential(source, arena);
+
+    Latch latch(chunkCount);
+    for (size_t c = 0; c < chunkCount; c++) {
+        Chunk *chunk = chunks[c].get();
+        pool.submit([chunk, &latch] {
+            TraceSpan span("ParallelParser::parseChunk");
+            chunk->items.clear();
+            chunk->failed = false;
+            chunk->arena.reset();
+            chunk->lexer.setSource(chunk->text);
+            chunk->parser.beginItems(chunk->arena, true);
+            while (chunk->lexer.peek(0).kind != TokenKind::End) {
+                ASTNode *item = chunk->parser.parseItem();
+                if (!item) {
+                    // 段内的诊断偏移相对于段，直接按顺序解析重新得到完整的诊断
+                    chunk->failed = true;
+                    break;
+                }
+                chunk->items.push_back(item);
+            }
+            latch.countDown();
+        });
+    }
+    latch.wait();
+    for (size_t c = 0; c < chunkCount; c++) {
+        if (chunks[c]->failed) {
+            for (size_t d = 0; d < chunkCount; d++)
+                chunks[d]->arena.reset();
+            return parseSequential(source, arena);
+        }
+    }
+
+    // 按段的顺序合并驻留表：各段内按首次出现的顺序编号，依次驻留后与顺序解析的编号一致
+    interner.reset(arena);
+    for (size_t c = 0; c < chunkCount; c++) {
+        Chunk *chunk = chunks[c].get();
+        chunk->parser.symbolEntries(chunk->entries);
+        chunk->map.assign(chunk->entries.size(), Symbol());
+        for (size_t id = 1; id < chunk->entries.size(); id++)
+            chunk->map[id] = interner.intern(Symbol(chunk->entries[id]).str());
+    }
+    Latch remapped(chunkCount);
+    for (size_t c = 0; c < chunkCount; c++) {
+        Chunk *chunk = chunks[c].get();
+        pool.submit([chunk, &remapped] {
+            TraceSpan span("ParallelParser::remapChunk");
+            for (ASTNode *item : chunk->items)
+                remapItem(item, chunk->map, chunk->walk);
+            remapped.countDown();
+        });
+    }
+    remapped.wait();
+
+    // 按源码顺序拼接顶层项，节点所在的块并入调用方的 arena
+    std::vector<FuncDefNode *> functions;
+    std::vector<ASTNode *> decls, stmts;
+    for (size_t c = 0; c < chunkCount; c++) {
+        // 段内顶层项的偏移相对于段的起点
+        uint32_t base = static_cast<uint32_t>(chunks[c]->text.data() - source.data());
+        for (ASTNode *item : chunks[c]->items) {
+            item->offset += base;
+            if (item->kind == NodeKind::FuncDef)
+                functions.push_back(static_cast<FuncDefNode *>(item));
+            else if (item->kind == NodeKind::Decl)
+                decls.push_back(item);
+            else
+                stmts.push_back(item);
+        }
+        chunks[c]->items.clear();
+    }
+    auto *program = arena.make<ProgramNode>();
+    program->functions = arena.copyList(functions.data(), functions.size());
+    program->decls = arena.copyList(decls.data(), decls.size());
+    program->stmts = arena.copyList(stmts.data(), stmts.size());
+    program->symbolCount = interner.size();
+    for (size_t c = 0; c < chunkCount; c++)
+        arena.adopt(chunks[c]->arena);
+    return program;
+}
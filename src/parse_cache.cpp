@@ -0,0 +1,214 @@
+#include "../include/parse_cache.h"
+#include "../include/hash.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const char ENTRY_MAGIC[4] = {'G', 'P', 'C', '1'};
+const size_t KEY_DIGITS = 16;
+
+// 条目文件头，紧跟 message 与 payload
+struct EntryHeader {
+    char magic[4];
+    uint32_t ok;
+    uint64_t key;
+    uint64_t sourceSize;
+    uint64_t sourceCheck;   // 以另一种子计算的源码哈希，与 key 合起来防止碰撞
+    uint64_t messageSize;
+    uint64_t payloadSize;
+    uint64_t payloadCheck;
+};
+
+const uint64_t CHECK_SEED = 0x6c6974746c6563ULL;
+
+bool writeAll(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t written = ::write(fd, p, n);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += written;
+        n -= written;
+    }
+    return true;
+}
+
+bool readAll(int fd, char *p, size_t n) {
+    while (n > 0) {
+        ssize_t got = ::read(fd, p, n);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return false;
+        p += got;
+        n -= got;
+    }
+    return true;
+}
+
+bool isEntryName(const char *name) {
+    if (strlen(name) != KEY_DIGITS)
+        return false;
+    for (const char *c = name; *c; c++)
+        if (!isxdigit(static_cast<unsigned char>(*c)))
+            return false;
+    return true;
+}
+
+} // namespace
+
+ParseCache::ParseCache(std::string dir, uint64_t maxBytes) : dir(std::move(dir)), maxBytes(maxBytes) {
+    if (this->dir.empty())
+        this->dir = ".";
+    // 逐级创建目录
+    for (size_t pos = 1; pos <= this->dir.size(); pos++) {
+        if (pos != this->dir.size() && this->dir[pos] != '/')
+            continue;
+        std::string prefix = this->dir.substr(0, pos);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST)
+            throw std::runtime_error("无法创建缓存目录 " + this->dir + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (stat(this->dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+        throw std::runtime_error("缓存路径不是目录: " + this->dir);
+}
+
+uint64_t ParseCache::keyOf(std::string_view source, OutputFormat format, bool checked, bool folded) {
+    static const uint64_t versionSeed = xxh64(ANALYZER_VERSION);
+    return xxh64(source, versionSeed + static_cast<uint64_t>(format) + (checked ? 0x100 : 0) + (folded ? 0x200 : 0));
+}
+
+std::string ParseCache::pathOf(uint64_t key) const {
+    char name[KEY_DIGITS + 1];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return dir + "/" + name;
+}
+
+bool ParseCache::lookup(uint64_t key, std::string_view source, Entry &entry) const {
+    std::string path = pathOf(key);
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        missCount++;
+        return false;
+    }
+    EntryHeader header;
+    bool valid = readAll(fd, reinterpret_cast<char *>(&header), sizeof(header)) &&
+                 memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) == 0 &&
+                 header.key == key && header.sourceSize == source.size() &&
+                 header.messageSize <= (1u << 20) && header.payloadSize <= maxBytes;
+    if (valid) {
+        entry.ok = header.ok != 0;
+        entry.message.resize(header.messageSize);
+        entry.payload.resize(header.payloadSize);
+        valid = readAll(fd, entry.message.data(), entry.message.size()) &&
+                readAll(fd, entry.payload.data(), entry.payload.size()) &&
+                xxh64(entry.payload) == header.payloadCheck &&
+                xxh64(source, CHECK_SEED) == header.sourceCheck;
+    }
+    if (valid) {
+        // 刷新修改时间，淘汰时按它近似 LRU
+        futimens(fd, nullptr);
+    }
+    ::close(fd);
+    if (!valid) {
+        // 损坏、截断或哈希碰撞的条目：删除后按未命中处理
+        unlink(path.c_str());
+        missCount++;
+        return false;
+    }
+    hitCount++;
+    return true;
+}
+
+void ParseCache::store(uint64_t key, std::string_view source, const Entry &entry) {
+    EntryHeader header;
+    memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    header.ok = entry.ok;
+    header.key = key;
+    header.sourceSize = source.size();
+    header.sourceCheck = xxh64(source, CHECK_SEED);
+    header.messageSize = entry.message.size();
+    header.payloadSize = entry.payload.size();
+    header.payloadCheck = xxh64(entry.payload);
+    uint64_t size = sizeof(header) + entry.message.size() + entry.payload.size();
+    if (size > maxBytes)
+        return;
+
+    // 先写临时文件再原子地 rename，并发的读者与写者互不干扰
+    std::string tmp = dir + "/.tmp." + std::to_string(getpid()) + "." + std::to_string(tempCounter++);
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+    bool ok = writeAll(fd, reinterpret_cast<const char *>(&header), sizeof(header)) &&
+              writeAll(fd, entry.message.data(), entry.message.size()) &&
+              writeAll(fd, entry.payload.data(), entry.payload.size());
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), pathOf(key).c_str()) != 0) {
+        unlink(tmp.c_str());
+        return;
+    }
+    if ((bytesSinceTrim += size) > maxBytes / 4)
+        trim();
+}
+
+void ParseCache::trim() {
+    bytesSinceTrim = 0;
+    std::string lockPath = dir + "/.lock";
+    int lockFd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lockFd < 0)
+        return;
+    if (flock(lockFd, LOCK_EX | LOCK_NB) != 0) {
+        ::close(lockFd);
+        return;
+    }
+
+    struct Item {
+        time_t mtime;
+        uint64_t size;
+        std::string name;
+    };
+    std::vector<Item> items;
+    uint64_t total = 0;
+    time_t now = time(nullptr);
+    if (DIR *d = opendir(dir.c_str())) {
+        int dfd = dirfd(d);
+        while (dirent *e = readdir(d)) {
+            struct stat st;
+            if (fstatat(dfd, e->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(st.st_mode))
+                continue;
+            if (isEntryName(e->d_name)) {
+                items.push_back({st.st_mtime, static_cast<uint64_t>(st.st_size), e->d_name});
+                total += st.st_size;
+            } else if (strncmp(e->d_name, ".tmp.", 5) == 0 && now - st.st_mtime > 3600) {
+                // 崩溃的写者遗留的临时文件
+                unlinkat(dfd, e->d_name, 0);
+            }
+        }
+        if (total > maxBytes) {
+            std::sort(items.begin(), items.end(),
+                      [](const Item &a, const Item &b) { return a.mtime < b.mtime; });
+            uint64_t target = maxBytes / 4 * 3;
+            for (const Item &item : items) {
+                if (total <= target)
+                    break;
+                if (unlinkat(dfd, item.name.c_str(), 0) == 0)
+                    total -= item.size;
+            }
+        }
+        closedir(d);
+    }
+    flock(lockFd, LOCK_UN);
+    ::close(lockFd);
+}
@@ -1,318 +1,656 @@
 #include "../include/parser.h"
+#include "../include/flat_ast.h"
+#include "../include/trace.h"
+#include <algorithm>
 #include <iostream>
 
-Token Parser::currentToken() {
-    if (pos < tokens.size())
-        return tokens[pos];
-    return {TokenType::END, ""};
+const Token &Parser::currentToken() {
+    return lexer.peek(0);
 }
 
-void Parser::consume(TokenType expected, const std::string &expectedLexeme) {
-    Token token = currentToken();
-    if (token.type != expected || (!expectedLexeme.empty() && token.lexeme != expectedLexeme)) {
-        throw std::runtime_error("语法错误: 期待 " + expectedLexeme + "，但得到 " + token.lexeme);
+const Token &Parser::peekToken(size_t k) {
+    return lexer.peek(k);
+}
+
+ValueType Parser::typeOf(const Token &token) {
+    return token.kind == TokenKind::Bool ? ValueType::Bool : ValueType::Int;
+}
+
+bool Parser::atFuncDef() {
+    return peekToken(1).kind == TokenKind::Identifier && peekToken(2).kind == TokenKind::LParen;
+}
+
+bool Parser::consume(TokenKind expected) {
+    const Token &token = currentToken();
+    if (token.kind != expected) {
+        error("语法错误: 期待 " + string(tokenSpelling(expected)) + "，但得到 " + string(token.lexeme));
+        return false;
     }
-    pos++;
+    lexer.next();
+    return true;
 }
 
-bool Parser::match(TokenType type, const std::string &lexeme) {
-    Token token = currentToken();
-    if (token.type == type && (lexeme.empty() || token.lexeme == lexeme)) {
-        pos++;
+bool Parser::match(TokenKind kind) {
+    if (at(kind)) {
+        lexer.next();
         return true;
     }
     return false;
 }
 
+void Parser::error(std::string message) {
+    size_t offset = lexer.offsetOf(currentToken());
+    // 恢复后在同一个 Token 上再次出错（例如文件在块中途结束）只是前一个错误的连锁反应
+    if (!diags.empty() && diags.back().offset == offset)
+        return;
+    diags.push_back({offset, std::move(message)});
+}
+
+void Parser::synchronize(size_t start) {
+    // 出错时还停在语句开头则先跳过一个 Token，保证每次恢复都有进展
+    if (!at(TokenKind::End) && lexer.offsetOf(currentToken()) == start)
+        lexer.next();
+    // 跳过的部分里若有完整的 {...}，连同其中的 ';' 一起跳过，不让内层的 '}' 结束外层的块
+    int depth = 0;
+    while (true) {
+        switch (currentToken().kind) {
+        case TokenKind::End:
+            return;
+        case TokenKind::LBrace:
+            depth++;
+            break;
+        case TokenKind::RBrace:
+            if (depth == 0)
+                return;
+            if (--depth == 0) {
+                lexer.next();
+                return;
+            }
+            break;
+        case TokenKind::Semicolon:
+            if (depth == 0) {
+                lexer.next();
+                return;
+            }
+            break;
+        case TokenKind::If: case TokenKind::While: case TokenKind::Read:
+        case TokenKind::Write: case TokenKind::Int: case TokenKind::Bool:
+            if (depth == 0)
+                return;
+            break;
+        default:
+            break;
+        }
+        lexer.next();
+    }
+}
+
+std::string formatDiagnostics(std::string_view source, const std::vector<Diagnostic> &diags) {
+    std::string out;
+    // 诊断按偏移递增排列，行号沿源码向前累计
+    size_t line = 1, pos = 0;
+    for (const Diagnostic &d : diags) {
+        size_t offset = std::min(d.offset, source.size());
+        if (offset >= pos) {
+            line += std::count(source.begin() + pos, source.begin() + offset, '\n');
+            pos = offset;
+        }
+        if (!out.empty())
+            out += '\n';
+        out += "第 " + std::to_string(line) + " 行: " + d.message;
+    }
+    return out;
+}
+
 // 解析程序：既可能包含全局函数定义，也可能包含全局声明或语句
 std::unique_ptr<ProgramNode> Parser::parseProgram() {
     auto program = std::make_unique<ProgramNode>();
+    program->ownedArena = std::make_unique<Arena>();
+    arena = program->ownedArena.get();
+    resetTables(*arena);
+    parseProgramBody(*program);
+    return program;
+}
+
+ProgramNode *Parser::parseProgram(Arena &target) {
+    arena = &target;
+    resetTables(target);
+    auto *program = arena->make<ProgramNode>();
+    parseProgramBody(*program);
+    return program;
+}
+
+void Parser::parseProgram(FlatAST &out) {
+    flatScratch.reset();
+    out.assign(*parseProgram(flatScratch));
+}
+
+void Parser::beginItems(Arena &target, bool resetSymbols) {
+    arena = &target;
+    if (resetSymbols)
+        resetTables(target);
+    diags.clear();
+    // 上一次解析可能中途出错，先清空暂存区
+    stmtScratch.clear();
+    funcScratch.clear();
+    declScratch.clear();
+    topStmtScratch.clear();
+}
+
+void Parser::resetTables(Arena &target) {
+    interner.reset(target);
+    if (exprMode != ExprMode::Tree)
+        exprDag.reset(target, interner, exprMode);
+}
+
+void Parser::reset() {
+    arena = nullptr;
+    flatScratch.reset();
+    diags.clear();
+    stmtScratch.clear();
+    funcScratch.clear();
+    declScratch.clear();
+    topStmtScratch.clear();
+    nameScratch.clear();
+    paramScratch.clear();
+    stmtFrames.clear();
+    exprOps.clear();
+    exprValues.clear();
+}
+
+void Parser::parseProgramBody(ProgramNode &program) {
+    TraceSpan span("Parser::parseProgram");
+    beginItems(*arena, false);
 
     // 如果程序以 { 开始，则认为整个程序被块包围
-    if (currentToken().type == TokenType::DELIMITER && currentToken().lexeme == "{") {
-        consume(TokenType::DELIMITER, "{");
-        while (!(currentToken().type == TokenType::DELIMITER && currentToken().lexeme == "}")) {
-            if (currentToken().type == TokenType::KEYWORD &&
-               (currentToken().lexeme == "int" || currentToken().lexeme == "bool")) {
-                // 判断是函数定义还是全局变量声明
-                if (pos + 1 < tokens.size() && tokens[pos+1].type == TokenType::IDENTIFIER &&
-                    pos + 2 < tokens.size() && tokens[pos+2].type == TokenType::DELIMITER &&
-                    tokens[pos+2].lexeme == "(") {
-                    program->functions.push_back(parseFuncDef());
-                } else {
-                    program->decls.push_back(parseDecl());
-                }
-            } else {
-                program->stmts.push_back(parseStmt());
-            }
+    if (match(TokenKind::LBrace)) {
+        while (!at(TokenKind::RBrace)) {
+            bool atEnd = at(TokenKind::End);
+            parseTopLevelItem();
+            if (atEnd)
+                break;  // 缺少 '}'：已在文件结束处报错
         }
-        consume(TokenType::DELIMITER, "}");
+        consume(TokenKind::RBrace);
     }
     // 否则，不带外层块，直接解析到文件结束
     else {
-        while (currentToken().type != TokenType::END) {
-            if (currentToken().type == TokenType::KEYWORD &&
-               (currentToken().lexeme == "int" || currentToken().lexeme == "bool")) {
-                if (pos + 1 < tokens.size() && tokens[pos+1].type == TokenType::IDENTIFIER &&
-                    pos + 2 < tokens.size() && tokens[pos+2].type == TokenType::DELIMITER &&
-                    tokens[pos+2].lexeme == "(") {
-                    program->functions.push_back(parseFuncDef());
-                } else {
-                    program->decls.push_back(parseDecl());
-                }
-            } else {
-                program->stmts.push_back(parseStmt());
-            }
+        while (!at(TokenKind::End)) {
+            parseTopLevelItem();
         }
     }
-    return program;
+    program.functions = arena->copyList(funcScratch.data(), funcScratch.size());
+    program.decls = arena->copyList(declScratch.data(), declScratch.size());
+    program.stmts = arena->copyList(topStmtScratch.data(), topStmtScratch.size());
+    program.symbolCount = interner.size();
+}
+
+void Parser::parseTopLevelItem() {
+    size_t start = lexer.offsetOf(currentToken());
+    ASTNode *item = parseItem();
+    if (!item)
+        synchronize(start);
+    else if (item->kind == NodeKind::FuncDef)
+        funcScratch.push_back(static_cast<FuncDefNode *>(item));
+    else if (item->kind == NodeKind::Decl)
+        declScratch.push_back(item);
+    else
+        topStmtScratch.push_back(item);
+}
+
+ASTNode *Parser::parseItem() {
+    itemStart = lexer.offsetOf(currentToken());
+    ASTNode *item;
+    if (at(TokenKind::Int) || at(TokenKind::Bool)) {
+        // 判断是函数定义还是全局变量声明
+        item = atFuncDef() ? static_cast<ASTNode *>(parseFuncDef()) : parseDecl();
+    } else {
+        item = parseStmt();
+    }
+    // 顶层项记录相对源码开头的位置
+    if (item)
+        item->offset = static_cast<uint32_t>(itemStart);
+    return item;
 }
 
 
 // 新增：解析函数定义，形如：
 // returnType IDENTIFIER ( [参数列表] ) { 函数体 }
 // 参数列表中各参数形如： type IDENTIFIER [ = literal ]
-std::unique_ptr<FuncDefNode> Parser::parseFuncDef() {
-    auto func = std::make_unique<FuncDefNode>();
+// 参数列表出错时跳到 ')' 或 '{' 继续解析函数体，保留已解析的参数
+FuncDefNode *Parser::parseFuncDef() {
+    TraceSpan span("Parser::parseFuncDef", TraceLevel::Function);
+    auto *func = makeNode<FuncDefNode>(lexer.offsetOf(currentToken()));
     // 返回类型
-    func->returnType = currentToken().lexeme;
-    consume(TokenType::KEYWORD, func->returnType);
+    func->returnType = typeOf(lexer.next());
     // 函数名
-    Token id = currentToken();
-    if (id.type != TokenType::IDENTIFIER)
-        throw std::runtime_error("语法错误: 函数定义期望标识符");
-    func->name = id.lexeme;
-    consume(TokenType::IDENTIFIER);
+    const Token &id = currentToken();
+    if (id.kind != TokenKind::Identifier) {
+        error("语法错误: 函数定义期望标识符");
+        return nullptr;
+    }
+    func->name = interner.intern(id.lexeme);
+    span.setArg(id.lexeme);
+    lexer.next();
     // 参数列表
-    consume(TokenType::DELIMITER, "(");
-    while (!(currentToken().type == TokenType::DELIMITER && currentToken().lexeme == ")")) {
+    if (!consume(TokenKind::LParen))
+        return nullptr;
+    paramScratch.clear();
+    bool paramsOk = true;
+    while (!at(TokenKind::RParen)) {
         Parameter param;
         // 参数类型
-        if (currentToken().type != TokenType::KEYWORD ||
-            (currentToken().lexeme != "int" && currentToken().lexeme != "bool"))
-            throw std::runtime_error("语法错误: 参数类型应为 int 或 bool");
-        param.type = currentToken().lexeme;
-        consume(TokenType::KEYWORD, param.type);
+        if (!at(TokenKind::Int) && !at(TokenKind::Bool)) {
+            error("语法错误: 参数类型应为 int 或 bool");
+            paramsOk = false;
+            break;
+        }
+        param.type = typeOf(lexer.next());
         // 参数名
-        if (currentToken().type != TokenType::IDENTIFIER)
-            throw std::runtime_error("语法错误: 参数期望标识符");
-        param.name = currentToken().lexeme;
-        consume(TokenType::IDENTIFIER);
+        if (!at(TokenKind::Identifier)) {
+            error("语法错误: 参数期望标识符");
+            paramsOk = false;
+            break;
+        }
+        param.name = interner.intern(lexer.next().lexeme);
         // 可选的默认值
-        if (currentToken().type == TokenType::OPERATOR && currentToken().lexeme == "=") {
-            consume(TokenType::OPERATOR, "=");
+        if (match(TokenKind::Assign)) {
             // 默认值要求为整数或浮点字面量
-            if (currentToken().type != TokenType::INTEGER && currentToken().type != TokenType::FLOAT)
-                throw std::runtime_error("语法错误: 参数默认值应为整数或浮点数");
-            param.defaultVal = currentToken().lexeme;
-            consume(currentToken().type);
+            if (!at(TokenKind::Integer) && !at(TokenKind::Float)) {
+                error("语法错误: 参数默认值应为整数或浮点数");
+                paramsOk = false;
+                break;
+            }
+            param.defaultVal = interner.intern(lexer.next().lexeme);
         }
-        func->params.push_back(param);
+        paramScratch.push_back(param);
         // 参数之间使用分号分隔（测试案例中使用分号）
-        if (currentToken().type == TokenType::DELIMITER && currentToken().lexeme == ";") {
-            consume(TokenType::DELIMITER, ";");
-        }
-        else {
+        if (!match(TokenKind::Semicolon))
             break; // 若不是分号，则参数列表结束或后续有语法错误
-        }
     }
-    consume(TokenType::DELIMITER, ")");
-    // 函数体必须为块语句
-    auto block = parseBlock();
-    // 动态转换为 BlockStmtNode 类型
-    func->body = std::unique_ptr<BlockStmtNode>(dynamic_cast<BlockStmtNode*>(block.release()));
+    if (!paramsOk || !consume(TokenKind::RParen)) {
+        while (!at(TokenKind::End) && !at(TokenKind::RParen) && !at(TokenKind::LBrace))
+            lexer.next();
+        match(TokenKind::RParen);
+    }
+    func->params = arena->copyList(paramScratch.data(), paramScratch.size());
+    // 函数体必须为块语句（parseBlock 在缺少 '{' 时报错）
+    func->body = parseBlock();
     if (!func->body)
-        throw std::runtime_error("语法错误: 函数体必须为块语句");
+        return nullptr;
     return func;
 }
 
-std::unique_ptr<DeclNode> Parser::parseDecl() {
-    auto decl = std::make_unique<DeclNode>();
+DeclNode *Parser::parseDecl() {
+    auto *decl = makeNode<DeclNode>(lexer.offsetOf(currentToken()));
     // 声明： "int" 或 "bool" 后跟标识符列表，以 ; 结尾
-    Token token = currentToken();
-    if (token.lexeme == "int" || token.lexeme == "bool") {
-        decl->type = token.lexeme;
-        consume(TokenType::KEYWORD, token.lexeme);
+    if (at(TokenKind::Int) || at(TokenKind::Bool)) {
+        decl->type = typeOf(lexer.next());
     } else {
-        throw std::runtime_error("语法错误: 声明必须以 int 或 bool 开始");
+        error("语法错误: 声明必须以 int 或 bool 开始");
+        return nullptr;
     }
     // 至少一个标识符
-    Token idToken = currentToken();
-    if (idToken.type != TokenType::IDENTIFIER)
-        throw std::runtime_error("语法错误: 声明缺少标识符");
-    decl->names.push_back(idToken.lexeme);
-    consume(TokenType::IDENTIFIER);
+    if (!at(TokenKind::Identifier)) {
+        error("语法错误: 声明缺少标识符");
+        return nullptr;
+    }
+    nameScratch.clear();
+    nameScratch.push_back(interner.intern(lexer.next().lexeme));
     // 多个标识符以逗号分隔
-    while (currentToken().type == TokenType::DELIMITER && currentToken().lexeme == ",") {
-        consume(TokenType::DELIMITER, ",");
-        idToken = currentToken();
-        if (idToken.type != TokenType::IDENTIFIER)
-            throw std::runtime_error("语法错误: 声明中缺少标识符");
-        decl->names.push_back(idToken.lexeme);
-        consume(TokenType::IDENTIFIER);
+    while (match(TokenKind::Comma)) {
+        if (!at(TokenKind::Identifier)) {
+            error("语法错误: 声明中缺少标识符");
+            return nullptr;
+        }
+        nameScratch.push_back(interner.intern(lexer.next().lexeme));
     }
-    consume(TokenType::DELIMITER, ";");
+    if (!consume(TokenKind::Semicolon))
+        return nullptr;
+    decl->names = arena->copyList(nameScratch.data(), nameScratch.size());
     return decl;
 }
 
-std::unique_ptr<StmtNode> Parser::parseStmt() {
-    Token token = currentToken();
-    if (token.type == TokenType::KEYWORD) {
-        if (token.lexeme == "if") {
-            consume(TokenType::KEYWORD, "if");
-            Token cond = currentToken();
-            if (cond.type != TokenType::IDENTIFIER)
-                throw std::runtime_error("语法错误: if 条件部分期望标识符");
-            auto condition = std::make_unique<IdentifierExprNode>(cond.lexeme);
-            consume(TokenType::IDENTIFIER);
-            consume(TokenType::KEYWORD, "then");
-            auto thenStmt = parseStmt();
-            std::unique_ptr<StmtNode> elseStmt = nullptr;
-            if (currentToken().type == TokenType::KEYWORD && currentToken().lexeme == "else") {
-                consume(TokenType::KEYWORD, "else");
-                elseStmt = parseStmt();
+// 语句用显式的帧栈解析：if/while/块各压入一帧，子语句完成后交给栈顶帧，
+// 嵌套再深也只增长 stmtFrames，不占用调用栈。子语句出错（nullptr）时向上传递，
+// 直到所在的块跳到下一个语句边界，与逐层递归的恢复方式相同。
+StmtNode *Parser::parseStmt() {
+    size_t base = stmtFrames.size();
+    StmtNode *stmt = nullptr;
+    bool completed = false;     // stmt 是否为刚完成（或出错）、待交给栈顶帧的语句
+    while (true) {
+        if (!completed) {
+            if (stmtFrames.size() > base && stmtFrames.back().kind == StmtFrame::Block) {
+                StmtFrame &frame = stmtFrames.back();
+                if (frame.closing || at(TokenKind::RBrace)) {
+                    // 缺少 '}' 时报错，但仍返回已解析的部分
+                    consume(TokenKind::RBrace);
+                    auto *block = static_cast<BlockStmtNode *>(frame.node);
+                    block->stmts = arena->copyList(stmtScratch.data() + frame.mark, stmtScratch.size() - frame.mark);
+                    stmtScratch.resize(frame.mark);
+                    stmtFrames.pop_back();
+                    stmt = block;
+                    completed = true;
+                } else {
+                    frame.start = lexer.offsetOf(currentToken());
+                    frame.atEnd = at(TokenKind::End);
+                }
+            }
+            if (!completed) {
+                size_t depth = stmtFrames.size();
+                stmt = beginStmt();
+                if (stmtFrames.size() > depth)
+                    continue;   // 复合语句压入了一帧，接着解析它的子语句
+                completed = true;
             }
-            auto ifStmt = std::make_unique<IfStmtNode>();
-            ifStmt->condition = std::move(condition);
-            ifStmt->thenStmt = std::move(thenStmt);
-            ifStmt->elseStmt = std::move(elseStmt);
-            return ifStmt;
-        }
-        else if (token.lexeme == "while") {
-            consume(TokenType::KEYWORD, "while");
-            Token cond = currentToken();
-            if (cond.type != TokenType::IDENTIFIER)
-                throw std::runtime_error("语法错误: while 条件部分期望标识符");
-            auto condition = std::make_unique<IdentifierExprNode>(cond.lexeme);
-            consume(TokenType::IDENTIFIER);
-            consume(TokenType::KEYWORD, "do");
-            auto body = parseStmt();
-            auto whileStmt = std::make_unique<WhileStmtNode>();
-            whileStmt->condition = std::move(condition);
-            whileStmt->body = std::move(body);
-            return whileStmt;
         }
-        else if (token.lexeme == "read") {
-            consume(TokenType::KEYWORD, "read");
-            Token id = currentToken();
-            if (id.type != TokenType::IDENTIFIER)
-                throw std::runtime_error("语法错误: read 语句期望标识符");
-            string varName = id.lexeme;
-            consume(TokenType::IDENTIFIER);
-            consume(TokenType::DELIMITER, ";");
-            return std::make_unique<ReadStmtNode>(varName);
+        if (stmtFrames.size() == base)
+            return stmt;
+
+        // 把完成的语句交给栈顶帧
+        StmtFrame &frame = stmtFrames.back();
+        completed = false;
+        switch (frame.kind) {
+        case StmtFrame::Block:
+            // 块内某条语句出错时跳过它继续解析后续语句
+            if (stmt)
+                stmtScratch.push_back(stmt);
+            else if (frame.atEnd)
+                frame.closing = true;
+            else
+                synchronize(frame.start);
+            break;
+        case StmtFrame::Then: {
+            auto *ifStmt = static_cast<IfStmtNode *>(frame.node);
+            if (stmt) {
+                ifStmt->thenStmt = stmt;
+                if (match(TokenKind::Else)) {
+                    frame.kind = StmtFrame::Else;
+                    break;
+                }
+                stmt = ifStmt;
+            }
+            stmtFrames.pop_back();
+            completed = true;
+            break;
         }
-        else if (token.lexeme == "write") {
-            consume(TokenType::KEYWORD, "write");
-            // 此处考虑写语句中可能有多个标识符，中间以逗号分隔
-            vector<string> vars;
-            Token id = currentToken();
-            if (id.type != TokenType::IDENTIFIER)
-                throw std::runtime_error("语法错误: write 语句期望标识符");
-            vars.push_back(id.lexeme);
-            consume(TokenType::IDENTIFIER);
-            while (currentToken().type == TokenType::DELIMITER && currentToken().lexeme == ",") {
-                consume(TokenType::DELIMITER, ",");
-                id = currentToken();
-                if (id.type != TokenType::IDENTIFIER)
-                    throw std::runtime_error("语法错误: write 语句期望标识符");
-                vars.push_back(id.lexeme);
-                consume(TokenType::IDENTIFIER);
+        case StmtFrame::Else:
+            if (stmt) {
+                static_cast<IfStmtNode *>(frame.node)->elseStmt = stmt;
+                stmt = frame.node;
+            }
+            stmtFrames.pop_back();
+            completed = true;
+            break;
+        case StmtFrame::Body:
+            if (stmt) {
+                static_cast<WhileStmtNode *>(frame.node)->body = stmt;
+                stmt = frame.node;
             }
-            consume(TokenType::DELIMITER, ";");
-            // 此处将写语句视为一个表达式语句，输出时只打印第一个变量（或根据需要扩展 AST）
-            // 为简单起见，我们只生成一个 WriteStmtNode，并将第一个标识符传入
-            return std::make_unique<WriteStmtNode>(vars.front());
+            stmtFrames.pop_back();
+            completed = true;
+            break;
+        }
+    }
+}
+
+StmtNode *Parser::beginStmt() {
+    const Token &token = currentToken();
+    const size_t start = lexer.offsetOf(token);
+    switch (token.kind) {
+    case TokenKind::If: {
+        lexer.next();
+        ExprNode *condition = parseExpr(ExprKind::Bool);
+        if (!condition || !consume(TokenKind::Then))
+            return nullptr;
+        auto *ifStmt = makeNode<IfStmtNode>(start);
+        ifStmt->condition = condition;
+        stmtFrames.push_back({StmtFrame::Then, false, false, 0, 0, ifStmt});
+        return nullptr;
+    }
+    case TokenKind::While: {
+        lexer.next();
+        ExprNode *condition = parseExpr(ExprKind::Bool);
+        if (!condition || !consume(TokenKind::Do))
+            return nullptr;
+        auto *whileStmt = makeNode<WhileStmtNode>(start);
+        whileStmt->condition = condition;
+        stmtFrames.push_back({StmtFrame::Body, false, false, 0, 0, whileStmt});
+        return nullptr;
+    }
+    case TokenKind::Read: {
+        lexer.next();
+        if (!at(TokenKind::Identifier)) {
+            error("语法错误: read 语句期望标识符");
+            return nullptr;
         }
+        Symbol varName = interner.intern(lexer.next().lexeme);
+        if (!consume(TokenKind::Semicolon))
+            return nullptr;
+        return makeNode<ReadStmtNode>(start, varName);
     }
-    else if (token.type == TokenType::DELIMITER && token.lexeme == "{") {
-        return parseBlock();
+    case TokenKind::Write: {
+        lexer.next();
+        // 此处考虑写语句中可能有多个标识符，中间以逗号分隔
+        if (!at(TokenKind::Identifier)) {
+            error("语法错误: write 语句期望标识符");
+            return nullptr;
+        }
+        string_view first = lexer.next().lexeme;
+        while (match(TokenKind::Comma)) {
+            if (!at(TokenKind::Identifier)) {
+                error("语法错误: write 语句期望标识符");
+                return nullptr;
+            }
+            lexer.next();
+        }
+        if (!consume(TokenKind::Semicolon))
+            return nullptr;
+        // 此处将写语句视为一个表达式语句，输出时只打印第一个变量（或根据需要扩展 AST）
+        // 为简单起见，我们只生成一个 WriteStmtNode，并将第一个标识符传入
+        return makeNode<WriteStmtNode>(start, interner.intern(first));
     }
-    // 赋值语句： id = EXPR ; 或 id := EXPR ;
-    if (token.type == TokenType::IDENTIFIER) {
-        string varName = token.lexeme;
-        consume(TokenType::IDENTIFIER);
-        Token op = currentToken();
-        if (op.type == TokenType::OPERATOR && op.lexeme == "=") {
-            consume(TokenType::OPERATOR, "=");
-            auto expr = parseExpr();
-            consume(TokenType::DELIMITER, ";");
-            auto assignExpr = std::make_unique<BinaryExprNode>("=", std::make_unique<IdentifierExprNode>(varName), std::move(expr));
-            return std::make_unique<ExprStmtNode>(std::move(assignExpr));
+    case TokenKind::LBrace:
+        lexer.next();
+        stmtFrames.push_back({StmtFrame::Block, false, false, 0, stmtScratch.size(), makeNode<BlockStmtNode>(start)});
+        return nullptr;
+    case TokenKind::Identifier: {
+        // 赋值语句： id = EXPR ; 或 id := EXPR ;
+        Symbol varName = interner.intern(lexer.next().lexeme);
+        size_t opPos = lexer.offsetOf(currentToken());
+        BinaryOp assignOp;
+        if (match(TokenKind::Assign)) {
+            assignOp = BinaryOp::Assign;
         }
-        else if (op.type == TokenType::OPERATOR && op.lexeme == ":=") {
-            consume(TokenType::OPERATOR, ":=");
-            auto expr = parseExpr();
-            consume(TokenType::DELIMITER, ";");
-            auto assignExpr = std::make_unique<BinaryExprNode>(":=", std::make_unique<IdentifierExprNode>(varName), std::move(expr));
-            return std::make_unique<ExprStmtNode>(std::move(assignExpr));
+        else if (match(TokenKind::BoolAssign)) {
+            assignOp = BinaryOp::BoolAssign;
         }
         else {
-            throw std::runtime_error("语法错误: 赋值语句缺少 '=' 或 ':='");
+            error("语法错误: 赋值语句缺少 '=' 或 ':='");
+            return nullptr;
         }
+        // '=' 右侧为算术表达式，':=' 右侧为布尔表达式
+        ExprNode *expr = parseExpr(assignOp == BinaryOp::Assign ? ExprKind::Arith : ExprKind::Bool);
+        if (!expr || !consume(TokenKind::Semicolon))
+            return nullptr;
+        auto *assignExpr = makeNode<BinaryExprNode>(opPos, assignOp, makeNode<IdentifierExprNode>(start, varName), expr);
+        return makeNode<ExprStmtNode>(start, assignExpr);
+    }
+    default:
+        error("语法错误: 未识别的语句起始符 " + string(token.lexeme));
+        return nullptr;
     }
-    throw std::runtime_error("语法错误: 未识别的语句起始符 " + token.lexeme);
 }
 
-std::unique_ptr<StmtNode> Parser::parseBlock() {
-    consume(TokenType::DELIMITER, "{");
-    auto block = std::make_unique<BlockStmtNode>();
-    while (!(currentToken().type == TokenType::DELIMITER && currentToken().lexeme == "}")) {
-        block->stmts.push_back(parseStmt());
+BlockStmtNode *Parser::parseBlock() {
+    if (!at(TokenKind::LBrace)) {
+        consume(TokenKind::LBrace);
+        return nullptr;
     }
-    consume(TokenType::DELIMITER, "}");
-    return block;
+    // 块语句本身不会失败，出错的子语句已在块内跳过
+    return static_cast<BlockStmtNode *>(parseStmt());
 }
 
-std::unique_ptr<ExprNode> Parser::parseExpr() {
-    auto left = parseTerm();
-    while (currentToken().type == TokenType::OPERATOR &&
-           (currentToken().lexeme == "+" || currentToken().lexeme == "-")) {
-        string op = currentToken().lexeme;
-        consume(TokenType::OPERATOR, op);
-        auto right = parseTerm();
-        left = std::make_unique<BinaryExprNode>(op, std::move(left), std::move(right));
+// 表达式用表驱动的运算符优先分析：操作数与待归约的运算符各用一个栈，算术、关系、
+// 逻辑各层在同一个循环里按优先级表归约，括号与一元运算符只是运算符栈中的标记，
+// 嵌套深度不占用调用栈。优先级与文法一致（数值越大结合越紧）：
+//   ||  1    &&  2    ! 与关系运算 3    + -  4    * /  5    一元负号 6
+// 二元算术与逻辑运算左结合，关系运算不能连用（REL → EXPR [relop EXPR]）。
+// 一元负号表示为 0 - x，逻辑非表示为只有右操作数的 Not（见 ast.h）。
+namespace {
+
+constexpr uint8_t REL_PREC = 3;
+constexpr uint8_t NOT_PREC = 3;
+constexpr uint8_t NEGATE_PREC = 6;
+
+// 二元运算符的优先级，按 BinaryOp 排列；0 表示不能出现在表达式中（赋值）
+constexpr uint8_t PRECEDENCE[] = {
+    4, 4, 5, 5,         // + - * /
+    0, 0,               // = :=
+    3, 3, 3, 3, 3, 3,   // == != < <= > >=
+    2, 1,               // && ||
+    3,                  // !（只作前缀，不在这里查）
+};
+static_assert(sizeof(PRECEDENCE) == static_cast<size_t>(BinaryOp::Not) + 1, "PRECEDENCE 与 BinaryOp 不一致");
+
+// 各种表达式的最低优先级：更低的运算符结束表达式，留给外层处理
+constexpr uint8_t FLOOR[] = {4, 1};     // ExprKind::Arith、ExprKind::Bool
+
+// 当前 Token 是否为表达式中的二元运算符
+bool binaryOperator(const Token &token, BinaryOp &op) {
+    switch (token.kind) {
+    case TokenKind::Plus:  op = BinaryOp::Add; return true;
+    case TokenKind::Minus: op = BinaryOp::Sub; return true;
+    case TokenKind::Star:  op = BinaryOp::Mul; return true;
+    case TokenKind::Slash: op = BinaryOp::Div; return true;
+    case TokenKind::Eq:    op = BinaryOp::Eq; return true;
+    case TokenKind::Ne:    op = BinaryOp::Ne; return true;
+    case TokenKind::Lt:    op = BinaryOp::Lt; return true;
+    case TokenKind::Le:    op = BinaryOp::Le; return true;
+    case TokenKind::Gt:    op = BinaryOp::Gt; return true;
+    case TokenKind::Ge:    op = BinaryOp::Ge; return true;
+    case TokenKind::And:   op = BinaryOp::And; return true;
+    case TokenKind::Or:    op = BinaryOp::Or; return true;
+    default:               return false;
     }
-    return left;
 }
 
-std::unique_ptr<ExprNode> Parser::parseTerm() {
-    auto left = parseFactor();
-    while (currentToken().type == TokenType::OPERATOR &&
-           (currentToken().lexeme == "*" || currentToken().lexeme == "/")) {
-        string op = currentToken().lexeme;
-        consume(TokenType::OPERATOR, op);
-        auto right = parseFactor();
-        left = std::make_unique<BinaryExprNode>(op, std::move(left), std::move(right));
-    }
-    return left;
+} // namespace
+
+ExprNode *Parser::makeLeaf(NodeKind kind, Symbol symbol, uint32_t offset) {
+    if (exprMode != ExprMode::Tree)
+        return exprDag.leaf(kind, symbol, offset);
+    ExprNode *node;
+    if (kind == NodeKind::Identifier)
+        node = arena->make<IdentifierExprNode>(symbol);
+    else
+        node = arena->make<LiteralExprNode>(symbol);
+    node->offset = offset;
+    return node;
 }
 
-std::unique_ptr<ExprNode> Parser::parseFactor() {
-    if (currentToken().type == TokenType::OPERATOR && currentToken().lexeme == "-") {
-        consume(TokenType::OPERATOR, "-");
-        auto factor = parseFactor();
-        auto zero = std::make_unique<LiteralExprNode>("0");
-        return std::make_unique<BinaryExprNode>("-", std::move(zero), std::move(factor));
-    }
-    return parsePrimary();
+ExprNode *Parser::makeBinary(BinaryOp op, ExprNode *left, ExprNode *right, uint32_t offset) {
+    if (exprMode != ExprMode::Tree)
+        return exprDag.binary(op, left, right, offset);
+    ExprNode *node = arena->make<BinaryExprNode>(op, left, right);
+    node->offset = offset;
+    return node;
 }
 
-std::unique_ptr<ExprNode> Parser::parsePrimary() {
-    Token token = currentToken();
-    if (token.type == TokenType::INTEGER || token.type == TokenType::FLOAT) {
-        consume(token.type);
-        return std::make_unique<LiteralExprNode>(token.lexeme);
+void Parser::reduceExpr() {
+    ExprOp top = exprOps.back();
+    exprOps.pop_back();
+    ExprNode *right = exprValues.back();
+    if (top.kind == ExprOp::Negate) {
+        ExprNode *zero = makeLeaf(NodeKind::Literal, interner.intern("0"), top.offset);
+        exprValues.back() = makeBinary(BinaryOp::Sub, zero, right, top.offset);
+        return;
     }
-    else if (token.type == TokenType::IDENTIFIER) {
-        consume(TokenType::IDENTIFIER);
-        return std::make_unique<IdentifierExprNode>(token.lexeme);
+    if (top.kind == ExprOp::Not) {
+        exprValues.back() = makeBinary(BinaryOp::Not, nullptr, right, top.offset);
+        return;
     }
-    else if (token.type == TokenType::DELIMITER && token.lexeme == "(") {
-        consume(TokenType::DELIMITER, "(");
-        auto expr = parseExpr();
-        consume(TokenType::DELIMITER, ")");
-        return expr;
+    exprValues.pop_back();
+    exprValues.back() = makeBinary(top.op, exprValues.back(), right, top.offset);
+}
+
+ExprNode *Parser::parseExpr(ExprKind kind) {
+    const uint8_t floor = FLOOR[static_cast<int>(kind)];
+    size_t opBase = exprOps.size();
+    size_t valueBase = exprValues.size();
+    size_t openParens = 0;
+    bool expectOperand = true;
+    while (true) {
+        const Token &token = currentToken();
+        const uint32_t offset = static_cast<uint32_t>(lexer.offsetOf(token) - itemStart);
+        if (expectOperand) {
+            // 期待操作数：前缀运算符与左括号先入栈
+            if (token.kind == TokenKind::Minus) {
+                exprOps.push_back({ExprOp::Negate, BinaryOp::Sub, NEGATE_PREC, offset});
+            } else if (token.kind == TokenKind::Not && floor <= NOT_PREC &&
+                       (exprOps.size() == opBase || exprOps.back().kind != ExprOp::Negate)) {
+                // NOT → "!" REL：只出现在布尔表达式中，且不能作为负号的操作数
+                exprOps.push_back({ExprOp::Not, BinaryOp::Not, NOT_PREC, offset});
+            } else if (token.kind == TokenKind::LParen) {
+                exprOps.push_back({ExprOp::Paren, BinaryOp::Sub, 0, offset});
+                openParens++;
+            } else if (token.kind == TokenKind::Identifier) {
+                exprValues.push_back(makeLeaf(NodeKind::Identifier, interner.intern(token.lexeme), offset));
+                expectOperand = false;
+            } else if (token.kind == TokenKind::Integer || token.kind == TokenKind::Float) {
+                exprValues.push_back(makeLeaf(NodeKind::Literal, interner.intern(token.lexeme), offset));
+                expectOperand = false;
+            } else {
+                error("语法错误: 在表达式中未识别到合法的标识符、数字或 '('");
+                break;
+            }
+            lexer.next();
+            continue;
+        }
+        // 期待运算符：')' 闭合最近的 '('
+        if (openParens > 0 && token.kind == TokenKind::RParen) {
+            while (exprOps.back().kind != ExprOp::Paren)
+                reduceExpr();
+            exprOps.pop_back();
+            openParens--;
+            lexer.next();
+            continue;
+        }
+        BinaryOp op;
+        if (!binaryOperator(token, op) || PRECEDENCE[static_cast<int>(op)] < floor) {
+            // 表达式结束；仍有未闭合的 '(' 时报告缺少 ')'
+            if (openParens > 0) {
+                consume(TokenKind::RParen);
+                break;
+            }
+            while (exprOps.size() > opBase)
+                reduceExpr();
+            ExprNode *expr = exprValues.back();
+            exprValues.pop_back();
+            return expr;
+        }
+        // 入栈前先归约栈顶结合更紧的运算符，以及同级的二元运算符（左结合）
+        uint8_t prec = PRECEDENCE[static_cast<int>(op)];
+        bool chained = false;
+        while (exprOps.size() > opBase) {
+            const ExprOp &top = exprOps.back();
+            bool sameLevel = top.kind == ExprOp::Binary && top.prec == prec;
+            if (top.prec <= prec && !sameLevel)
+                break;
+            if (sameLevel && prec == REL_PREC) {
+                chained = true;
+                break;
+            }
+            reduceExpr();
+        }
+        if (chained) {
+            error("语法错误: 关系运算符不能连用");
+            break;
+        }
+        exprOps.push_back({ExprOp::Binary, op, prec, offset});
+        lexer.next();
+        expectOperand = true;
     }
-    throw std::runtime_error("语法错误: 在表达式中未识别到合法的标识符、数字或 '('");
+    exprOps.resize(opBase);
+    exprValues.resize(valueBase);
+    return nullptr;
 }
@@ -0,0 +1,301 @@
+#include "../include/scanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace scanner {
+
+const uint8_t CHAR_CLASS[256] = {
+#define ROW(b) classify(b + 0), classify(b + 1), classify(b + 2), classify(b + 3), \
+               classify(b + 4), classify(b + 5), classify(b + 6), classify(b + 7)
+    ROW(0),   ROW(8),   ROW(16),  ROW(24),  ROW(32),  ROW(40),  ROW(48),  ROW(56),
+    ROW(64),  ROW(72),  ROW(80),  ROW(88),  ROW(96),  ROW(104), ROW(112), ROW(120),
+    ROW(128), ROW(136), ROW(144), ROW(152), ROW(160), ROW(168), ROW(176), ROW(184),
+    ROW(192), ROW(200), ROW(208), ROW(216), ROW(224), ROW(232), ROW(240), ROW(248),
+#undef ROW
+};
+
+namespace {
+
+//==========================
+// 标量实现（同时用于 SIMD 版本的尾部处理）
+//==========================
+
+size_t skipClassScalar(const char *s, size_t pos, size_t end, uint8_t cls) {
+    while (pos < end && (CHAR_CLASS[static_cast<unsigned char>(s[pos])] & cls))
+        pos++;
+    return pos;
+}
+
+size_t skipSpaceScalar(const char *s, size_t pos, size_t end) {
+    return skipClassScalar(s, pos, end, CC_SPACE);
+}
+
+size_t skipIdentScalar(const char *s, size_t pos, size_t end) {
+    return skipClassScalar(s, pos, end, CC_ID_CONT);
+}
+
+size_t skipDigitsScalar(const char *s, size_t pos, size_t end) {
+    return skipClassScalar(s, pos, end, CC_DIGIT);
+}
+
+size_t findNewlineScalar(const char *s, size_t pos, size_t end) {
+    while (pos < end && s[pos] != '\n')
+        pos++;
+    return pos;
+}
+
+size_t findBlockEndScalar(const char *s, size_t pos, size_t end) {
+    while (pos + 1 < end && !(s[pos] == '*' && s[pos + 1] == '/'))
+        pos++;
+    return pos + 1 < end ? pos : end;
+}
+
+#ifdef SCANNER_X86
+
+//==========================
+// SSE2：每次处理 16 字节。有符号比较下 >= 0x80 的字节为负数，
+// 不会落入任何 ASCII 区间，因此与标量表的结果一致。
+//==========================
+
+inline __m128i inRange16(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+inline __m128i spaceMask16(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), inRange16(v, '\t', '\r'));
+}
+
+inline __m128i digitMask16(__m128i v) {
+    return inRange16(v, '0', '9');
+}
+
+inline __m128i identMask16(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    return _mm_or_si128(_mm_or_si128(inRange16(lower, 'a', 'z'), digitMask16(v)),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+}
+
+// 在 [pos, end) 中按 16 字节块查找第一个使 match 掩码为 0（want=false）或 1（want=true）的字节
+template <typename MaskFn>
+inline size_t scan16(const char *s, size_t pos, size_t end, MaskFn mask, bool want, bool &found) {
+    found = false;
+    while (pos + 16 <= end) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + pos));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(mask(v)));
+        if (!want)
+            bits = ~bits & 0xFFFFu;
+        if (bits) {
+            found = true;
+            return pos + __builtin_ctz(bits);
+        }
+        pos += 16;
+    }
+    return pos;
+}
+
+size_t skipSpaceSSE2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan16(s, pos, end, spaceMask16, false, found);
+    return found ? pos : skipSpaceScalar(s, pos, end);
+}
+
+size_t skipIdentSSE2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan16(s, pos, end, identMask16, false, found);
+    return found ? pos : skipIdentScalar(s, pos, end);
+}
+
+size_t skipDigitsSSE2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan16(s, pos, end, digitMask16, false, found);
+    return found ? pos : skipDigitsScalar(s, pos, end);
+}
+
+size_t findNewlineSSE2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan16(s, pos, end, [](__m128i v) { return _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')); }, true, found);
+    return found ? pos : findNewlineScalar(s, pos, end);
+}
+
+size_t findBlockEndSSE2(const char *s, size_t pos, size_t end) {
+    // 同时比较 s[i] == '*' 与 s[i+1] == '/'，因此块需要 17 字节可读
+    while (pos + 17 <= end) {
+        __m128i star = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + pos)),
+                                      _mm_set1_epi8('*'));
+        __m128i slash = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + pos + 1)),
+                                       _mm_set1_epi8('/'));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(star, slash)));
+        if (bits)
+            return pos + __builtin_ctz(bits);
+        pos += 16;
+    }
+    return findBlockEndScalar(s, pos, end);
+}
+
+//==========================
+// AVX2：每次处理 32 字节
+//==========================
+
+#define AVX2_FN __attribute__((target("avx2")))
+
+AVX2_FN inline __m256i inRange32(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+AVX2_FN inline __m256i spaceMask32(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), inRange32(v, '\t', '\r'));
+}
+
+AVX2_FN inline __m256i digitMask32(__m256i v) {
+    return inRange32(v, '0', '9');
+}
+
+AVX2_FN inline __m256i identMask32(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(_mm256_or_si256(inRange32(lower, 'a', 'z'), digitMask32(v)),
+                           _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+}
+
+AVX2_FN inline unsigned load32Mask(const char *p, int kind) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i m;
+    switch (kind) {
+    case 0:  m = spaceMask32(v); break;
+    case 1:  m = identMask32(v); break;
+    case 2:  m = digitMask32(v); break;
+    default: m = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')); break;
+    }
+    return static_cast<unsigned>(_mm256_movemask_epi8(m));
+}
+
+// kind: 0 空白 1 标识符 2 数字 3 换行；前三类跳过匹配字节，换行类查找匹配字节
+AVX2_FN size_t scan32(const char *s, size_t pos, size_t end, int kind, bool &found) {
+    found = false;
+    while (pos + 32 <= end) {
+        unsigned bits = load32Mask(s + pos, kind);
+        if (kind != 3)
+            bits = ~bits;
+        if (bits) {
+            found = true;
+            return pos + __builtin_ctz(bits);
+        }
+        pos += 32;
+    }
+    return pos;
+}
+
+AVX2_FN size_t skipSpaceAVX2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan32(s, pos, end, 0, found);
+    return found ? pos : skipSpaceSSE2(s, pos, end);
+}
+
+AVX2_FN size_t skipIdentAVX2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan32(s, pos, end, 1, found);
+    return found ? pos : skipIdentSSE2(s, pos, end);
+}
+
+AVX2_FN size_t skipDigitsAVX2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan32(s, pos, end, 2, found);
+    return found ? pos : skipDigitsSSE2(s, pos, end);
+}
+
+AVX2_FN size_t findNewlineAVX2(const char *s, size_t pos, size_t end) {
+    bool found;
+    pos = scan32(s, pos, end, 3, found);
+    return found ? pos : findNewlineSSE2(s, pos, end);
+}
+
+AVX2_FN size_t findBlockEndAVX2(const char *s, size_t pos, size_t end) {
+    while (pos + 33 <= end) {
+        __m256i star = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + pos)),
+                                          _mm256_set1_epi8('*'));
+        __m256i slash = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + pos + 1)),
+                                           _mm256_set1_epi8('/'));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(star, slash)));
+        if (bits)
+            return pos + __builtin_ctz(bits);
+        pos += 32;
+    }
+    return findBlockEndSSE2(s, pos, end);
+}
+
+#endif // SCANNER_X86
+
+//==========================
+// 运行时分派
+//==========================
+
+struct Kernels {
+    Level level;
+    size_t (*skipSpace)(const char *, size_t, size_t);
+    size_t (*skipIdent)(const char *, size_t, size_t);
+    size_t (*skipDigits)(const char *, size_t, size_t);
+    size_t (*findNewline)(const char *, size_t, size_t);
+    size_t (*findBlockEnd)(const char *, size_t, size_t);
+};
+
+const Kernels SCALAR_KERNELS = {Level::Scalar, skipSpaceScalar, skipIdentScalar, skipDigitsScalar,
+                                findNewlineScalar, findBlockEndScalar};
+#ifdef SCANNER_X86
+const Kernels SSE2_KERNELS = {Level::SSE2, skipSpaceSSE2, skipIdentSSE2, skipDigitsSSE2,
+                              findNewlineSSE2, findBlockEndSSE2};
+const Kernels AVX2_KERNELS = {Level::AVX2, skipSpaceAVX2, skipIdentAVX2, skipDigitsAVX2,
+                              findNewlineAVX2, findBlockEndAVX2};
+#endif
+
+Level bestLevel() {
+#ifdef SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Level::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return Level::SSE2;
+#endif
+    return Level::Scalar;
+}
+
+const Kernels *kernelsFor(Level level) {
+#ifdef SCANNER_X86
+    Level best = bestLevel();
+    if (level > best)
+        level = best;
+    if (level == Level::AVX2)
+        return &AVX2_KERNELS;
+    if (level == Level::SSE2)
+        return &SSE2_KERNELS;
+#endif
+    (void)level;
+    return &SCALAR_KERNELS;
+}
+
+const Kernels *active = kernelsFor(Level::AVX2);
+
+} // namespace
+
+Level activeLevel() { return active->level; }
+
+void setLevel(Level level) { active = kernelsFor(level); }
+
+const char *levelName(Level level) {
+    switch (level) {
+    case Level::AVX2: return "avx2";
+    case Level::SSE2: return "sse2";
+    default:          return "scalar";
+    }
+}
+
+size_t skipSpace(const char *s, size_t pos, size_t end) { return active->skipSpace(s, pos, end); }
+size_t skipIdent(const char *s, size_t pos, size_t end) { return active->skipIdent(s, pos, end); }
+size_t skipDigits(const char *s, size_t pos, size_t end) { return active->skipDigits(s, pos, end); }
+size_t findNewline(const char *s, size_t pos, size_t end) { return active->findNewline(s, pos, end); }
+size_t findBlockEnd(const char *s, size_t pos, size_t end) { return active->findBlockEnd(s, pos, end); }
+
+} // namespace scanner
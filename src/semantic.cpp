@@ -0,0 +1,275 @@
+#include "../include/semantic.h"
+#include <algorithm>
+
+namespace {
+
+bool isInteger(std::string_view text) {
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+bool isBoolConstant(std::string_view text) {
+    return text == "true" || text == "false";
+}
+
+std::string nameOf(Symbol name) {
+    return std::string(name.str());
+}
+
+} // namespace
+
+void SemanticAnalyzer::report(const ASTNode *node, std::string message) {
+    size_t offset = node == item ? base : base + node->offset;
+    diags.push_back({offset, "语义错误: " + message});
+}
+
+// 函数先于全局变量登记，名字冲突报告在后登记的一方
+void SemanticAnalyzer::declare(const ASTNode *node, Symbol name, Binding binding, Type type) {
+    Entry &entry = table[name.id()];
+    if (binding == Binding::Param) {
+        if (entry.binding == Binding::Param) {
+            report(node, "函数参数 " + nameOf(name) + " 重复");
+            return;
+        }
+        undo.push_back({name.id(), entry});
+    } else if (entry.binding == Binding::Function) {
+        report(node, (binding == Binding::Function ? "重复定义的函数 " : "变量与函数同名: ") + nameOf(name));
+        return;
+    } else if (entry.binding == Binding::Global) {
+        report(node, "重复声明的变量 " + nameOf(name));
+        return;
+    }
+    entry = {binding, type};
+}
+
+// 变量的类型。未声明的名字只在（源码中）第一次出现时报告，之后按已报告处理；
+// 未声明的 true / false 作为常量只能读取，不能赋值、read 或 write
+SemanticAnalyzer::Type SemanticAnalyzer::lookup(const ASTNode *node, Symbol name, bool variable) {
+    Entry &entry = table[name.id()];
+    switch (entry.binding) {
+    case Binding::Global:
+    case Binding::Param:
+        return entry.type;
+    case Binding::Function:
+        report(node, "函数名 " + nameOf(name) + " 不能作为变量使用");
+        return Type::Error;
+    case Binding::Undeclared:
+        return Type::Error;
+    case Binding::None:
+        break;
+    }
+    if (isBoolConstant(name.str())) {
+        if (!variable)
+            return Type::Bool;
+        report(node, "常量 " + nameOf(name) + " 不能作为变量使用");
+        return Type::Error;
+    }
+    report(node, "未声明的变量 " + nameOf(name));
+    entry.binding = Binding::Undeclared;
+    return Type::Error;
+}
+
+SemanticAnalyzer::Type SemanticAnalyzer::leafType(const ExprNode *node) {
+    if (node->kind == NodeKind::Identifier)
+        return lookup(node, static_cast<const IdentifierExprNode *>(node)->name, false);
+    std::string_view text = static_cast<const LiteralExprNode *>(node)->value.str();
+    if (isInteger(text))
+        return Type::Int;
+    report(node, "不支持的浮点常量 " + std::string(text));
+    return Type::Error;
+}
+
+// 运算结果的类型只由运算符决定；操作数已经出错时不再报告，外层照常检查
+SemanticAnalyzer::Type SemanticAnalyzer::binaryType(const BinaryExprNode *node, Type left, Type right) {
+    BinaryOp op = node->op;
+    bool known = left != Type::Error && right != Type::Error;
+    switch (op) {
+    case BinaryOp::Add:
+    case BinaryOp::Sub:
+    case BinaryOp::Mul:
+    case BinaryOp::Div:
+        if (known && (left != Type::Int || right != Type::Int))
+            report(node, std::string("算术运算 '") + opName(op) + "' 的操作数必须是 int");
+        return Type::Int;
+    case BinaryOp::Lt:
+    case BinaryOp::Le:
+    case BinaryOp::Gt:
+    case BinaryOp::Ge:
+        if (known && (left != Type::Int || right != Type::Int))
+            report(node, std::string("比较运算 '") + opName(op) + "' 的操作数必须是 int");
+        return Type::Bool;
+    case BinaryOp::Eq:
+    case BinaryOp::Ne:
+        if (known && left != right)
+            report(node, std::string("'") + opName(op) + "' 两侧的类型不同");
+        return Type::Bool;
+    case BinaryOp::Not:
+        if (right == Type::Int)
+            report(node, "'!' 的操作数必须是 bool");
+        return Type::Bool;
+    case BinaryOp::And:
+    case BinaryOp::Or:
+        if (left == Type::Int || right == Type::Int)
+            report(node, std::string("逻辑运算 '") + opName(op) + "' 的操作数必须是 bool");
+        return Type::Bool;
+    default:
+        // 赋值只出现在表达式语句的最外层
+        report(node, "赋值不能出现在表达式中");
+        return Type::Error;
+    }
+}
+
+SemanticAnalyzer::Type SemanticAnalyzer::typeOf(const ExprNode *expr) {
+    if (expr->kind != NodeKind::BinaryExpr)
+        return leafType(expr);
+    size_t valueBase = types.size();
+    exprs.push_back({expr, false});
+    while (!exprs.empty()) {
+        ExprTask &task = exprs.back();
+        if (task.node->kind != NodeKind::BinaryExpr) {
+            types.push_back(leafType(task.node));
+            exprs.pop_back();
+            continue;
+        }
+        auto *binary = static_cast<const BinaryExprNode *>(task.node);
+        if (!task.visited) {
+            task.visited = true;
+            exprs.push_back({binary->right, false});
+            if (binary->left)
+                exprs.push_back({binary->left, false});
+            continue;
+        }
+        exprs.pop_back();
+        if (!binary->left) {
+            // 逻辑非：只有右操作数
+            types.back() = binaryType(binary, Type::Bool, types.back());
+            continue;
+        }
+        Type right = types.back();
+        types.pop_back();
+        types.back() = binaryType(binary, types.back(), right);
+    }
+    Type type = types.back();
+    types.resize(valueBase);
+    return type;
+}
+
+void SemanticAnalyzer::checkStmt(const ASTNode *root) {
+    stmts.push_back(root);
+    while (!stmts.empty()) {
+        const ASTNode *node = stmts.back();
+        stmts.pop_back();
+        switch (node->kind) {
+        case NodeKind::ExprStmt: {
+            auto *assign = static_cast<const BinaryExprNode *>(static_cast<const ExprStmtNode *>(node)->expr);
+            auto *target = static_cast<const IdentifierExprNode *>(assign->left);
+            Type to = lookup(target, target->name, true);
+            Type value = typeOf(assign->right);
+            bool boolAssign = assign->op == BinaryOp::BoolAssign;
+            Type expected = boolAssign ? Type::Bool : Type::Int;
+            if (to != Type::Error && to != expected)
+                report(assign, (boolAssign ? "int 变量 " : "bool 变量 ") + nameOf(target->name) + " 应使用 '" +
+                                   (boolAssign ? "=" : ":=") + "' 赋值");
+            else if (value != Type::Error && value != expected)
+                report(assign, boolAssign ? "':=' 的右侧必须是 bool 表达式" : "'=' 的右侧必须是 int 表达式");
+            break;
+        }
+        case NodeKind::IfStmt: {
+            auto *stmt = static_cast<const IfStmtNode *>(node);
+            Type condition = typeOf(stmt->condition);
+            if (condition == Type::Int)
+                report(stmt->condition, "if 的条件必须是 bool");
+            if (stmt->elseStmt)
+                stmts.push_back(stmt->elseStmt);
+            stmts.push_back(stmt->thenStmt);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto *stmt = static_cast<const WhileStmtNode *>(node);
+            Type condition = typeOf(stmt->condition);
+            if (condition == Type::Int)
+                report(stmt->condition, "while 的条件必须是 bool");
+            stmts.push_back(stmt->body);
+            break;
+        }
+        case NodeKind::BlockStmt: {
+            const auto &children = static_cast<const BlockStmtNode *>(node)->stmts;
+            for (size_t i = children.size(); i-- > 0;)
+                stmts.push_back(children[i]);
+            break;
+        }
+        case NodeKind::ReadStmt:
+            lookup(node, static_cast<const ReadStmtNode *>(node)->varName, true);
+            break;
+        case NodeKind::WriteStmt:
+            lookup(node, static_cast<const WriteStmtNode *>(node)->varName, true);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// 参数只在函数体内可见，函数体检查完后恢复被遮蔽的绑定
+void SemanticAnalyzer::checkFunction(const FuncDefNode *func) {
+    size_t mark = undo.size();
+    for (const Parameter &param : func->params) {
+        declare(func, param.name, Binding::Param, param.type == ValueType::Int ? Type::Int : Type::Bool);
+        std::string_view value = param.defaultVal.str();
+        if (param.defaultVal.empty())
+            continue;
+        if (!isInteger(value))
+            report(func, "参数 " + nameOf(param.name) + " 的默认值不能是浮点数 " + std::string(value));
+        else if (param.type == ValueType::Bool && value != "0" && value != "1")
+            report(func, "bool 参数 " + nameOf(param.name) + " 的默认值只能是 0 或 1");
+    }
+    checkStmt(func->body);
+    while (undo.size() > mark) {
+        table[undo.back().first] = undo.back().second;
+        undo.pop_back();
+    }
+}
+
+void SemanticAnalyzer::enterItem(const ASTNode *root) {
+    item = root;
+    base = root->offset;
+}
+
+bool SemanticAnalyzer::analyze(const ProgramNode &program) {
+    diags.clear();
+    table.assign(program.symbolCount + 1, Entry());
+    undo.clear();
+    stmts.clear();
+    exprs.clear();
+    types.clear();
+
+    // 函数与全局变量在整个程序中可见，先全部登记
+    for (const FuncDefNode *func : program.functions) {
+        enterItem(func);
+        declare(func, func->name, Binding::Function, Type::Error);
+    }
+    for (const ASTNode *node : program.decls) {
+        if (node->kind != NodeKind::Decl)
+            continue;
+        enterItem(node);
+        auto *decl = static_cast<const DeclNode *>(node);
+        Type type = decl->type == ValueType::Int ? Type::Int : Type::Bool;
+        for (Symbol name : decl->names)
+            declare(decl, name, Binding::Global, type);
+    }
+    // 全局语句与函数体按源码顺序交替检查，两个列表各自已按源码顺序排列
+    size_t f = 0, s = 0;
+    while (f < program.functions.size() || s < program.stmts.size()) {
+        if (s == program.stmts.size() ||
+            (f < program.functions.size() && program.functions[f]->offset < program.stmts[s]->offset)) {
+            enterItem(program.functions[f]);
+            checkFunction(program.functions[f++]);
+        } else {
+            enterItem(program.stmts[s]);
+            checkStmt(program.stmts[s++]);
+        }
+    }
+    item = nullptr;
+    std::stable_sort(diags.begin(), diags.end(),
+                     [](const Diagnostic &a, const Diagnostic &b) { return a.offset < b.offset; });
+    return diags.empty();
+}
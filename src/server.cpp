@@ -0,0 +1,437 @@
+#include "../include/server.h"
+#include "../include/ast_writer.h"
+#include "../include/parser.h"
+#include "../include/source_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// 请求头部的长度上限；FILE 的路径也在头部中
+constexpr size_t MAX_HEADER = 4096;
+// PARSE 请求源码的长度上限，超出时回复 ERR 并结束连接
+constexpr size_t MAX_SOURCE = 256 << 20;
+
+// 连接上的带缓冲读取
+class Reader {
+public:
+    explicit Reader(int fd) : fd(fd) {}
+
+    // 读一行（不含 '\n'）；连接关闭、出错或超过 MAX_HEADER 时返回 false
+    bool readLine(std::string &line) {
+        line.clear();
+        while (true) {
+            const char *newline = static_cast<const char *>(memchr(buf + begin, '\n', end - begin));
+            size_t n = newline ? newline - (buf + begin) : end - begin;
+            line.append(buf + begin, n);
+            if (line.size() > MAX_HEADER)
+                return false;
+            if (newline) {
+                begin += n + 1;
+                return true;
+            }
+            begin = end;
+            if (!fill())
+                return false;
+        }
+    }
+
+    // 读恰好 n 个字节到 out（覆盖原内容）。out 随数据到达逐块增长，
+    // 声称很长却提前断开的请求不会先占用 n 字节
+    bool readExact(std::string &out, size_t n) {
+        out.clear();
+        while (out.size() < n) {
+            if (begin == end && !fill())
+                return false;
+            size_t used = std::min(n - out.size(), end - begin);
+            out.append(buf + begin, used);
+            begin += used;
+        }
+        return true;
+    }
+
+    // 读缓冲中是否还有未处理的数据（客户端连续发送的下一个请求）
+    bool buffered() const { return begin < end; }
+
+private:
+    int fd;
+    char buf[64 * 1024];
+    size_t begin = 0, end = 0;
+
+    bool fill() {
+        while (true) {
+            ssize_t got = ::read(fd, buf, sizeof(buf));
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                return false;
+            begin = 0;
+            end = got;
+            return true;
+        }
+    }
+};
+
+bool sendResponse(int fd, const char *status, std::string_view body) {
+    char header[64];
+    int headerSize = snprintf(header, sizeof(header), "%s %zu\n", status, body.size());
+    struct iovec parts[2] = {{header, static_cast<size_t>(headerSize)},
+                             {const_cast<char *>(body.data()), body.size()}};
+    int count = body.empty() ? 1 : 2;
+    struct iovec *iov = parts;
+    while (count > 0) {
+        ssize_t n = ::writev(fd, iov, count);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        // 跳过已写出的部分
+        while (count > 0 && static_cast<size_t>(n) >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+// 每个工作线程的分析状态，跨连接、跨请求复用：Arena 的块、驻留表与 Parser 的暂存区
+// 只在第一次遇到更大的输入时增长
+struct Worker {
+    Lexer lexer;
+    Parser parser{lexer};
+    Arena arena;
+    OutputBuffer out;
+    ASTWriter writer{out};
+    SourceFile file;
+    std::string source;     // PARSE 请求的源码
+    std::string payload;    // 响应内容
+};
+
+} // namespace
+
+AnalyzerServer::AnalyzerServer(size_t workers)
+    : pool(workers), started(std::chrono::steady_clock::now()) {}
+
+AnalyzerServer::~AnalyzerServer() {
+    shutdown();
+    pool.wait();
+}
+
+void AnalyzerServer::recordLatency(uint64_t ns) {
+    size_t bucket = 0;
+    if (ns >= 4) {
+        unsigned exp = 63 - __builtin_clzll(ns);
+        bucket = exp * 4 + ((ns >> (exp - 2)) & 3);
+    } else {
+        bucket = ns;
+    }
+    latency[std::min(bucket, LATENCY_BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// 返回分位数所在档的上界（纳秒）
+uint64_t AnalyzerServer::latencyPercentile(double p) const {
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+        total += counts[i] = latency[i].load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * total + 0.999999));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            if (i < 4)
+                return i + 1;
+            unsigned exp = i / 4;
+            return static_cast<uint64_t>(4 + i % 4 + 1) << (exp - 2);
+        }
+    }
+    return 0;
+}
+
+std::string AnalyzerServer::statsJson() const {
+    double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    char text[512];
+    snprintf(text, sizeof(text),
+             "{\"requests\": %llu, \"ok\": %llu, \"syntax_errors\": %llu, \"failed\": %llu, \"bytes\": %llu, "
+             "\"connections\": %llu, \"workers\": %zu, \"uptime_seconds\": %.3f, "
+             "\"latency_us\": {\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}}\n",
+             static_cast<unsigned long long>(requests.load()), static_cast<unsigned long long>(succeeded.load()),
+             static_cast<unsigned long long>(syntaxErrors.load()), static_cast<unsigned long long>(failed.load()),
+             static_cast<unsigned long long>(bytesIn.load()), static_cast<unsigned long long>(connections.load()),
+             pool.size(), uptime, latencyPercentile(0.5) / 1e3, latencyPercentile(0.9) / 1e3,
+             latencyPercentile(0.99) / 1e3, latencyPercentile(1.0) / 1e3);
+    return text;
+}
+
+// 一个连接：读缓冲跨请求保留。监听模式下等待下一个请求时由 listen 的 poll 统一监视，不占用工作线程
+struct AnalyzerServer::Connection {
+    Connection(int inFd, int outFd) : fd(inFd), outFd(outFd), reader(inFd) {}
+    int fd;
+    int outFd;
+    Reader reader;
+};
+
+void AnalyzerServer::serveConnection(int inFd, int outFd) {
+    connections.fetch_add(1, std::memory_order_relaxed);
+    auto connection = std::make_unique<Connection>(inFd, outFd);
+    while (!stopping.load() && serveRequest(*connection)) {
+    }
+}
+
+// 读取并处理连接上的一个请求，返回 false 表示连接应当结束
+bool AnalyzerServer::serveRequest(Connection &connection) {
+    thread_local Worker worker;
+    // 映射的文件不跨请求保留
+    struct CloseFile {
+        SourceFile &file;
+        ~CloseFile() { file.close(); }
+    } closeFile{worker.file};
+    int outFd = connection.outFd;
+    // 处理请求时的异常（如内存不足）只结束这一个连接，不终止服务进程
+    try {
+        std::string line;
+        if (!connection.reader.readLine(line))
+            return false;
+        auto start = std::chrono::steady_clock::now();
+        size_t space = line.find(' ');
+        std::string_view command = std::string_view(line).substr(0, space);
+        std::string_view rest = space == std::string::npos ? std::string_view() : std::string_view(line).substr(space + 1);
+
+        if (command == "STATS") {
+            return sendResponse(outFd, "OK", statsJson());
+        }
+        if (command == "SHUTDOWN") {
+            sendResponse(outFd, "OK", {});
+            shutdown();
+            return false;
+        }
+        requests.fetch_add(1, std::memory_order_relaxed);
+        if (command != "PARSE" && command != "FILE") {
+            failed.fetch_add(1, std::memory_order_relaxed);
+            return sendResponse(outFd, "ERR", "未知命令: " + std::string(command));
+        }
+
+        size_t argSpace = rest.find(' ');
+        OutputFormat format;
+        std::string_view argument = argSpace == std::string_view::npos ? std::string_view() : rest.substr(argSpace + 1);
+        bool formatOk = parseOutputFormat(rest.substr(0, argSpace), format);
+        std::string_view source;
+        std::string problem;
+        if (command == "PARSE") {
+            char *end = nullptr;
+            std::string sizeText(argument);
+            unsigned long long size = strtoull(sizeText.c_str(), &end, 10);
+            if (sizeText.empty() || *end != '\0') {
+                // 长度不明时无法找到下一个请求的起点，只能结束连接
+                failed.fetch_add(1, std::memory_order_relaxed);
+                sendResponse(outFd, "ERR", "PARSE 请求缺少源码字节数");
+                return false;
+            }
+            if (size > MAX_SOURCE) {
+                failed.fetch_add(1, std::memory_order_relaxed);
+                sendResponse(outFd, "ERR", "源码超过 " + std::to_string(MAX_SOURCE >> 20) + "MB 的上限");
+                return false;
+            }
+            if (!connection.reader.readExact(worker.source, size))
+                return false;
+            source = worker.source;
+        } else if (!worker.file.load(std::string(argument))) {
+            problem = "无法读取文件 " + std::string(argument) + ": " + worker.file.error();
+        } else {
+            source = worker.file.view();
+        }
+        if (!formatOk)
+            problem = "未知的输出格式: " + std::string(rest.substr(0, argSpace));
+        if (!problem.empty()) {
+            failed.fetch_add(1, std::memory_order_relaxed);
+            return sendResponse(outFd, "ERR", problem);
+        }
+
+        bytesIn.fetch_add(source.size(), std::memory_order_relaxed);
+        worker.arena.reset();
+        worker.lexer.setSource(source);
+        ProgramNode *ast = worker.parser.parseProgram(worker.arena);
+        worker.payload.clear();
+        worker.out.openString(worker.payload);
+        const char *status = "OK";
+        if (worker.parser.hasErrors()) {
+            worker.writer.writeError(formatDiagnostics(source, worker.parser.diagnostics()), format);
+            status = "DIAG";
+            syntaxErrors.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            worker.writer.write(*ast, format);
+            succeeded.fetch_add(1, std::memory_order_relaxed);
+        }
+        worker.out.close();
+        bool sent = sendResponse(outFd, status, worker.payload);
+        recordLatency(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                          .count());
+        return sent;
+    } catch (const std::exception &e) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        // 不再拼接字符串：内存不足时构造消息本身也会失败
+        sendResponse(outFd, "ERR", e.what());
+        return false;
+    }
+}
+
+// 在线程池中处理 connection 的下一个请求，之后把连接交回 listen 等待，或结束连接
+void AnalyzerServer::dispatch(Connection *connection) {
+    pool.submit([this, connection] {
+        if (stopping.load() || !serveRequest(*connection)) {
+            closeConnection(connection);
+            return;
+        }
+        // 下一个请求已在读缓冲中，poll 不会再报告可读，直接排队处理
+        if (connection->reader.buffered()) {
+            dispatch(connection);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(activeMutex);
+        idle.push_back(connection);
+        if (wakeFd >= 0) {
+            char c = 0;
+            [[maybe_unused]] ssize_t n = ::write(wakeFd, &c, 1);
+        }
+    });
+}
+
+void AnalyzerServer::closeConnection(Connection *connection) {
+    {
+        std::lock_guard<std::mutex> lock(activeMutex);
+        activeFds.erase(std::find(activeFds.begin(), activeFds.end(), connection->fd));
+    }
+    ::close(connection->fd);
+    delete connection;
+}
+
+void AnalyzerServer::listen(const std::string &path) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("套接字路径过长: " + path);
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        throw std::runtime_error(std::string("无法创建套接字: ") + strerror(errno));
+    // 只替换遗留的套接字文件，不误删同名的普通文件或目录
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            ::close(fd);
+            throw std::runtime_error("无法监听 " + path + ": 路径已存在且不是套接字");
+        }
+        ::unlink(path.c_str());
+    }
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(fd, 128) != 0) {
+        std::string reason = strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("无法监听 " + path + ": " + reason);
+    }
+    int wake[2];
+    if (::pipe2(wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+        std::string reason = strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("无法监听 " + path + ": " + reason);
+    }
+    listenFd.store(fd);
+    {
+        std::lock_guard<std::mutex> lock(activeMutex);
+        wakeFd = wake[1];
+    }
+    // 等待下一个请求的连接。可读（或对端关闭）的连接移出等待集合，交给线程池处理一个请求，
+    // 处理完经 idle 交回；shutdown 与交回连接都写 wake 管道唤醒 poll
+    std::vector<Connection *> waiting;
+    std::vector<struct pollfd> fds;
+    // 检查 stopping 之前已登记 wakeFd，之后的 shutdown 一定能让 poll 返回
+    while (!stopping.load()) {
+        {
+            std::lock_guard<std::mutex> lock(activeMutex);
+            waiting.insert(waiting.end(), idle.begin(), idle.end());
+            idle.clear();
+        }
+        fds.assign({{wake[0], POLLIN, 0}, {fd, POLLIN, 0}});
+        for (Connection *connection : waiting)
+            fds.push_back({connection->fd, POLLIN, 0});
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[0].revents) {
+            char drain[256];
+            while (::read(wake[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < waiting.size(); i++) {
+            if (fds[i + 2].revents)
+                dispatch(waiting[i]);
+            else
+                waiting[kept++] = waiting[i];
+        }
+        waiting.resize(kept);
+        if (fds[1].revents && !stopping.load()) {
+            int client = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN)
+                    continue;
+                break;
+            }
+            connections.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(activeMutex);
+                activeFds.push_back(client);
+            }
+            waiting.push_back(new Connection(client, client));
+        }
+    }
+    // 处理完正在进行的请求，再关闭所有连接
+    pool.wait();
+    {
+        std::lock_guard<std::mutex> lock(activeMutex);
+        waiting.insert(waiting.end(), idle.begin(), idle.end());
+        idle.clear();
+        wakeFd = -1;
+    }
+    for (Connection *connection : waiting)
+        closeConnection(connection);
+    ::close(wake[0]);
+    ::close(wake[1]);
+    listenFd.store(-1);
+    ::close(fd);
+    ::unlink(path.c_str());
+}
+
+void AnalyzerServer::shutdown() {
+    stopping.store(true);
+    int fd = listenFd.load();
+    if (fd >= 0)
+        ::shutdown(fd, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(activeMutex);
+    for (int client : activeFds)
+        ::shutdown(client, SHUT_RD);
+    if (wakeFd >= 0) {
+        char c = 0;
+        [[maybe_unused]] ssize_t n = ::write(wakeFd, &c, 1);
+    }
+}
@@ -0,0 +1,85 @@
+#include "../include/source_file.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceFile::~SourceFile() {
+    close();
+}
+
+void SourceFile::close() {
+    if (mapping)
+        munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    buffer.clear();
+    data = {};
+}
+
+bool SourceFile::load(const std::string &path) {
+    close();
+    lastError.clear();
+    if (path == "-")
+        return readAll(STDIN_FILENO);
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        lastError = strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        lastError = strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    bool ok;
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+            mapping = p;
+            mappingSize = st.st_size;
+            data = std::string_view(static_cast<const char *>(p), mappingSize);
+            ok = true;
+        } else {
+            // 某些文件系统不支持 mmap，退化为读入
+            ok = readAll(fd);
+        }
+    } else {
+        // 空文件无法映射；管道、字符设备等大小未知，一次性读入
+        ok = readAll(fd);
+    }
+    ::close(fd);
+    return ok;
+}
+
+bool SourceFile::readAll(int fd) {
+    struct stat st;
+    size_t capacity = 64 * 1024;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        capacity = st.st_size + 1;  // 多留一个字节，以便读到 EOF 时不必再扩容
+    buffer.resize(capacity);
+    size_t used = 0;
+    while (true) {
+        if (used == buffer.size())
+            buffer.resize(buffer.size() * 2);
+        ssize_t n = ::read(fd, &buffer[used], buffer.size() - used);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            lastError = strerror(errno);
+            buffer.clear();
+            return false;
+        }
+        if (n == 0)
+            break;
+        used += n;
+    }
+    buffer.resize(used);
+    data = buffer;
+    return true;
+}
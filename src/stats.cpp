@@ -0,0 +1,314 @@
+#include "../include/stats.h"
+#include "../include/ast_writer.h"
+#include "../include/parse_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sys/resource.h>
+
+const char *nodeKindName(NodeKind kind) {
+    static const char *const NAMES[NODE_KIND_COUNT] = {
+        "Literal", "Identifier", "BinaryExpr", "ExprStmt", "IfStmt", "WhileStmt",
+        "BlockStmt", "ReadStmt", "WriteStmt", "Decl", "FuncDef", "Program",
+    };
+    return NAMES[static_cast<size_t>(kind)];
+}
+
+uint64_t ASTShape::nodes() const {
+    uint64_t total = 0;
+    for (uint64_t count : counts)
+        total += count;
+    return total;
+}
+
+ASTShape measureAST(const ProgramNode &program) {
+    ASTShape shape;
+    std::vector<std::pair<const ASTNode *, uint32_t>> stack;
+    stack.push_back({&program, 1});
+    auto push = [&](const ASTNode *node, uint32_t depth) {
+        if (node)
+            stack.push_back({node, depth});
+    };
+    while (!stack.empty()) {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        shape.counts[static_cast<size_t>(node->kind)]++;
+        shape.maxDepth = std::max(shape.maxDepth, depth);
+        switch (node->kind) {
+        case NodeKind::BinaryExpr: {
+            auto *expr = static_cast<const BinaryExprNode *>(node);
+            push(expr->left, depth + 1);
+            push(expr->right, depth + 1);
+            break;
+        }
+        case NodeKind::ExprStmt:
+            push(static_cast<const ExprStmtNode *>(node)->expr, depth + 1);
+            break;
+        case NodeKind::IfStmt: {
+            auto *stmt = static_cast<const IfStmtNode *>(node);
+            push(stmt->condition, depth + 1);
+            push(stmt->thenStmt, depth + 1);
+            push(stmt->elseStmt, depth + 1);
+            break;
+        }
+        case NodeKind::WhileStmt: {
+            auto *stmt = static_cast<const WhileStmtNode *>(node);
+            push(stmt->condition, depth + 1);
+            push(stmt->body, depth + 1);
+            break;
+        }
+        case NodeKind::BlockStmt:
+            for (const StmtNode *stmt : static_cast<const BlockStmtNode *>(node)->stmts)
+                push(stmt, depth + 1);
+            break;
+        case NodeKind::FuncDef:
+            push(static_cast<const FuncDefNode *>(node)->body, depth + 1);
+            break;
+        case NodeKind::Program: {
+            auto *root = static_cast<const ProgramNode *>(node);
+            for (const FuncDefNode *func : root->functions)
+                push(func, depth + 1);
+            for (const ASTNode *decl : root->decls)
+                push(decl, depth + 1);
+            for (const ASTNode *stmt : root->stmts)
+                push(stmt, depth + 1);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return shape;
+}
+
+uint64_t peakRssBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;    // Linux 上以 KB 为单位
+}
+
+namespace {
+
+// 报告写入器：在 OutputBuffer 上拼 JSON，数字统一用 printf 格式化
+class JsonOut {
+public:
+    explicit JsonOut(OutputBuffer &out) : out(out) {}
+
+    void raw(std::string_view s) { out.append(s); }
+    void string(std::string_view s) { writeJsonString(out, s); }
+    void number(uint64_t value) { format("%llu", static_cast<unsigned long long>(value)); }
+    void real(double value) { format("%.6f", value); }
+    void key(const char *name) {
+        string(name);
+        out.append(": ", 2);
+    }
+
+private:
+    OutputBuffer &out;
+
+    template <typename T>
+    void format(const char *fmt, T value) {
+        char text[32];
+        int n = snprintf(text, sizeof(text), fmt, value);
+        out.append(text, static_cast<size_t>(n));
+    }
+};
+
+void writeKinds(JsonOut &json, const ASTShape &shape) {
+    json.raw("{");
+    for (size_t k = 0; k < NODE_KIND_COUNT; k++) {
+        if (k)
+            json.raw(", ");
+        json.key(nodeKindName(static_cast<NodeKind>(k)));
+        json.number(shape.counts[k]);
+    }
+    json.raw("}");
+}
+
+// 最近秩法：第 ceil(p * n) 小的值
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+} // namespace
+
+bool writeStatsReport(const std::string &path, const std::vector<FileStats> &files, size_t jobs,
+                      double wallSeconds) {
+    OutputBuffer out;
+    if (!out.open(path))
+        return false;
+    JsonOut json(out);
+
+    FileStats total;
+    uint64_t succeeded = 0, cached = 0;
+    for (const FileStats &file : files) {
+        total.bytes += file.bytes;
+        total.readSeconds += file.readSeconds;
+        total.lexSeconds += file.lexSeconds;
+        total.parseSeconds += file.parseSeconds;
+        total.checkSeconds += file.checkSeconds;
+        total.writeSeconds += file.writeSeconds;
+        total.tokens += file.tokens;
+        for (size_t k = 0; k < NODE_KIND_COUNT; k++)
+            total.shape.counts[k] += file.shape.counts[k];
+        total.shape.maxDepth = std::max(total.shape.maxDepth, file.shape.maxDepth);
+        total.arenaBytes += file.arenaBytes;
+        succeeded += file.ok;
+        cached += file.cached;
+    }
+
+    json.raw("{\n  ");
+    json.key("version");
+    json.string(ANALYZER_VERSION);
+    json.raw(",\n  ");
+    json.key("jobs");
+    json.number(jobs);
+    json.raw(",\n  ");
+    json.key("wall_seconds");
+    json.real(wallSeconds);
+    json.raw(",\n  ");
+    json.key("peak_rss_bytes");
+    json.number(peakRssBytes());
+
+    json.raw(",\n  ");
+    json.key("totals");
+    json.raw("{");
+    json.key("files");
+    json.number(files.size());
+    json.raw(", ");
+    json.key("succeeded");
+    json.number(succeeded);
+    json.raw(", ");
+    json.key("cached");
+    json.number(cached);
+    json.raw(", ");
+    json.key("bytes");
+    json.number(total.bytes);
+    json.raw(", ");
+    json.key("tokens");
+    json.number(total.tokens);
+    json.raw(", ");
+    json.key("nodes");
+    json.number(total.shape.nodes());
+    json.raw(", ");
+    json.key("max_depth");
+    json.number(total.shape.maxDepth);
+    json.raw(", ");
+    json.key("arena_bytes");
+    json.number(total.arenaBytes);
+    json.raw(",\n    ");
+    json.key("read_seconds");
+    json.real(total.readSeconds);
+    json.raw(", ");
+    json.key("lex_seconds");
+    json.real(total.lexSeconds);
+    json.raw(", ");
+    json.key("parse_seconds");
+    json.real(total.parseSeconds);
+    json.raw(", ");
+    json.key("check_seconds");
+    json.real(total.checkSeconds);
+    json.raw(", ");
+    json.key("write_seconds");
+    json.real(total.writeSeconds);
+    json.raw(",\n    ");
+    json.key("nodes_by_kind");
+    writeKinds(json, total.shape);
+    json.raw("}");
+
+    // 各阶段单文件耗时与文件大小的分布
+    struct Series {
+        const char *name;
+        double (*value)(const FileStats &);
+    } series[] = {
+        {"read_seconds", [](const FileStats &f) { return f.readSeconds; }},
+        {"lex_seconds", [](const FileStats &f) { return f.lexSeconds; }},
+        {"parse_seconds", [](const FileStats &f) { return f.parseSeconds; }},
+        {"check_seconds", [](const FileStats &f) { return f.checkSeconds; }},
+        {"write_seconds", [](const FileStats &f) { return f.writeSeconds; }},
+        {"total_seconds", [](const FileStats &f) { return f.totalSeconds(); }},
+        {"bytes", [](const FileStats &f) { return static_cast<double>(f.bytes); }},
+    };
+    json.raw(",\n  ");
+    json.key("percentiles");
+    json.raw("{");
+    std::vector<double> values;
+    for (size_t s = 0; s < sizeof(series) / sizeof(series[0]); s++) {
+        values.clear();
+        for (const FileStats &file : files)
+            values.push_back(series[s].value(file));
+        std::sort(values.begin(), values.end());
+        json.raw(s ? ",\n    " : "\n    ");
+        json.key(series[s].name);
+        const double points[] = {0.5, 0.9, 0.99, 1.0};
+        const char *const labels[] = {"p50", "p90", "p99", "max"};
+        json.raw("{");
+        for (size_t p = 0; p < 4; p++) {
+            if (p)
+                json.raw(", ");
+            json.key(labels[p]);
+            json.real(percentile(values, points[p]));
+        }
+        json.raw("}");
+    }
+    json.raw("}");
+
+    json.raw(",\n  ");
+    json.key("files");
+    json.raw("[");
+    for (size_t i = 0; i < files.size(); i++) {
+        const FileStats &file = files[i];
+        json.raw(i ? ",\n    {" : "\n    {");
+        json.key("name");
+        json.string(file.name);
+        json.raw(", ");
+        json.key("ok");
+        json.raw(file.ok ? "true" : "false");
+        json.raw(", ");
+        json.key("cached");
+        json.raw(file.cached ? "true" : "false");
+        json.raw(", ");
+        json.key("bytes");
+        json.number(file.bytes);
+        json.raw(", ");
+        json.key("read_seconds");
+        json.real(file.readSeconds);
+        json.raw(", ");
+        json.key("lex_seconds");
+        json.real(file.lexSeconds);
+        json.raw(", ");
+        json.key("parse_seconds");
+        json.real(file.parseSeconds);
+        json.raw(", ");
+        json.key("check_seconds");
+        json.real(file.checkSeconds);
+        json.raw(", ");
+        json.key("write_seconds");
+        json.real(file.writeSeconds);
+        json.raw(", ");
+        json.key("tokens");
+        json.number(file.tokens);
+        json.raw(", ");
+        json.key("nodes");
+        json.number(file.shape.nodes());
+        json.raw(", ");
+        json.key("max_depth");
+        json.number(file.shape.maxDepth);
+        json.raw(", ");
+        json.key("arena_bytes");
+        json.number(file.arenaBytes);
+        json.raw(", ");
+        json.key("peak_rss_bytes");
+        json.number(file.peakRss);
+        json.raw(", ");
+        json.key("nodes_by_kind");
+        writeKinds(json, file.shape);
+        json.raw("}");
+    }
+    json.raw(files.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    return out.close();
+}
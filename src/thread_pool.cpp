@@ -0,0 +1,87 @@
+#include "../include/thread_pool.h"
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0)
+        threads = 1;
+    for (size_t i = 0; i < threads; i++)
+        queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threads; i++)
+        workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(Task task) {
+    size_t index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    // 加锁后再通知，避免与工作线程“检查队列 -> 进入等待”之间的竞争丢失唤醒
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    wakeWorkers.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    allDone.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool ThreadPool::popFrom(size_t index, Task &task) {
+    Queue &queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::findTask(size_t self, Task &task) {
+    if (popFrom(self, task))
+        return true;
+    // 自己的队列空了，依次尝试窃取其他线程的任务
+    for (size_t i = 1; i < queues.size(); i++) {
+        if (popFrom((self + i) % queues.size(), task))
+            return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+    Task task;
+    while (true) {
+        if (findTask(self, task)) {
+            task();
+            task = nullptr;
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping)
+            return;
+        // 队列可能在上面的检查之后才被填入；持锁再查一次 pending 里尚未被取走的任务
+        bool queued = false;
+        for (auto &queue : queues) {
+            std::lock_guard<std::mutex> queueLock(queue->mutex);
+            if (!queue->tasks.empty()) {
+                queued = true;
+                break;
+            }
+        }
+        if (!queued)
+            wakeWorkers.wait(lock);
+    }
+}
@@ -0,0 +1,108 @@
+#include "../include/trace.h"
+#include "../include/ast_writer.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+std::atomic<int> trace::currentLevel{0};
+
+namespace {
+
+struct Event {
+    const char *name;
+    uint64_t startNs;
+    uint64_t durationNs;
+    std::string arg;
+};
+
+// 单个线程的事件缓冲区，只由所属线程追加；next 构成全局的无锁单链表
+struct ThreadBuffer {
+    uint32_t tid;
+    std::vector<Event> events;
+    ThreadBuffer *next = nullptr;
+};
+
+std::atomic<ThreadBuffer *> buffers{nullptr};
+std::atomic<uint32_t> nextTid{0};
+std::chrono::steady_clock::time_point origin;
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// 缓冲区在进程结束前不释放，线程退出后其事件仍可写出
+ThreadBuffer &localBuffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        buffer = new ThreadBuffer{nextTid.fetch_add(1, std::memory_order_relaxed), {}, nullptr};
+        buffer->events.reserve(1024);
+        ThreadBuffer *head = buffers.load(std::memory_order_relaxed);
+        do {
+            buffer->next = head;
+        } while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_release,
+                                                std::memory_order_relaxed));
+    }
+    return *buffer;
+}
+
+// 纳秒写成 trace-event 要求的微秒，保留三位小数
+void appendMicros(OutputBuffer &out, uint64_t ns) {
+    char text[32];
+    int n = snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(ns / 1000),
+                     static_cast<unsigned>(ns % 1000));
+    out.append(text, static_cast<size_t>(n));
+}
+
+} // namespace
+
+void trace::start(TraceLevel level) {
+    origin = std::chrono::steady_clock::now();
+    localBuffer();      // 调用线程先登记，得到 tid 0
+    currentLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+bool trace::write(const std::string &path) {
+    OutputBuffer out;
+    if (!out.open(path))
+        return false;
+    out.append("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    out.append("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"parser\"}}");
+    char text[64];
+    for (ThreadBuffer *buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        int n = buffer->tid ? snprintf(text, sizeof(text), "worker %u", buffer->tid)
+                            : snprintf(text, sizeof(text), "main");
+        out.append(",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": ");
+        out.append(std::to_string(buffer->tid));
+        out.append(", \"args\": {\"name\": ");
+        writeJsonString(out, std::string_view(text, static_cast<size_t>(n)));
+        out.append("}}");
+        for (const Event &event : buffer->events) {
+            out.append(",\n{\"name\": ");
+            writeJsonString(out, event.name);
+            out.append(", \"cat\": \"littlec\", \"ph\": \"X\", \"pid\": 1, \"tid\": ");
+            out.append(std::to_string(buffer->tid));
+            out.append(", \"ts\": ");
+            appendMicros(out, event.startNs);
+            out.append(", \"dur\": ");
+            appendMicros(out, event.durationNs);
+            if (!event.arg.empty()) {
+                out.append(", \"args\": {\"name\": ");
+                writeJsonString(out, event.arg);
+                out.put('}');
+            }
+            out.put('}');
+        }
+    }
+    out.append("\n]}\n");
+    return out.close();
+}
+
+void TraceSpan::begin(const char *spanName) {
+    name = spanName;
+    startNs = nowNs();
+}
+
+void TraceSpan::end() {
+    uint64_t endNs = nowNs();
+    localBuffer().events.push_back({name, startNs, endNs - startNs, std::move(arg)});
+}
@@ -0,0 +1,267 @@
+#include "../include/vm.h"
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+namespace {
+
+constexpr size_t INPUT_CHUNK = 64 * 1024;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+} // namespace
+
+const char *vmStatusMessage(VMStatus status) {
+    switch (status) {
+    case VMStatus::Ok:             return "执行完成";
+    case VMStatus::InputExhausted: return "read 时输入已结束";
+    case VMStatus::BadInput:       return "read 读到的不是整数";
+    case VMStatus::DivideByZero:   return "除数为 0";
+    case VMStatus::LoopLimit:      return "循环迭代次数超过上限";
+    }
+    return "未知状态";
+}
+
+//==========================
+// VMInput
+//==========================
+
+void VMInput::reset(std::string_view text) {
+    data = text;
+    pos = 0;
+    fd = -1;
+}
+
+void VMInput::reset(int descriptor) {
+    buffer.clear();
+    data = {};
+    pos = 0;
+    fd = descriptor;
+}
+
+// 丢弃已消费的部分，在未消费的尾部之后再读入一批
+bool VMInput::refill() {
+    if (fd < 0)
+        return false;
+    buffer.erase(0, pos);
+    size_t kept = buffer.size();
+    buffer.resize(kept + INPUT_CHUNK);
+    ssize_t got;
+    do {
+        got = ::read(fd, &buffer[kept], INPUT_CHUNK);
+    } while (got < 0 && errno == EINTR);
+    buffer.resize(kept + (got > 0 ? static_cast<size_t>(got) : 0));
+    data = buffer;
+    pos = 0;
+    return got > 0;
+}
+
+VMStatus VMInput::next(int32_t &value) {
+    while (true) {
+        while (pos < data.size() && isSpace(data[pos]))
+            pos++;
+        if (pos < data.size())
+            break;
+        if (!refill())
+            return VMStatus::InputExhausted;
+    }
+    // 数字可能跨过一批数据的末尾
+    size_t end = pos;
+    while (true) {
+        while (end < data.size() && !isSpace(data[end]))
+            end++;
+        if (end < data.size() || fd < 0)
+            break;
+        size_t length = end - pos;
+        if (!refill())
+            break;
+        end = length;
+    }
+    std::string_view token = data.substr(pos, end - pos);
+    pos = end;
+    bool negative = token[0] == '-';
+    if (negative || token[0] == '+')
+        token.remove_prefix(1);
+    if (token.empty())
+        return VMStatus::BadInput;
+    uint32_t magnitude = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9')
+            return VMStatus::BadInput;
+        magnitude = magnitude * 10 + static_cast<uint32_t>(c - '0');
+    }
+    value = static_cast<int32_t>(negative ? 0u - magnitude : magnitude);
+    return VMStatus::Ok;
+}
+
+//==========================
+// VM
+//==========================
+
+VM::VM(const BytecodeModule &module) : module(module), registers(module.registerCount) {
+    std::copy(module.initialRegisters.begin(), module.initialRegisters.end(), registers.begin());
+}
+
+VMStatus VM::run(VMInput &input, OutputBuffer &output) {
+    std::copy(module.initialRegisters.begin(), module.initialRegisters.end(), registers.begin());
+    return execute(module.mainEntry, input, output);
+}
+
+VMStatus VM::call(size_t index, const std::vector<int32_t> &args, VMInput &input, OutputBuffer &output) {
+    const BytecodeFunction &func = module.functions[index];
+    for (size_t i = 0; i < func.paramTypes.size(); i++) {
+        int32_t value = i < args.size() ? args[i] : func.defaults[i];
+        if (func.paramTypes[i] == ValueType::Bool)
+            value = value != 0;
+        registers[func.paramBase + i] = value;
+    }
+    return execute(func.entry, input, output);
+}
+
+// 每个操作码一段处理代码。computed goto 时每段末尾按下一条指令的操作码直接跳转，
+// 分支预测按跳转位置分别记录；否则每段以 continue 回到 switch
+VMStatus VM::execute(uint32_t entry, VMInput &input, OutputBuffer &output) {
+    const Instruction *const code = module.code.data();
+    const Instruction *ip = code + entry;
+    int32_t *const r = registers.data();
+    const uint64_t limit = loopLimit ? loopLimit : UINT64_MAX;
+    uint64_t ticks = 0;
+    VMStatus status = VMStatus::Ok;
+    int32_t value;
+
+#ifdef VM_COMPUTED_GOTO
+    static const void *const DISPATCH[OPCODE_COUNT] = {
+        &&op_Move, &&op_Add, &&op_Sub, &&op_Mul, &&op_Div,
+        &&op_Eq, &&op_Ne, &&op_Lt, &&op_Le, &&op_Gt, &&op_Ge,
+        &&op_Jump, &&op_JumpIfZero, &&op_JumpIfNonZero,
+        &&op_JumpEq, &&op_JumpNe, &&op_JumpLt, &&op_JumpLe, &&op_JumpGt, &&op_JumpGe,
+        &&op_LoopTick, &&op_ReadInt, &&op_ReadBool, &&op_Write, &&op_Halt,
+    };
+#define VM_OP(name) op_##name:
+#define VM_NEXT() goto *DISPATCH[(++ip)->op]
+#define VM_GOTO(target) do { ip = code + (target); goto *DISPATCH[ip->op]; } while (0)
+    goto *DISPATCH[ip->op];
+#else
+#define VM_OP(name) case Opcode::name:
+#define VM_NEXT() { ++ip; continue; }
+#define VM_GOTO(target) { ip = code + (target); continue; }
+    for (;;) {
+        switch (ip->opcode()) {
+#endif
+
+    VM_OP(Move)
+        r[ip->a] = r[ip->b];
+        VM_NEXT();
+    VM_OP(Add)
+        r[ip->a] = static_cast<int32_t>(static_cast<uint32_t>(r[ip->b]) + static_cast<uint32_t>(r[ip->c]));
+        VM_NEXT();
+    VM_OP(Sub)
+        r[ip->a] = static_cast<int32_t>(static_cast<uint32_t>(r[ip->b]) - static_cast<uint32_t>(r[ip->c]));
+        VM_NEXT();
+    VM_OP(Mul)
+        r[ip->a] = static_cast<int32_t>(static_cast<uint32_t>(r[ip->b]) * static_cast<uint32_t>(r[ip->c]));
+        VM_NEXT();
+    VM_OP(Div)
+        value = r[ip->c];
+        if (value == 0) {
+            status = VMStatus::DivideByZero;
+            goto done;
+        }
+        // INT32_MIN / -1 溢出，按回绕处理
+        r[ip->a] = value == -1 ? static_cast<int32_t>(0u - static_cast<uint32_t>(r[ip->b])) : r[ip->b] / value;
+        VM_NEXT();
+    VM_OP(Eq)
+        r[ip->a] = r[ip->b] == r[ip->c];
+        VM_NEXT();
+    VM_OP(Ne)
+        r[ip->a] = r[ip->b] != r[ip->c];
+        VM_NEXT();
+    VM_OP(Lt)
+        r[ip->a] = r[ip->b] < r[ip->c];
+        VM_NEXT();
+    VM_OP(Le)
+        r[ip->a] = r[ip->b] <= r[ip->c];
+        VM_NEXT();
+    VM_OP(Gt)
+        r[ip->a] = r[ip->b] > r[ip->c];
+        VM_NEXT();
+    VM_OP(Ge)
+        r[ip->a] = r[ip->b] >= r[ip->c];
+        VM_NEXT();
+    VM_OP(Jump)
+        VM_GOTO(ip->b);
+    VM_OP(JumpIfZero)
+        if (r[ip->a] == 0)
+            VM_GOTO(ip->b);
+        VM_NEXT();
+    VM_OP(JumpIfNonZero)
+        if (r[ip->a] != 0)
+            VM_GOTO(ip->b);
+        VM_NEXT();
+    VM_OP(JumpEq)
+        if (r[ip->a] == r[ip->b])
+            VM_GOTO(ip->c);
+        VM_NEXT();
+    VM_OP(JumpNe)
+        if (r[ip->a] != r[ip->b])
+            VM_GOTO(ip->c);
+        VM_NEXT();
+    VM_OP(JumpLt)
+        if (r[ip->a] < r[ip->b])
+            VM_GOTO(ip->c);
+        VM_NEXT();
+    VM_OP(JumpLe)
+        if (r[ip->a] <= r[ip->b])
+            VM_GOTO(ip->c);
+        VM_NEXT();
+    VM_OP(JumpGt)
+        if (r[ip->a] > r[ip->b])
+            VM_GOTO(ip->c);
+        VM_NEXT();
+    VM_OP(JumpGe)
+        if (r[ip->a] >= r[ip->b])
+            VM_GOTO(ip->c);
+        VM_NEXT();
+    VM_OP(LoopTick)
+        if (++ticks > limit) {
+            ticks = limit;
+            status = VMStatus::LoopLimit;
+            goto done;
+        }
+        VM_NEXT();
+    VM_OP(ReadInt)
+        status = input.next(value);
+        if (status != VMStatus::Ok)
+            goto done;
+        r[ip->a] = value;
+        VM_NEXT();
+    VM_OP(ReadBool)
+        status = input.next(value);
+        if (status != VMStatus::Ok)
+            goto done;
+        r[ip->a] = value != 0;
+        VM_NEXT();
+    VM_OP(Write)
+        writeValue(output, r[ip->a]);
+        VM_NEXT();
+    VM_OP(Halt)
+        goto done;
+
+#ifndef VM_COMPUTED_GOTO
+        }
+    }
+#endif
+#undef VM_OP
+#undef VM_NEXT
+#undef VM_GOTO
+
+done:
+    lastIterations = ticks;
+    return status;
+}